@@ -0,0 +1,45 @@
+# Measures clean and incremental build times of the build time samples in a configured build tree:
+#
+#   cmake -DBUILD_DIR=<build tree> [-DJOBS=<n>] -P benchmarks/build_time/measure.cmake
+#
+# The tree must be configured with NLOHMANN_YAML_BUILD_BENCHMARKS=ON; the module sample is measured
+# too when it was also configured with NLOHMANN_YAML_BUILD_MODULE=ON. "clean" rebuilds the sample
+# from scratch (including the module interface), "incremental" rebuilds it after touching one unit.
+cmake_minimum_required(VERSION 3.31)
+
+if(NOT BUILD_DIR)
+    message(FATAL_ERROR "Usage: cmake -DBUILD_DIR=<build tree> [-DJOBS=<n>] -P measure.cmake")
+endif()
+if(NOT JOBS)
+    cmake_host_system_information(RESULT JOBS QUERY NUMBER_OF_LOGICAL_CORES)
+endif()
+
+# Runs a build and stores its wall time in seconds (millisecond resolution) in `result`
+function(nlohmann_yaml_timed_build result target)
+    string(TIMESTAMP start "%s%f")
+    execute_process(COMMAND ${CMAKE_COMMAND} --build ${BUILD_DIR} --target ${target} --parallel ${JOBS} ${ARGN}
+                    RESULT_VARIABLE status OUTPUT_QUIET)
+    string(TIMESTAMP end "%s%f")
+    if(NOT status EQUAL 0)
+        message(FATAL_ERROR "Building ${target} failed")
+    endif()
+    math(EXPR millis "(${end} - ${start}) / 1000")
+    math(EXPR seconds "${millis} / 1000")
+    math(EXPR fraction "${millis} % 1000 + 1000")
+    string(SUBSTRING "${fraction}" 1 3 fraction)
+    set(${result} "${seconds}.${fraction}" PARENT_SCOPE)
+endfunction()
+
+foreach(mode header module)
+    set(target nlohmann_yaml_build_time_${mode})
+    set(sources "${BUILD_DIR}/benchmarks/build_time/${target}_sources")
+    if(NOT EXISTS "${sources}")
+        message(STATUS "${mode}: not configured")
+        continue()
+    endif()
+
+    nlohmann_yaml_timed_build(clean ${target} --clean-first)
+    file(TOUCH "${sources}/unit_0.cpp")
+    nlohmann_yaml_timed_build(incremental ${target})
+    message(STATUS "${mode}: clean ${clean} s, incremental ${incremental} s")
+endforeach()
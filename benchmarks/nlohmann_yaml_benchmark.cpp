@@ -0,0 +1,871 @@
+/*
+    Copyright (C) 2025 Igal Alkon <igal@alkontek.com> and contributors
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <nlohmann/yaml.hpp>
+#include <deployment_config.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Sink that keeps benchmarked results alive
+    volatile size_t benchmark_sink = 0;
+
+    /**
+     * Runs a benchmark body several times and returns the best wall-clock time of one run.
+     *
+     * @param runs The number of runs.
+     * @param body The code to measure.
+     * @return The fastest run, in seconds.
+     */
+    double measure(const int runs, const std::function<void()>& body) {
+        double best = std::numeric_limits<double>::max();
+        for (int i = 0; i < runs; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            body();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    /**
+     * Prints one benchmark result as time and throughput over the input size.
+     *
+     * @param name The benchmark name.
+     * @param bytes The input size processed by one run.
+     * @param seconds The time of one run.
+     */
+    void report(const std::string& name, const size_t bytes, const double seconds) {
+        std::cout << std::left << std::setw(44) << name
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(2) << seconds * 1000.0 << " ms"
+                  << std::setw(10) << std::setprecision(1) << static_cast<double>(bytes) / seconds / 1e6 << " MB/s"
+                  << std::endl;
+    }
+
+    /**
+     * Hardware event counts of one measured phase.
+     */
+    struct counter_values {
+        static constexpr size_t count = 4;
+        static constexpr const char* names[count] = {"cycles", "instructions", "branch-misses", "cache-misses"};
+
+        double values[count] = {};
+        bool valid[count] = {};
+
+        counter_values operator-(const counter_values& other) const {
+            counter_values result;
+            for (size_t i = 0; i < count; ++i) {
+                result.values[i] = values[i] - other.values[i];
+                result.valid[i] = valid[i] && other.valid[i];
+            }
+            return result;
+        }
+    };
+
+    /**
+     * Reads cycles, instructions, branch misses and cache misses of the calling thread through
+     * Linux `perf_event_open`. Counters the kernel or the machine does not provide are reported
+     * as unavailable instead of failing the benchmark.
+     */
+    class perf_counters {
+#if defined(__linux__)
+        int fds[counter_values::count] = {-1, -1, -1, -1};
+
+        static int open_counter(const std::uint64_t config) {
+            perf_event_attr attr{};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1; // allowed with the default perf_event_paranoid level
+            attr.exclude_hv = 1;
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+        std::string error;
+
+    public:
+        perf_counters() {
+#if defined(__linux__)
+            const std::uint64_t configs[counter_values::count] = {
+                PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+            for (size_t i = 0; i < counter_values::count; ++i) {
+                fds[i] = open_counter(configs[i]);
+                if (fds[i] < 0 && error.empty()) {
+                    error = std::string(counter_values::names[i]) + ": " + std::strerror(errno);
+                }
+            }
+#else
+            error = "perf_event_open is only available on Linux";
+#endif
+        }
+
+        perf_counters(const perf_counters&) = delete;
+        perf_counters& operator=(const perf_counters&) = delete;
+
+        ~perf_counters() {
+#if defined(__linux__)
+            for (const int fd : fds) {
+                if (fd >= 0) {
+                    close(fd);
+                }
+            }
+#endif
+        }
+
+        /**
+         * @return True if at least one counter could be opened.
+         */
+        bool available() const {
+#if defined(__linux__)
+            return std::any_of(std::begin(fds), std::end(fds), [](const int fd) { return fd >= 0; });
+#else
+            return false;
+#endif
+        }
+
+        /**
+         * @return Why the first unavailable counter could not be opened, or an empty string.
+         */
+        const std::string& last_error() const {
+            return error;
+        }
+
+        /**
+         * Counts the events of `runs` executions of a body and returns the average per run.
+         *
+         * @param runs The number of runs.
+         * @param body The code to measure.
+         * @return The average event counts of one run.
+         */
+        counter_values measure(const int runs, const std::function<void()>& body) {
+            counter_values result;
+#if defined(__linux__)
+            for (const int fd : fds) {
+                if (fd >= 0) {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+            for (int i = 0; i < runs; ++i) {
+                body();
+            }
+#if defined(__linux__)
+            for (size_t i = 0; i < counter_values::count; ++i) {
+                if (fds[i] < 0) {
+                    continue;
+                }
+                ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+                std::uint64_t value = 0;
+                if (read(fds[i], &value, sizeof(value)) == static_cast<ssize_t>(sizeof(value))) {
+                    result.values[i] = static_cast<double>(value) / runs;
+                    result.valid[i] = true;
+                }
+            }
+#endif
+            return result;
+        }
+    };
+
+    /**
+     * Prints the wall-clock time of a phase next to its hardware event rates.
+     *
+     * @param name The phase name.
+     * @param bytes The input size processed by one run.
+     * @param seconds The time of one run.
+     * @param counters The event counts of one run, or nullptr when counters are not read.
+     */
+    void report_phase(const std::string& name, const size_t bytes, const double seconds,
+                      const counter_values* counters) {
+        std::cout << std::left << std::setw(36) << name
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(2) << seconds * 1000.0 << " ms";
+        if (counters) {
+            const auto rate = [&](const size_t index, const double per_bytes, const int precision) {
+                std::cout << std::setw(12);
+                if (counters->valid[index]) {
+                    std::cout << std::setprecision(precision) << counters->values[index] * per_bytes / static_cast<double>(bytes);
+                } else {
+                    std::cout << "n/a";
+                }
+            };
+            rate(0, 1.0, 2);    // cycles/B
+            rate(1, 1.0, 2);    // instructions/B
+            rate(2, 1024.0, 2); // branch-misses/KB
+            rate(3, 1024.0, 2); // cache-misses/KB
+        }
+        std::cout << std::endl;
+    }
+
+    /**
+     * Generates a configuration corpus full of durations, byte sizes and percentages.
+     *
+     * @param services The number of service entries.
+     * @return The YAML text.
+     */
+    std::string make_unit_corpus(const size_t services) {
+        std::string yaml;
+        for (size_t i = 0; i < services; ++i) {
+            const std::string n = std::to_string(i);
+            yaml += "service_" + n + ":\n";
+            yaml += "  name: service-" + n + "\n";
+            yaml += "  timeout: " + std::to_string(i % 90 + 1) + "s\n";
+            yaml += "  retry_interval: " + std::to_string(i % 5) + "m" + std::to_string(i % 60) + "s\n";
+            yaml += "  memory: " + std::to_string(128 << (i % 4)) + "Mi\n";
+            yaml += "  disk: " + std::to_string(i % 20 + 1) + ".5G\n";
+            yaml += "  cpu_ratio: " + std::to_string(i % 100) + "%\n";
+            yaml += "  replicas: " + std::to_string(i % 9 + 1) + "\n";
+        }
+        return yaml;
+    }
+
+    using unit_resolvers = nlohmann::yaml_resolver_chain<nlohmann::yaml_duration_resolver,
+                                                         nlohmann::yaml_byte_size_resolver,
+                                                         nlohmann::yaml_percentage_resolver>;
+
+    /**
+     * Converts unit strings in a parsed DOM after the fact, the way configs were handled
+     * before resolvers could run inside the parser.
+     */
+    void resolve_in_second_pass(nlohmann::json& value) {
+        if (value.is_structured()) {
+            for (auto& element : value) {
+                resolve_in_second_pass(element);
+            }
+        } else if (value.is_string()) {
+            nlohmann::json resolved;
+            if (unit_resolvers::resolve(value.get_ref<const std::string&>(), resolved)) {
+                value = std::move(resolved);
+            }
+        }
+    }
+
+    void benchmark_scalar_resolvers(const size_t scale, const int runs) {
+        std::cout << "\n== Scalar resolvers ==" << std::endl;
+        const std::string corpus = make_unit_corpus(scale * 1000);
+
+        report("parse_yaml (units left as strings)", corpus.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + nlohmann::parse_yaml(corpus).size();
+        }));
+
+        report("parse_yaml + second pass over the DOM", corpus.size(), measure(runs, [&] {
+            nlohmann::json config = nlohmann::parse_yaml(corpus);
+            resolve_in_second_pass(config);
+            benchmark_sink = benchmark_sink + config.size();
+        }));
+
+        report("parse_yaml<unit_resolvers>", corpus.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + nlohmann::parse_yaml<unit_resolvers>(corpus).size();
+        }));
+    }
+
+    /**
+     * Generates documents that carry embedded JSON payloads which are only forwarded.
+     *
+     * @param messages The number of messages.
+     * @return The YAML text.
+     */
+    std::string make_payload_corpus(const size_t messages) {
+        std::string yaml = "messages:\n";
+        for (size_t i = 0; i < messages; ++i) {
+            yaml += "  - id: " + std::to_string(i) + "\n";
+            yaml += "    payload:\n      {\n";
+            for (size_t field = 0; field < 40; ++field) {
+                yaml += "        \"field_" + std::to_string(field) + "\": ";
+                yaml += field % 2 ? "[" + std::to_string(i) + ", 1.5, true, null]" : "\"value " + std::to_string(field) + "\"";
+                yaml += field + 1 < 40 ? ",\n" : "\n";
+            }
+            yaml += "      }\n";
+        }
+        return yaml;
+    }
+
+    /**
+     * Sums the sizes of the forwarded payload texts.
+     */
+    size_t forward_payloads(const nlohmann::json& document) {
+        size_t forwarded = 0;
+        for (const auto& message : document["messages"]) {
+            const auto& payload = message["payload"];
+            forwarded += nlohmann::is_raw_json(payload) ? nlohmann::raw_json_view(payload).size()
+                                                        : payload.dump().size();
+        }
+        return forwarded;
+    }
+
+    void benchmark_raw_json(const size_t scale, const int runs) {
+        std::cout << "\n== Raw JSON passthrough ==" << std::endl;
+        const std::string corpus = make_payload_corpus(scale * 100);
+
+        report("parse_yaml + dump() payloads", corpus.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + forward_payloads(nlohmann::parse_yaml(corpus));
+        }));
+
+        nlohmann::yaml_parse_options raw;
+        raw.raw_json_min_bytes = 256;
+        report("parse_yaml (raw, validated)", corpus.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + forward_payloads(nlohmann::parse_yaml(corpus, raw));
+        }));
+
+        nlohmann::yaml_parse_options unchecked = raw;
+        unchecked.validate_raw_json = false;
+        report("parse_yaml (raw, bracket balance only)", corpus.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + forward_payloads(nlohmann::parse_yaml(corpus, unchecked));
+        }));
+    }
+
+    void benchmark_indexing(const size_t scale, const int runs) {
+        std::cout << "\n== Line indexing (stage 1) ==" << std::endl;
+        const std::string corpus = make_unit_corpus(scale * 5000);
+
+        nlohmann::yaml_parse_options serial;
+        serial.index_threads = 1;
+        report("index, 1 thread", corpus.size(), measure(runs, [&] {
+            const nlohmann::yaml_parser parser(corpus, serial);
+            benchmark_sink = benchmark_sink + sizeof(parser);
+        }));
+
+        nlohmann::yaml_parse_options parallel;
+        parallel.parallel_index_min_bytes = 0;
+        report("index, " + std::to_string(std::max(1u, std::thread::hardware_concurrency())) + " threads",
+               corpus.size(), measure(runs, [&] {
+            const nlohmann::yaml_parser parser(corpus, parallel);
+            benchmark_sink = benchmark_sink + sizeof(parser);
+        }));
+    }
+
+    /**
+     * Encodes ASCII/Latin-1 text as UTF-16 or UTF-32 code units, for the transcoding benchmark.
+     */
+    std::string encode_wide(const std::string& text, const nlohmann::yaml_encoding encoding) {
+        const bool wide = encoding == nlohmann::yaml_encoding::utf32le || encoding == nlohmann::yaml_encoding::utf32be;
+        const bool big_endian = encoding == nlohmann::yaml_encoding::utf16be || encoding == nlohmann::yaml_encoding::utf32be;
+        const int width = wide ? 4 : 2;
+        std::string bytes;
+        bytes.reserve(text.size() * static_cast<size_t>(width));
+        for (const char c : text) {
+            const auto unit = static_cast<std::uint32_t>(static_cast<unsigned char>(c));
+            for (int b = 0; b < width; ++b) {
+                bytes += static_cast<char>((unit >> (8 * (big_endian ? width - 1 - b : b))) & 0xff);
+            }
+        }
+        return bytes;
+    }
+
+    void benchmark_transcoding(const size_t scale, const int runs) {
+        std::cout << "\n== Input transcoding (MB/s of encoded input) ==" << std::endl;
+        const std::string corpus = make_unit_corpus(scale * 5000);
+
+        // The same corpus with every letter 'e' replaced by U+00E9, so most blocks need the scalar path
+        std::string accented = corpus;
+        std::replace(accented.begin(), accented.end(), 'e', '\xe9');
+
+        const std::pair<nlohmann::yaml_encoding, const char*> encodings[] = {
+            {nlohmann::yaml_encoding::utf16le, "UTF-16LE"},
+            {nlohmann::yaml_encoding::utf16be, "UTF-16BE"},
+            {nlohmann::yaml_encoding::utf32le, "UTF-32LE"}};
+        for (const auto& [encoding, name] : encodings) {
+            for (const bool ascii : {true, false}) {
+                const std::string input = encode_wide(ascii ? corpus : accented, encoding);
+                std::string output;
+                report(std::string(name) + (ascii ? " -> UTF-8, ASCII" : " -> UTF-8, accented"), input.size(),
+                       measure(runs, [&] {
+                    nlohmann::transcode_to_utf8(input, encoding, output);
+                    benchmark_sink = benchmark_sink + output.size();
+                }));
+            }
+        }
+
+        const std::string utf16 = "\xff\xfe" + encode_wide(corpus, nlohmann::yaml_encoding::utf16le);
+        report("parse_yaml, UTF-8 input", corpus.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + nlohmann::parse_yaml(corpus).size();
+        }));
+        report("parse_yaml, UTF-16LE input (per UTF-8 byte)", corpus.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + nlohmann::parse_yaml(utf16).size();
+        }));
+    }
+
+    void benchmark_pipeline(const size_t scale, const int runs) {
+        std::cout << "\n== Multi-document pipeline (" << std::thread::hardware_concurrency()
+                  << " hardware threads) ==" << std::endl;
+        std::string stream_text;
+        const std::string document = make_unit_corpus(4);
+        for (size_t i = 0; i < scale * 2000; ++i) {
+            stream_text += "---\n" + document;
+        }
+
+        const double serial = measure(runs, [&] {
+            std::istringstream input(stream_text);
+            nlohmann::yaml_document_reader reader(input);
+            std::string text;
+            bool has_content;
+            while (reader.next(text, has_content)) {
+                benchmark_sink = benchmark_sink + nlohmann::parse_yaml(text).size();
+            }
+        });
+        report("serial, one document at a time", stream_text.size(), serial);
+
+        for (const size_t threads : {1, 2, 4, 8, 16}) {
+            nlohmann::yaml_pipeline_options options;
+            options.threads = threads;
+            const double seconds = measure(runs, [&] {
+                std::istringstream input(stream_text);
+                nlohmann::parse_yaml_stream(input, [](nlohmann::json&& parsed) {
+                    benchmark_sink = benchmark_sink + parsed.size();
+                }, options);
+            });
+            std::ostringstream name;
+            name << "pipeline, " << threads << " workers (x" << std::fixed << std::setprecision(2)
+                 << serial / seconds << ")";
+            report(name.str(), stream_text.size(), seconds);
+        }
+    }
+
+    /**
+     * Builds a deployment configuration shaped like benchmarks/deployment_config.yaml with
+     * `services` entries. Every service also carries keys outside the generated schema, plus an
+     * `env` block of `env_entries` lines that the generated parser skips.
+     */
+    std::string make_deployment_corpus(const size_t services, const size_t env_entries = 0) {
+        std::string corpus = "cluster: production\nversion: 3\ndry_run: false\nservices:\n";
+        for (size_t i = 0; i < services; ++i) {
+            const std::string id = std::to_string(i);
+            corpus += "  - name: service-" + id + "\n"
+                "    image: registry.local/service-" + id + ":1." + std::to_string(i % 10) + ".0\n"
+                "    replicas: " + std::to_string(i % 8 + 1) + "\n"
+                "    cpu: 0." + std::to_string(i % 9 + 1) + "\n"
+                "    enabled: " + (i % 3 != 0 ? "true" : "false") + "\n"
+                "    ports: [" + std::to_string(8000 + i % 100) + ", " + std::to_string(9000 + i % 100) + "]\n"
+                "    annotations: # not in the schema\n"
+                "      owner: team-" + std::to_string(i % 12) + "\n"
+                "      revision: " + id + "\n"
+                "    resources:\n"
+                "      memory_mb: " + std::to_string(256 << (i % 4)) + "\n"
+                "      storage_gb: " + std::to_string(10 + i % 50) + "\n";
+            if (env_entries != 0) {
+                corpus += "    env:\n";
+                for (size_t e = 0; e < env_entries; ++e) {
+                    corpus += "      - name: VARIABLE_" + std::to_string(e) + "\n        value: \"" + id + "\"\n";
+                }
+            }
+        }
+        return corpus;
+    }
+
+    void benchmark_generated_parser(const size_t scale, const int runs) {
+        std::cout << "\n== Generated schema parser (yaml2cpp) ==" << std::endl;
+        const std::string corpus = make_deployment_corpus(scale * 2000);
+
+        report("parse_yaml + get<deployment_config>()", corpus.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + nlohmann::parse_yaml(corpus).get<bench::deployment_config>().services.size();
+        }));
+        report("generated parse_deployment_config", corpus.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + bench::parse_deployment_config(corpus).services.size();
+        }));
+
+        // Unknown blocks are skipped by jumping to the end of the key's block
+        const std::string with_env = make_deployment_corpus(scale * 200, 40);
+        report("generated, 40-entry env blocks skipped", with_env.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + bench::parse_deployment_config(with_env).services.size();
+        }));
+    }
+
+    /**
+     * Prints the time of a lookup loop and the time per looked-up key.
+     */
+    void report_lookup(const std::string& name, const double seconds, const size_t lookups) {
+        std::cout << std::left << std::setw(44) << name
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(2) << seconds * 1000.0 << " ms"
+                  << std::setw(10) << std::setprecision(1) << seconds * 1e9 / static_cast<double>(lookups) << " ns/key"
+                  << std::endl;
+    }
+
+    void benchmark_packed_sequences(const size_t scale, const int runs) {
+        std::cout << "\n== Packed numeric sequences ==" << std::endl;
+        std::string corpus = "samples:\n";
+        const size_t count = scale * 100000;
+        for (size_t i = 0; i < count; ++i) {
+            corpus += "  - " + std::to_string(static_cast<double>(i % 1000) * 0.25 + 0.125) + "\n";
+        }
+
+        nlohmann::yaml_parse_options packed_options;
+        packed_options.packed_sequence_min_items = 1024;
+        nlohmann::json plain;
+        nlohmann::json packed;
+        report("parse_yaml, json array", corpus.size(), measure(runs, [&] {
+            plain = nlohmann::parse_yaml(corpus);
+        }));
+        report("parse_yaml, packed sequence", corpus.size(), measure(runs, [&] {
+            packed = nlohmann::parse_yaml(corpus, packed_options);
+        }));
+
+        const double array_scan = measure(runs, [&] {
+            double sum = 0;
+            for (const auto& value : plain["samples"]) {
+                sum += value.get<double>();
+            }
+            benchmark_sink = benchmark_sink + static_cast<size_t>(sum);
+        });
+        const double span_scan = measure(runs, [&] {
+            double sum = 0;
+            for (const double value : nlohmann::packed_sequence_span<double>(packed["samples"])) {
+                sum += value;
+            }
+            benchmark_sink = benchmark_sink + static_cast<size_t>(sum);
+        });
+        report_lookup("sum over json array (per item)", array_scan, count);
+        report_lookup("sum over packed span (per item)", span_scan, count);
+        std::cout << "DOM bytes: json array " << nlohmann::memory_report(plain).usage.total()
+                  << ", packed " << nlohmann::memory_report(packed).usage.total() << std::endl;
+    }
+
+    void benchmark_embedding(const size_t scale, const int runs) {
+        std::cout << "\n== Startup load of an embedded config (nlohmann_yaml_embed) ==" << std::endl;
+        const std::string corpus = make_deployment_corpus(scale * 200);
+        const std::vector<std::uint8_t> msgpack = nlohmann::json::to_msgpack(nlohmann::parse_yaml(corpus));
+
+        report("parse_yaml of the YAML text", corpus.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + nlohmann::parse_yaml(corpus).size();
+        }));
+        report("json::from_msgpack of the embedded blob", corpus.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + nlohmann::json::from_msgpack(msgpack).size();
+        }));
+        std::cout << "YAML " << corpus.size() << " bytes, MessagePack " << msgpack.size() << " bytes" << std::endl;
+    }
+
+    void benchmark_anchors(const size_t scale, const int runs) {
+        std::cout << "\n== Anchor-emitting writer (repeated subtrees) ==" << std::endl;
+        // Services sharing a few resource, probe and label profiles, like generated manifests
+        nlohmann::json profiles = nlohmann::json::array();
+        for (int p = 0; p < 4; ++p) {
+            profiles.push_back({
+                {"resources", {{"cpu", std::to_string(250 * (p + 1)) + "m"}, {"memory", std::to_string(256 * (p + 1)) + "Mi"}}},
+                {"probe", {{"path", "/healthz"}, {"period", 10 + p}, {"timeout", 2}, {"threshold", 3}}},
+                {"labels", {{"team", "platform"}, {"tier", "backend"}, {"profile", p}}}
+            });
+        }
+        nlohmann::json services = nlohmann::json::object();
+        for (size_t i = 0; i < scale * 200; ++i) {
+            nlohmann::json service = profiles[i % profiles.size()];
+            service["replicas"] = i % 7 + 1;
+            services["service_" + std::to_string(i)] = std::move(service);
+        }
+        const nlohmann::json doc = {{"services", std::move(services)}};
+
+        nlohmann::yaml_emit_options plain;
+        plain.threads = 1;
+        nlohmann::yaml_emit_options anchored = plain;
+        anchored.anchor_min_nodes = 4;
+        const std::string full = nlohmann::to_yaml(doc, plain);
+        const std::string deduplicated = nlohmann::to_yaml(doc, anchored);
+
+        // Throughput is relative to the full output, so the rows compare directly
+        report("to_yaml", full.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + nlohmann::to_yaml(doc, plain).size();
+        }));
+        report("to_yaml with anchors", full.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + nlohmann::to_yaml(doc, anchored).size();
+        }));
+        report("parse_yaml of the full output", full.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + nlohmann::parse_yaml(full).size();
+        }));
+        report("parse_yaml of the anchored output", full.size(), measure(runs, [&] {
+            benchmark_sink = benchmark_sink + nlohmann::parse_yaml(deduplicated).size();
+        }));
+        std::cout << "Output " << full.size() << " bytes, with anchors " << deduplicated.size() << " bytes" << std::endl;
+    }
+
+    void benchmark_path_handles(const size_t scale, const int runs) {
+        std::cout << "\n== Repeated config lookups ==" << std::endl;
+        std::string config;
+        for (int i = 0; i < 200; ++i) {
+            config += "section_" + std::to_string(i) + ":\n  enabled: true\n  weight: " + std::to_string(i) + "\n";
+        }
+        config += "limits:\n  burst: 20\n  rps: 100\n  timeout: 5\n";
+
+        const nlohmann::yaml_document document(nlohmann::parse_yaml(config));
+        const nlohmann::yaml_path_handle rps = nlohmann::compile_path(document, "/limits/rps");
+        const size_t lookups = scale * 100000;
+
+        report_lookup("cfg[\"limits\"][\"rps\"]", measure(runs, [&] {
+            std::int64_t sum = 0;
+            for (size_t i = 0; i < lookups; ++i) {
+                sum += document.root()["limits"]["rps"].get<std::int64_t>();
+            }
+            benchmark_sink = benchmark_sink + static_cast<size_t>(sum);
+        }), lookups);
+        report_lookup("compile_path(\"/limits/rps\")", measure(runs, [&] {
+            std::int64_t sum = 0;
+            for (size_t i = 0; i < lookups; ++i) {
+                sum += rps->get<std::int64_t>();
+            }
+            benchmark_sink = benchmark_sink + static_cast<size_t>(sum);
+        }), lookups);
+    }
+
+    void benchmark_metrics(const size_t scale, const int runs) {
+        std::cout << "\n== Parse metrics overhead ==" << std::endl;
+        const std::string document = "limits:\n  rps: 100\n  burst: 20\nname: gateway\n";
+        const size_t calls = scale * 2000;
+
+        nlohmann::yaml_parse_options plain;
+        nlohmann::yaml_metrics metrics;
+        nlohmann::yaml_parse_options measured;
+        measured.metrics = &metrics;
+        measured.metrics_label = "benchmark";
+        for (const auto& [name, options] : {std::pair<const char*, const nlohmann::yaml_parse_options*>{"small documents", &plain},
+                                            {"small documents, with metrics", &measured}}) {
+            report_lookup(std::string(name) + " (per call)", measure(runs, [&] {
+                for (size_t i = 0; i < calls; ++i) {
+                    benchmark_sink = benchmark_sink + nlohmann::parse_yaml(document, *options).size();
+                }
+            }), calls);
+        }
+        report_lookup("yaml_metrics::record alone (per call)", measure(runs, [&] {
+            for (size_t i = 0; i < calls; ++i) {
+                metrics.record("record only", document.size(), 5000);
+            }
+        }), calls);
+        const nlohmann::yaml_parse_stats stats = metrics.snapshot().front();
+        std::cout << "p50 " << stats.latency_quantile(0.5) * 1e6 << " us, p99 "
+                  << stats.latency_quantile(0.99) * 1e6 << " us" << std::endl;
+    }
+
+    /**
+     * Measures building and querying a wide mapping with one JSON type.
+     *
+     * @param name The name of the JSON type.
+     * @param corpus A document whose "wide" mapping has the keys in `keys`.
+     * @param keys The keys to look up, in lookup order.
+     */
+    template <typename BasicJsonType>
+    void benchmark_container(const std::string& name, const std::string& corpus,
+                             const std::vector<std::string>& keys, const int runs) {
+        BasicJsonType document;
+        report(name + " build", corpus.size(), measure(runs, [&] {
+            document = nlohmann::parse_yaml_as<BasicJsonType>(corpus);
+        }));
+
+        const auto& wide = document["wide"];
+        const double seconds = measure(runs, [&] {
+            size_t found = 0;
+            for (const auto& key : keys) {
+                found += wide.find(key) != wide.end() ? 1 : 0;
+            }
+            benchmark_sink = benchmark_sink + found;
+        });
+        report_lookup(name + " lookup", seconds, keys.size());
+    }
+
+    /**
+     * Measures building a frozen map from the same keys as a flat root mapping, and its lookups.
+     */
+    void benchmark_frozen_map(const std::string& corpus, const std::vector<std::string>& keys, const int runs) {
+        nlohmann::yaml_frozen_map frozen;
+        report("yaml_frozen_map build (flat mapping)", corpus.size(), measure(runs, [&] {
+            frozen = nlohmann::build_frozen_map(corpus);
+        }));
+
+        const double seconds = measure(runs, [&] {
+            size_t found = 0;
+            for (const auto& key : keys) {
+                found += frozen.find(key) ? 1 : 0;
+            }
+            benchmark_sink = benchmark_sink + found;
+        });
+        report_lookup("yaml_frozen_map lookup", seconds, keys.size());
+    }
+
+    void benchmark_containers(const size_t scale, const int runs) {
+        std::cout << "\n== Object containers (wide mapping) ==" << std::endl;
+        const size_t width = scale * 10000;
+
+        std::vector<std::string> keys;
+        std::string corpus = "wide:\n";
+        for (size_t i = 0; i < width; ++i) {
+            // Keys are not generated in sorted order
+            keys.push_back("key_" + std::to_string((i * 7919) % width));
+            corpus += "  " + keys.back() + ": " + std::to_string(i) + "\n";
+        }
+        std::reverse(keys.begin(), keys.end());
+
+        benchmark_container<nlohmann::json>("json (std::map)", corpus, keys, runs);
+        benchmark_container<nlohmann::yaml_flat_json>("yaml_flat_json", corpus, keys, runs);
+        benchmark_container<nlohmann::yaml_ordered_hash_json>("yaml_ordered_hash_json", corpus, keys, runs);
+        benchmark_container<nlohmann::yaml_unordered_json>("yaml_unordered_json", corpus, keys, runs);
+        if (width <= 20000) {
+            // Linear lookups make ordered_json quadratic on wide mappings
+            benchmark_container<nlohmann::ordered_json>("ordered_json", corpus, keys, runs);
+        }
+
+        std::string flat;
+        for (size_t i = 0; i < width; ++i) {
+            flat += keys[width - 1 - i] + ": " + std::to_string(i) + "\n";
+        }
+        benchmark_frozen_map(flat, keys, runs);
+    }
+
+    /**
+     * Plain scalars stay strings: parsing with this resolver skips the built-in scalar typing.
+     */
+    struct untyped_resolver {
+        template <typename BasicJsonType>
+        static bool resolve(const std::string& value, BasicJsonType& result) {
+            result = value;
+            return true;
+        }
+    };
+
+    /**
+     * Breaks parsing down into phases for one corpus. Preprocessing is measured by constructing
+     * the parser; scalar typing and JSON blocks are measured differentially, against a parse that
+     * leaves plain scalars untyped and one that keeps JSON blocks as unvalidated raw text.
+     */
+    void benchmark_phases(const std::string& corpus_name, const std::string& corpus, const int runs,
+                          perf_counters* counters) {
+        std::cout << "\n-- " << corpus_name << " (" << corpus.size() / 1024 << " KiB) --" << std::endl;
+
+        nlohmann::yaml_parse_options raw;
+        raw.raw_json_min_bytes = 1;
+        raw.validate_raw_json = false;
+
+        using untyped_parser = nlohmann::basic_yaml_parser<nlohmann::yaml_resolver_chain<untyped_resolver>>;
+        nlohmann::yaml_parser full_parser(corpus);
+        nlohmann::yaml_parser raw_parser(corpus, raw);
+        untyped_parser untyped(corpus);
+        untyped_parser structure(corpus, raw);
+
+        struct phase {
+            double seconds = 0.0;
+            counter_values events;
+        };
+        const auto run_phase = [&](const std::function<void()>& body) {
+            phase result;
+            result.seconds = measure(runs, body);
+            if (counters) {
+                result.events = counters->measure(runs, body);
+            }
+            return result;
+        };
+
+        const phase preprocess = run_phase([&] {
+            const nlohmann::yaml_parser parser(corpus);
+            benchmark_sink = benchmark_sink + sizeof(parser);
+        });
+        const phase all = run_phase([&] { benchmark_sink = benchmark_sink + full_parser.parse().size(); });
+        const phase no_json = run_phase([&] { benchmark_sink = benchmark_sink + raw_parser.parse().size(); });
+        const phase no_typing = run_phase([&] { benchmark_sink = benchmark_sink + untyped.parse().size(); });
+        const phase skeleton = run_phase([&] { benchmark_sink = benchmark_sink + structure.parse().size(); });
+
+        const auto print = [&](const std::string& name, const double seconds, const counter_values& events) {
+            report_phase(name, corpus.size(), seconds, counters ? &events : nullptr);
+        };
+        print("preprocessing", preprocess.seconds, preprocess.events);
+        print("parse()", all.seconds, all.events);
+        print("  structure building", skeleton.seconds, skeleton.events);
+        print("  scalar typing (diff)", all.seconds - no_typing.seconds, all.events - no_typing.events);
+        print("  JSON blocks (diff)", all.seconds - no_json.seconds, all.events - no_json.events);
+    }
+
+    void benchmark_parse_phases(const size_t scale, const int runs, const bool read_counters) {
+        std::cout << "\n== Parse phases ==" << std::endl;
+
+        perf_counters counters;
+        perf_counters* active = nullptr;
+        if (read_counters) {
+            if (counters.available()) {
+                active = &counters;
+                if (!counters.last_error().empty()) {
+                    std::cout << "(some hardware counters are unavailable: " << counters.last_error() << ")" << std::endl;
+                }
+            } else {
+                std::cout << "(hardware counters unavailable: " << counters.last_error() << ")" << std::endl;
+            }
+        }
+
+        std::cout << std::left << std::setw(36) << "phase" << std::right << std::setw(13) << "time";
+        if (active) {
+            std::cout << std::setw(12) << "cycles/B" << std::setw(12) << "instr/B"
+                      << std::setw(12) << "br-miss/KB" << std::setw(12) << "$-miss/KB";
+        }
+        std::cout << std::endl;
+
+        benchmark_phases("unit corpus", make_unit_corpus(scale * 1000), runs, active);
+        benchmark_phases("payload corpus", make_payload_corpus(scale * 100), runs, active);
+    }
+}
+
+/**
+ * Usage: nlohmann_yaml_benchmark [scale] [runs] [--counters]
+ * The scale multiplies the size of the generated corpora (default 10). With --counters, the
+ * parse phases also report hardware counters read through perf_event_open (Linux only).
+ */
+int main(const int argc, char* argv[]) {
+    std::vector<std::string> positional;
+    bool read_counters = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--counters") {
+            read_counters = true;
+        } else {
+            positional.emplace_back(argv[i]);
+        }
+    }
+
+    const size_t scale = !positional.empty() ? std::strtoul(positional[0].c_str(), nullptr, 10) : 10;
+    const int runs = positional.size() > 1 ? std::atoi(positional[1].c_str()) : 5;
+
+    benchmark_scalar_resolvers(scale, runs);
+    benchmark_raw_json(scale, runs);
+    benchmark_indexing(scale, runs);
+    benchmark_transcoding(scale, runs);
+    benchmark_pipeline(scale, runs);
+    benchmark_generated_parser(scale, runs);
+    benchmark_packed_sequences(scale, runs);
+    benchmark_path_handles(scale, runs);
+    benchmark_metrics(scale, runs);
+    benchmark_embedding(scale, runs);
+    benchmark_anchors(scale, runs);
+    benchmark_containers(scale, runs);
+    benchmark_parse_phases(scale, runs, read_counters);
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+# Finds the zstd compression library and provides the zstd::zstd imported target.
+#
+# Result variables:
+#   zstd_FOUND        - True if zstd was found
+#   zstd_INCLUDE_DIR  - Directory containing zstd.h
+#   zstd_LIBRARY      - Path to the zstd library
+
+find_path(zstd_INCLUDE_DIR NAMES zstd.h)
+find_library(zstd_LIBRARY NAMES zstd zstd_static libzstd)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(zstd REQUIRED_VARS zstd_LIBRARY zstd_INCLUDE_DIR)
+
+if(zstd_FOUND AND NOT TARGET zstd::zstd)
+    add_library(zstd::zstd UNKNOWN IMPORTED)
+    set_target_properties(zstd::zstd PROPERTIES
+        IMPORTED_LOCATION "${zstd_LIBRARY}"
+        INTERFACE_INCLUDE_DIRECTORIES "${zstd_INCLUDE_DIR}"
+    )
+endif()
+
+mark_as_advanced(zstd_INCLUDE_DIR zstd_LIBRARY)
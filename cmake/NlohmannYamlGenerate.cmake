@@ -0,0 +1,76 @@
+# nlohmann_yaml_generate(<target> SAMPLE <sample.yaml> NAME <struct_name> [NAMESPACE <namespace>]
+#                        [OUTPUT <header>])
+#
+# Runs yaml2cpp on a sample document at build time. The generated header (<struct_name>.hpp in
+# the binary directory unless OUTPUT is given) declares the structs inferred from the sample and a
+# specialized parse_<struct_name>() parser; it is added to <target> along with its include directory.
+function(nlohmann_yaml_generate target)
+    cmake_parse_arguments(PARSE_ARGV 1 ARG "" "SAMPLE;NAME;NAMESPACE;OUTPUT" "")
+    if(NOT ARG_SAMPLE OR NOT ARG_NAME)
+        message(FATAL_ERROR "nlohmann_yaml_generate: SAMPLE and NAME are required")
+    endif()
+
+    if(TARGET yaml2cpp)
+        set(generator yaml2cpp)
+    else()
+        set(generator nlohmann_yaml::yaml2cpp)
+    endif()
+
+    cmake_path(ABSOLUTE_PATH ARG_SAMPLE BASE_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}")
+    if(NOT ARG_OUTPUT)
+        set(ARG_OUTPUT "${CMAKE_CURRENT_BINARY_DIR}/nlohmann_yaml_generated/${ARG_NAME}.hpp")
+    endif()
+    cmake_path(GET ARG_OUTPUT PARENT_PATH output_dir)
+
+    add_custom_command(
+        OUTPUT "${ARG_OUTPUT}"
+        COMMAND ${CMAKE_COMMAND} -E make_directory "${output_dir}"
+        COMMAND ${generator} "${ARG_SAMPLE}" "${ARG_OUTPUT}" ${ARG_NAME} ${ARG_NAMESPACE}
+        DEPENDS "${ARG_SAMPLE}" ${generator}
+        COMMENT "Generating ${ARG_NAME} parser from ${ARG_SAMPLE}"
+        VERBATIM
+    )
+    target_sources(${target} PRIVATE "${ARG_OUTPUT}")
+    target_include_directories(${target} PRIVATE "${output_dir}")
+endfunction()
+
+# nlohmann_yaml_embed(<target> NAME <name> FILE <file.yaml> [NAMESPACE <namespace>]
+#                     [FORMAT msgpack|frozen_map])
+#
+# Parses a YAML file at build time with yaml_embed and compiles the result into <target>, so that no
+# YAML is parsed at startup; a malformed file fails the build. The generated <name>.hpp declares
+# load_<name>(), which decodes the MessagePack blob with json::from_msgpack, or with
+# FORMAT frozen_map (flat mappings only) <name>_map(), a yaml_frozen_map viewing the blob in place.
+function(nlohmann_yaml_embed target)
+    cmake_parse_arguments(PARSE_ARGV 1 ARG "" "NAME;FILE;NAMESPACE;FORMAT" "")
+    if(NOT ARG_NAME OR NOT ARG_FILE)
+        message(FATAL_ERROR "nlohmann_yaml_embed: NAME and FILE are required")
+    endif()
+    if(NOT ARG_FORMAT)
+        set(ARG_FORMAT msgpack)
+    elseif(NOT ARG_FORMAT MATCHES "^(msgpack|frozen_map)$")
+        message(FATAL_ERROR "nlohmann_yaml_embed: FORMAT must be msgpack or frozen_map")
+    endif()
+
+    if(TARGET yaml_embed)
+        set(embedder yaml_embed)
+    else()
+        set(embedder nlohmann_yaml::yaml_embed)
+    endif()
+
+    cmake_path(ABSOLUTE_PATH ARG_FILE BASE_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}")
+    set(output_dir "${CMAKE_CURRENT_BINARY_DIR}/nlohmann_yaml_embedded")
+    set(header "${output_dir}/${ARG_NAME}.hpp")
+    set(source "${output_dir}/${ARG_NAME}.cpp")
+
+    add_custom_command(
+        OUTPUT "${header}" "${source}"
+        COMMAND ${CMAKE_COMMAND} -E make_directory "${output_dir}"
+        COMMAND ${embedder} --format ${ARG_FORMAT} "${ARG_FILE}" "${header}" "${source}" ${ARG_NAME} ${ARG_NAMESPACE}
+        DEPENDS "${ARG_FILE}" ${embedder}
+        COMMENT "Embedding ${ARG_FILE} as ${ARG_NAME}"
+        VERBATIM
+    )
+    target_sources(${target} PRIVATE "${header}" "${source}")
+    target_include_directories(${target} PRIVATE "${output_dir}")
+endfunction()
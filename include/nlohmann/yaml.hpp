@@ -30,837 +30,7164 @@
 #include <stdexcept>
 #include <vector>
 #include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <charconv>
+#include <map>
+#include <fstream>
+#include <ios>
+#include <string_view>
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <iterator>
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#if !defined(NLOHMANN_YAML_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64))
+#define NLOHMANN_YAML_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define NLOHMANN_YAML_BIG_ENDIAN
+#endif
+
+// Exceptions follow nlohmann_json: they are off with JSON_NOEXCEPTION or when the compiler has them
+// disabled, and JSON_THROW_USER / JSON_TRY_USER / JSON_CATCH_USER replace the macros below. Without
+// exceptions the parser reports errors as a status (see `try_parse_yaml`); other errors abort.
+#if (defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)) && !defined(JSON_NOEXCEPTION)
+#define NLOHMANN_YAML_THROW(exception) throw exception
+#define NLOHMANN_YAML_TRY try
+#define NLOHMANN_YAML_CATCH(exception) catch (exception)
+#define NLOHMANN_YAML_RETHROW throw
+#else
+#define NLOHMANN_YAML_NOEXCEPTION
+#define NLOHMANN_YAML_THROW(exception) (static_cast<void>(exception), std::abort())
+#define NLOHMANN_YAML_TRY if (true)
+#define NLOHMANN_YAML_CATCH(exception) if (false)
+#define NLOHMANN_YAML_RETHROW std::abort()
+#endif
+
+#if defined(JSON_THROW_USER)
+#undef NLOHMANN_YAML_THROW
+#define NLOHMANN_YAML_THROW JSON_THROW_USER
+#endif
+#if defined(JSON_TRY_USER)
+#undef NLOHMANN_YAML_TRY
+#define NLOHMANN_YAML_TRY JSON_TRY_USER
+#endif
+#if defined(JSON_CATCH_USER)
+#undef NLOHMANN_YAML_CATCH
+#define NLOHMANN_YAML_CATCH JSON_CATCH_USER
+#endif
+
+#if defined(NLOHMANN_YAML_HAS_ZLIB)
+#include <zlib.h>
+#endif
+
+#if defined(NLOHMANN_YAML_HAS_ZSTD)
+#include <zstd.h>
+#endif
 
 namespace nlohmann {
     /**
-     * YAML parsing class providing functionality for parsing YAML inputs, extracting
-     * structures, managing indentation, and handling embedded JSON blocks.
+     * Estimated heap and inline bytes held by a JSON value, split by where the memory goes.
+     * The figures follow the layout of the standard containers used by `nlohmann::json` and
+     * ignore allocator bookkeeping, so they are an estimate rather than an exact RSS figure.
      */
-    class yaml_parser {
-        private:
-        std::vector<std::string> lines;
-        size_t current_line = 0;
+    struct yaml_memory_usage {
+        std::size_t node_bytes = 0;         ///< `json` values plus the heap headers of their containers.
+        std::size_t string_bytes = 0;       ///< Heap capacity of strings (values and keys) beyond the SSO buffer.
+        std::size_t map_node_bytes = 0;     ///< Per-entry tree node overhead of objects, including key objects.
+        std::size_t vector_slack_bytes = 0; ///< Reserved but unused element storage of arrays and binaries.
+
+        [[nodiscard]] std::size_t total() const {
+            return node_bytes + string_bytes + map_node_bytes + vector_slack_bytes;
+        }
+
+        yaml_memory_usage& operator+=(const yaml_memory_usage& other) {
+            node_bytes += other.node_bytes;
+            string_bytes += other.string_bytes;
+            map_node_bytes += other.map_node_bytes;
+            vector_slack_bytes += other.vector_slack_bytes;
+            return *this;
+        }
+    };
+
+    /**
+     * Memory accounting for one subtree of a parsed document. Children are reported down to
+     * the requested depth; deeper levels are folded into their closest reported ancestor.
+     */
+    struct yaml_memory_report {
+        std::string path;                         ///< JSON pointer of the subtree ("" for the document root).
+        yaml_memory_usage usage;                  ///< Estimated bytes of the whole subtree, children included.
+        std::size_t input_bytes = 0;              ///< Raw YAML bytes of the subtree (parse-time reports only).
+        std::vector<yaml_memory_report> children; ///< Reports for direct children, if within depth.
 
         /**
-         * Preprocesses the input stream by removing comments, trimming trailing whitespace,
-         * and storing the resultant lines while preserving the original line structure.
+         * Converts the report into a JSON object, convenient for logging or dumping.
          *
-         * @param input The input stream to preprocess. Typically, it contains raw YAML content.
+         * @return A JSON object with the path, the byte breakdown and the child reports.
          */
-        void preprocess_input(std::istream& input) {
-            std::string line;
-            while (std::getline(input, line)) {
-                // Remove comments
-                if (const size_t comment_pos = line.find('#'); comment_pos != std::string::npos) {
-                    line = line.substr(0, comment_pos);
+        [[nodiscard]] json to_json() const {
+            json out = json::object();
+            out["path"] = path;
+            out["total_bytes"] = usage.total();
+            out["node_bytes"] = usage.node_bytes;
+            out["string_bytes"] = usage.string_bytes;
+            out["map_node_bytes"] = usage.map_node_bytes;
+            out["vector_slack_bytes"] = usage.vector_slack_bytes;
+            if (input_bytes != 0) {
+                out["input_bytes"] = input_bytes;
+            }
+            if (!children.empty()) {
+                json list = json::array();
+                for (const auto& child : children) {
+                    list.push_back(child.to_json());
                 }
-                // Remove trailing whitespace (handle whitespace-only lines safely)
-                if (!line.empty()) {
-                    if (const auto last = line.find_last_not_of(" \t\r\n"); last != std::string::npos) {
-                        line.erase(last + 1);
-                    } else {
-                        line.clear();
+                out["children"] = std::move(list);
+            }
+            return out;
+        }
+    };
+
+    /**
+     * Estimates the bytes held by a JSON value and its subtrees: the `json` nodes themselves,
+     * heap-allocated string capacity, tree-node overhead of objects and unused vector capacity.
+     *
+     * @param value The value to account for, typically the result of `parse_yaml`.
+     * @param depth How many levels of children to report individually. 0 reports the root only.
+     * @param path The JSON pointer of `value`, used to label the report and its children.
+     * @return The memory report for `value`.
+     */
+    inline yaml_memory_report memory_report(const json& value, const std::size_t depth = 1,
+                                            const std::string& path = "") {
+        // Layout constants of the standard containers backing nlohmann::json
+        static const std::size_t sso_capacity = std::string().capacity();
+        constexpr std::size_t map_node_base = 4 * sizeof(void*); // color + parent/left/right links
+
+        const auto string_heap = [](const std::string& str) -> std::size_t {
+            return str.capacity() > sso_capacity ? str.capacity() + 1 : 0;
+        };
+
+        const auto escape_key = [](const std::string& key) {
+            std::string escaped;
+            escaped.reserve(key.size());
+            for (const char c : key) {
+                if (c == '~') {
+                    escaped += "~0";
+                } else if (c == '/') {
+                    escaped += "~1";
+                } else {
+                    escaped += c;
+                }
+            }
+            return escaped;
+        };
+
+        yaml_memory_report report;
+        report.path = path;
+        report.usage.node_bytes = sizeof(json);
+
+        switch (value.type()) {
+            case json::value_t::object: {
+                const auto& object = value.get_ref<const json::object_t&>();
+                report.usage.node_bytes += sizeof(json::object_t);
+                for (const auto& [key, child] : object) {
+                    report.usage.map_node_bytes += map_node_base + sizeof(std::string);
+                    report.usage.string_bytes += string_heap(key);
+
+                    yaml_memory_report child_report = memory_report(child, depth > 0 ? depth - 1 : 0,
+                                                                    path + "/" + escape_key(key));
+                    report.usage += child_report.usage;
+                    if (depth > 0) {
+                        report.children.push_back(std::move(child_report));
+                    }
+                }
+                break;
+            }
+            case json::value_t::array: {
+                const auto& array = value.get_ref<const json::array_t&>();
+                report.usage.node_bytes += sizeof(json::array_t);
+                report.usage.vector_slack_bytes += (array.capacity() - array.size()) * sizeof(json);
+                for (std::size_t i = 0; i < array.size(); ++i) {
+                    yaml_memory_report child_report = memory_report(array[i], depth > 0 ? depth - 1 : 0,
+                                                                    path + "/" + std::to_string(i));
+                    report.usage += child_report.usage;
+                    if (depth > 0) {
+                        report.children.push_back(std::move(child_report));
                     }
                 }
+                break;
+            }
+            case json::value_t::string: {
+                report.usage.node_bytes += sizeof(json::string_t);
+                report.usage.string_bytes += string_heap(value.get_ref<const json::string_t&>());
+                break;
+            }
+            case json::value_t::binary: {
+                const auto& binary = value.get_binary();
+                report.usage.node_bytes += sizeof(json::binary_t) + binary.size();
+                report.usage.vector_slack_bytes += binary.capacity() - binary.size();
+                break;
+            }
+            default:
+                break;
+        }
 
-                // Keep all lines, including empty ones, to maintain the line structure
-                lines.push_back(line);
+        return report;
+    }
+
+    /**
+     * Compile-time chain of scalar resolvers. Every plain (unquoted) scalar is offered to the
+     * resolvers in order before the built-in typing of nulls, booleans and numbers; the first
+     * resolver returning true decides the value. A resolver is any type providing
+     *
+     *     template <typename BasicJsonType>
+     *     static bool resolve(const std::string& value, BasicJsonType& result);
+     *
+     * Because the chain is a template parameter of the parser, resolvers are inlined into the
+     * parse loop instead of being applied in a second pass over the DOM.
+     */
+    template <typename... Resolvers>
+    struct yaml_resolver_chain {
+        template <typename BasicJsonType>
+        static bool resolve(const std::string& value, BasicJsonType& result) {
+            return (Resolvers::resolve(value, result) || ...);
+        }
+    };
+
+    /**
+     * Reads an unsigned or signed decimal number ("12", "-1.5") at the start of a string.
+     *
+     * @param text The text to read from.
+     * @param pos The position to start at; advanced past the number on success.
+     * @param value Receives the number.
+     * @return True if a number was read, otherwise false.
+     */
+    inline bool yaml_read_decimal(const std::string& text, size_t& pos, double& value) {
+        size_t end = pos;
+        if (end < text.size() && (text[end] == '-' || text[end] == '+')) {
+            ++end;
+        }
+
+        size_t digits = 0;
+        while (end < text.size() && text[end] >= '0' && text[end] <= '9') {
+            ++end;
+            ++digits;
+        }
+        if (end < text.size() && text[end] == '.') {
+            ++end;
+            while (end < text.size() && text[end] >= '0' && text[end] <= '9') {
+                ++end;
+                ++digits;
             }
         }
+        if (digits == 0) {
+            return false;
+        }
 
-        /**
-         * Calculates the indentation level of a given line based on spaces and tabs.
-         *
-         * @param line The string for which the indentation level needs to be calculated.
-         * @return The total indentation count, treating spaces as 1 unit and tabs as 2 units by default.
-         */
-        static int get_indent(const std::string& line) {
-            int indent = 0;
-            for (const char i : line) {
-                if (i == ' ') {
-                    indent++;
-                } else if (i == '\t') {
-                    indent += 2;  // Treat tab as 2 spaces (adjust to 4 or 8 if preferred based on convention)
+        value = std::strtod(text.c_str() + pos, nullptr);
+        pos = end;
+        return true;
+    }
+
+    /**
+     * Resolves durations such as "30s", "250ms" or "1h30m" to a number of seconds (floating
+     * point). Supported units are ns, us (or µs), ms, s, m, h and d; several number/unit pairs
+     * may be combined, largest unit first.
+     */
+    struct yaml_duration_resolver {
+        template <typename BasicJsonType>
+        static bool resolve(const std::string& value, BasicJsonType& result) {
+            // Every duration ends with a unit letter
+            if (value.empty() || value.back() < 'a' || value.back() > 'z') {
+                return false;
+            }
+
+            double seconds = 0.0;
+            bool negative = false;
+            size_t pos = 0;
+            if (value[0] == '-' || value[0] == '+') {
+                negative = value[0] == '-';
+                ++pos;
+            }
+
+            while (pos < value.size()) {
+                double amount = 0.0;
+                if (value[pos] == '-' || value[pos] == '+' || !yaml_read_decimal(value, pos, amount)) {
+                    return false;
+                }
+
+                size_t unit_end = pos;
+                while (unit_end < value.size() && (value[unit_end] < '0' || value[unit_end] > '9')
+                       && value[unit_end] != '.') {
+                    ++unit_end;
+                }
+
+                const std::string_view unit(value.data() + pos, unit_end - pos);
+                if (unit == "ns") {
+                    seconds += amount * 1e-9;
+                } else if (unit == "us" || unit == "\xC2\xB5s") {
+                    seconds += amount * 1e-6;
+                } else if (unit == "ms") {
+                    seconds += amount * 1e-3;
+                } else if (unit == "s") {
+                    seconds += amount;
+                } else if (unit == "m") {
+                    seconds += amount * 60.0;
+                } else if (unit == "h") {
+                    seconds += amount * 3600.0;
+                } else if (unit == "d") {
+                    seconds += amount * 86400.0;
                 } else {
-                    break;
+                    return false;
                 }
+                pos = unit_end;
             }
-            return indent;
+
+            result = negative ? -seconds : seconds;
+            return true;
         }
+    };
 
-        /**
-         * Determines the next line's indentation level that is greater than the parent indentation,
-         * starting from a specified line index. Skips empty lines and stops search at the first
-         * line with an indentation level that does not match the condition.
-         *
-         * @param start_line The index of the line to start checking from.
-         * @param parent_indent The indentation level of the parent line used as a reference.
-         * @return The indentation level of the next suitable line if it exists; otherwise, returns -1.
-         */
-        [[nodiscard]] int get_next_sub_indent(const size_t start_line, const int parent_indent) const {
-            size_t peek = start_line;
-            while (peek < lines.size()) {
-                const std::string& p_line = lines[peek];
+    /**
+     * Resolves byte sizes such as "512Mi", "1.5G" or "64KiB" to an unsigned number of bytes.
+     * Decimal units (k/K, M, G, T, P, E, optionally followed by "B") are powers of 1000 and
+     * binary units (Ki, Mi, Gi, Ti, Pi, Ei, optionally followed by "B") are powers of 1024, as
+     * in Kubernetes resource quantities. A bare "B" suffix means bytes.
+     */
+    struct yaml_byte_size_resolver {
+        template <typename BasicJsonType>
+        static bool resolve(const std::string& value, BasicJsonType& result) {
+            if (value.empty() || value[0] == '-' || value[0] == '+') {
+                return false;
+            }
 
-                if (p_line.empty()) {
-                    ++peek;
-                    continue;
+            size_t pos = 0;
+            double amount = 0.0;
+            if (!yaml_read_decimal(value, pos, amount) || pos == value.size()) {
+                return false;
+            }
+
+            std::string_view unit(value.data() + pos, value.size() - pos);
+            if (unit.size() > 1 && unit.back() == 'B') {
+                unit.remove_suffix(1);
+            }
+
+            double multiplier = 1.0;
+            if (unit != "B") {
+                static constexpr char prefixes[] = "KMGTPE";
+                const char prefix = unit.empty() ? '\0' : (unit[0] == 'k' ? 'K' : unit[0]);
+                const char* found = unit.empty() ? nullptr : std::strchr(prefixes, prefix);
+                if (!found || prefix == '\0') {
+                    return false;
                 }
 
-                if (const int p_indent = get_indent(p_line); p_indent > parent_indent) {
-                    return p_indent;
+                const bool binary = unit.size() == 2 && unit[1] == 'i';
+                if (unit.size() != 1 && !binary) {
+                    return false;
+                }
+                for (const char* p = prefixes; p <= found; ++p) {
+                    multiplier *= binary ? 1024.0 : 1000.0;
                 }
+            }
 
-                return -1;
+            const double bytes = amount * multiplier;
+            if (bytes >= 18446744073709551616.0) {
+                return false;
             }
-            return -1;
+            result = static_cast<std::uint64_t>(bytes + 0.5);
+            return true;
+        }
+    };
+
+    /**
+     * Resolves percentages such as "75%" or "12.5%" to a fraction (0.75, 0.125).
+     */
+    struct yaml_percentage_resolver {
+        template <typename BasicJsonType>
+        static bool resolve(const std::string& value, BasicJsonType& result) {
+            if (value.size() < 2 || value.back() != '%') {
+                return false;
+            }
+
+            size_t pos = 0;
+            double amount = 0.0;
+            if (!yaml_read_decimal(value, pos, amount) || pos != value.size() - 1) {
+                return false;
+            }
+
+            result = amount / 100.0;
+            return true;
+        }
+    };
+
+    /**
+     * One span recorded by `yaml_tracer`.
+     */
+    struct yaml_trace_event {
+        static constexpr std::size_t label_size = 40;
+
+        const char* name = nullptr;     ///< Span name; must be a string literal
+        const char* category = nullptr; ///< Span category; must be a string literal
+        std::uint64_t start_ns = 0;     ///< Start, relative to the creation of the tracer
+        std::uint64_t duration_ns = 0;
+        std::uint64_t items = 0;        ///< Number of items processed in the span (0 = not reported)
+        char label[label_size] = {};    ///< Optional detail such as a mapping key, truncated
+    };
+
+    /**
+     * Records spans of parse and emit phases per thread and writes them as Chrome trace events,
+     * which can be opened in Perfetto (ui.perfetto.dev) or chrome://tracing.
+     *
+     * Every thread appends to its own fixed-size ring without locks; when a ring is full the
+     * oldest spans of that thread are overwritten. The trace must be written after the traced
+     * work has finished. Tracing is enabled by passing a tracer through `yaml_parse_options` or
+     * `yaml_emit_options`; without one, the parser only pays for a null pointer check.
+     */
+    class yaml_tracer {
+    public:
+        static constexpr std::size_t max_threads = 256;
+
+    private:
+        struct ring {
+            std::vector<yaml_trace_event> events;
+            std::atomic<std::uint64_t> written{0};
+            std::thread::id owner;
+        };
+
+        const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+        const std::uint64_t id;
+        const std::size_t ring_capacity;
+        std::atomic<ring*> rings[max_threads] = {};
+        std::atomic<std::size_t> ring_count{0};
+        std::atomic<std::uint64_t> dropped_events{0};
+
+        static std::uint64_t next_id() {
+            static std::atomic<std::uint64_t> ids{0};
+            return ++ids;
         }
 
         /**
-         * Parses a JSON array from a given string and returns the corresponding JSON object.
-         * The input string must represent a valid JSON array syntax.
-         *
-         * @param str The string containing the JSON array to parse.
-         * @return A JSON object representing the parsed array.
-         * @throws std::runtime_error If the input string is not a valid JSON array.
+         * Returns the ring of the calling thread, claiming one on first use, or null once
+         * `max_threads` rings are claimed. The rings of recently used tracers are cached per
+         * thread in a small fixed table, so a thread alternating between tracers does not search
+         * for its ring on every span. A thread that reuses the id of a finished thread adopts its
+         * ring.
          */
-        static json parse_json_array(const std::string& str) {
-            try {
-                return json::parse(str);
-            } catch (...) {
-                throw std::runtime_error("Invalid JSON array syntax: " + str);
+        ring* thread_ring() {
+            struct cached_ring {
+                std::uint64_t tracer_id = 0;
+                ring* events = nullptr;
+            };
+            thread_local cached_ring cache[8];
+            cached_ring& slot = cache[id % 8];
+            if (slot.tracer_id == id) {
+                return slot.events;
+            }
+
+            const std::thread::id self = std::this_thread::get_id();
+            std::size_t count = ring_count.load(std::memory_order_acquire);
+            for (std::size_t index = 0; index < std::min(count, max_threads); ++index) {
+                ring* events = rings[index].load(std::memory_order_acquire);
+                if (events != nullptr && events->owner == self) {
+                    slot = {id, events};
+                    return events;
+                }
             }
+
+            // Claim a slot without moving the count past the cap, so dropping threads leave it alone
+            do {
+                if (count >= max_threads) {
+                    slot = {id, nullptr};
+                    return nullptr;
+                }
+            } while (!ring_count.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel));
+            auto* claimed = new ring;
+            claimed->events.resize(ring_capacity);
+            claimed->owner = self;
+            rings[count].store(claimed, std::memory_order_release);
+            slot = {id, claimed};
+            return claimed;
         }
 
+    public:
         /**
-         * Parses a JSON object from a given string and returns the corresponding JSON representation.
-         * The input string must represent a valid JSON object syntax.
+         * Creates a tracer.
          *
-         * @param str The string containing the JSON object to parse.
-         * @return A JSON object representing the parsed input string.
-         * @throws std::runtime_error If the input string is not a valid JSON object.
+         * @param events_per_thread The capacity of every thread's ring.
          */
-        static json parse_json_object(const std::string& str) {
-            try {
-                return json::parse(str);
-            } catch (...) {
-                throw std::runtime_error("Invalid JSON object syntax: " + str);
+        explicit yaml_tracer(const std::size_t events_per_thread = 65536)
+            : id(next_id()), ring_capacity(std::max<std::size_t>(1, events_per_thread)) {}
+
+        yaml_tracer(const yaml_tracer&) = delete;
+        yaml_tracer& operator=(const yaml_tracer&) = delete;
+
+        ~yaml_tracer() {
+            for (auto& slot : rings) {
+                delete slot.load();
             }
         }
 
         /**
-         * Determines whether the provided string represents a valid JSON array.
-         * A valid JSON array is identified by being non-empty, trimmed of leading
-         * and trailing whitespace, and starting with '[' and ending with ']'.
-         *
-         * @param str The string to check for JSON array syntax.
-         * @return True if the string represents a JSON array, otherwise false.
+         * @return Nanoseconds elapsed since the tracer was created.
          */
-        static bool is_json_array(const std::string& str) {
-            std::string trimmed = str;
-            trimmed.erase(0, trimmed.find_first_not_of(" \t"));
-            trimmed.erase(trimmed.find_last_not_of(" \t") + 1);
-            return !trimmed.empty() && trimmed.front() == '[' && trimmed.back() == ']';
+        std::uint64_t now() const {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - origin).count());
         }
 
         /**
-         * Determines whether the provided string represents a valid JSON object.
-         * A valid JSON object is identified by being non-empty, trimmed of leading
-         * and trailing whitespace, and starting with '{' and ending with '}'.
+         * Records a span on the calling thread's ring.
          *
-         * @param str The string to check for JSON object syntax.
-         * @return True if the string represents a JSON object, otherwise false.
+         * @param name The span name; must be a string literal.
+         * @param category The span category; must be a string literal.
+         * @param start_ns The start of the span, from `now()`.
+         * @param end_ns The end of the span, from `now()`.
+         * @param label An optional detail, copied and truncated.
+         * @param items An optional number of processed items.
          */
-        static bool is_json_object(const std::string& str) {
-            std::string trimmed = str;
-            trimmed.erase(0, trimmed.find_first_not_of(" \t"));
-            trimmed.erase(trimmed.find_last_not_of(" \t") + 1);
-            return !trimmed.empty() && trimmed.front() == '{' && trimmed.back() == '}';
+        void record(const char* name, const char* category, const std::uint64_t start_ns, const std::uint64_t end_ns,
+                    const std::string_view label = {}, const std::uint64_t items = 0) {
+            ring* events = thread_ring();
+            if (!events) {
+                ++dropped_events;
+                return;
+            }
+
+            const std::uint64_t position = events->written.load(std::memory_order_relaxed);
+            yaml_trace_event& event = events->events[position % ring_capacity];
+            event.name = name;
+            event.category = category;
+            event.start_ns = start_ns;
+            event.duration_ns = end_ns > start_ns ? end_ns - start_ns : 0;
+            event.items = items;
+            const std::size_t length = label.copy(event.label, yaml_trace_event::label_size - 1);
+            event.label[length] = '\0';
+            events->written.store(position + 1, std::memory_order_release);
         }
 
         /**
-         * Determines whether the given string starts with a JSON token
-         * after ignoring leading whitespace.
-         *
-         * @param str The input string to analyze.
-         * @return True if the string starts with a '[' or '{' character after
-         *         whitespace is trimmed; otherwise, false.
+         * @return The number of spans that were lost, either overwritten in a full ring or
+         *         recorded by more than `max_threads` threads.
          */
-        static bool starts_with_json_token(const std::string& str) {
-            const size_t i = str.find_first_not_of(" \t");
-            if (i == std::string::npos) return false;
-            const char c = str[i];
-            return c == '[' || c == '{';
+        std::uint64_t dropped() const {
+            std::uint64_t lost = dropped_events.load();
+            for (const auto& slot : rings) {
+                if (const ring* events = slot.load(std::memory_order_acquire)) {
+                    const std::uint64_t written = events->written.load(std::memory_order_acquire);
+                    lost += written > ring_capacity ? written - ring_capacity : 0;
+                }
+            }
+            return lost;
         }
 
         /**
-         * Attempts to collect a contiguous JSON block from the current position in the input lines,
-         * starting at a specified indentation level.
-         *
-         * A valid JSON block must begin with either '{' or '[' and adhere to a proper JSON structure,
-         * including balanced brackets and braces. The process respects string literals and escape
-         * characters to avoid misinterpreting JSON content.
+         * Builds the Chrome trace-event document: one complete ("X") event per span and a
+         * thread name per ring, with timestamps in microseconds.
          *
-         * @param current_indent The expected indentation level for the JSON block to start.
-         * @param out_json A reference to a string where the collected JSON block will be stored if successfully found.
-         * @return A boolean indicating whether a valid JSON block was successfully collected.
-         *         Returns true if a valid JSON block is found, false otherwise.
+         * @return The trace as `{"traceEvents": [...], "displayTimeUnit": "ns"}`.
          */
-        bool try_collect_json_block(const int current_indent, std::string& out_json) {
-            const size_t saved_line = current_line;
-
-            size_t i = current_line;
-            bool started = false;
-
-            int curly = 0;
-            int square = 0;
-            bool in_string = false;
-            char quote_char = '\0';
-            bool escape = false;
-
-            std::string buffer;
-
-            while (i < lines.size()) {
-                const std::string& raw = lines[i];
-
-                // Skip empty lines before we start
-                if (!started && raw.empty()) {
-                    i++;
+        json to_chrome_trace() const {
+            json trace_events = json::array();
+            const std::size_t threads = std::min(ring_count.load(), max_threads);
+            for (std::size_t thread = 0; thread < threads; ++thread) {
+                const ring* events = rings[thread].load(std::memory_order_acquire);
+                if (!events) {
                     continue;
                 }
 
-                const int indent = get_indent(raw);
+                trace_events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", thread + 1},
+                                        {"args", {{"name", "yaml thread " + std::to_string(thread + 1)}}}});
 
-                // If we haven't started yet, ensure this line is at the expected indent and starts with { or [
-                if (!started) {
-                    if (indent != current_indent) {
-                        break;
-                    }
-                    std::string content = raw.substr(indent);
-                    // Trim leading spaces for start check
-                    const size_t s = content.find_first_not_of(" \t");
-                    if (s == std::string::npos) {
-                        // nothing meaningful on this line
-                        i++;
-                        continue;
+                const std::uint64_t written = events->written.load(std::memory_order_acquire);
+                const std::uint64_t first = written > ring_capacity ? written - ring_capacity : 0;
+                for (std::uint64_t position = first; position < written; ++position) {
+                    const yaml_trace_event& event = events->events[position % ring_capacity];
+                    json entry = {{"name", event.name}, {"cat", event.category}, {"ph", "X"}, {"pid", 1},
+                                  {"tid", thread + 1}, {"ts", static_cast<double>(event.start_ns) / 1000.0},
+                                  {"dur", static_cast<double>(event.duration_ns) / 1000.0}};
+                    if (event.label[0] != '\0') {
+                        entry["args"]["label"] = event.label;
                     }
-                    if (const char first = content[s]; first != '{' && first != '[') {
-                        // Not a JSON block start
-                        break;
+                    if (event.items != 0) {
+                        entry["args"]["items"] = event.items;
                     }
-                    started = true;
-                }
-
-                // Once started, lines with indent less than current_indent terminate unless we already balanced
-                if (started && indent < current_indent) {
-                    break;
+                    trace_events.push_back(std::move(entry));
                 }
+            }
+            return {{"traceEvents", std::move(trace_events)}, {"displayTimeUnit", "ns"}};
+        }
 
-                const std::string content = raw.substr(indent);
+        /**
+         * Writes the Chrome trace-event JSON to a stream.
+         *
+         * @param os The output stream, e.g. a `trace.json` file.
+         */
+        void write_chrome_trace(std::ostream& os) const {
+            os << to_chrome_trace().dump();
+        }
+    };
 
-                // Append content to buffer (newline separates lines; JSON allows whitespace)
-                if (!buffer.empty()) {
-                    buffer.push_back('\n');
-                }
-                buffer.append(content);
+    /**
+     * Records a span from its construction to its destruction; does nothing without a tracer.
+     */
+    class yaml_trace_scope {
+        yaml_tracer* tracer;
+        const char* name;
+        std::uint64_t start_ns = 0;
+        std::uint64_t items = 0;
+        char label[yaml_trace_event::label_size] = {};
 
-                // Scan content to update bracket/brace counters while respecting strings
-                for (const char c : content) {
-                    if (in_string) {
-                        if (escape) {
-                            escape = false;
-                        } else if (c == '\\') {
-                            escape = true;
-                        } else if (c == quote_char) {
-                            in_string = false;
-                        }
-                    } else {
-                        if (c == '"' || c == '\'') {
-                            in_string = true;
-                            quote_char = c;
-                        } else if (c == '{') {
-                            ++curly;
-                        } else if (c == '}') {
-                            --curly;
-                        } else if (c == '[') {
-                            ++square;
-                        } else if (c == ']') {
-                            --square;
-                        }
-                    }
-                }
+    public:
+        yaml_trace_scope(yaml_tracer* span_tracer, const char* span_name, const std::string_view span_label = {})
+            : tracer(span_tracer), name(span_name) {
+            if (tracer) {
+                span_label.copy(label, yaml_trace_event::label_size - 1);
+                start_ns = tracer->now();
+            }
+        }
 
-                ++i;
+        yaml_trace_scope(const yaml_trace_scope&) = delete;
+        yaml_trace_scope& operator=(const yaml_trace_scope&) = delete;
 
-                if (started && curly <= 0 && square <= 0) {
-                    // Completed a JSON value
-                    current_line = i;
-                    out_json = buffer;
-                    return true;
-                }
-            }
+        /**
+         * Sets the number of items reported for the span.
+         */
+        void set_items(const std::uint64_t count) {
+            items = count;
+        }
 
-            // Not a valid/complete JSON block – restore and signal failure
-            current_line = saved_line;
-            return false;
+        ~yaml_trace_scope() {
+            if (tracer) {
+                tracer->record(name, "yaml", start_ns, tracer->now(), label, items);
+            }
         }
+    };
+
+    /**
+     * Aggregated statistics of the parses recorded under one label.
+     */
+    struct yaml_parse_stats {
+        /// Number of latency buckets, the last one being +Inf
+        static constexpr std::size_t bucket_count = 48;
+
+        std::string label;
+        std::uint64_t calls = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t latency_sum_ns = 0;
+        std::map<std::string, std::uint64_t> errors;   ///< Failed calls by error type
+        std::uint64_t buckets[bucket_count] = {};      ///< Calls per latency bucket (not cumulative)
 
         /**
-         * Parses a scalar value from a string and converts it to the appropriate JSON-compatible type.
-         * Handles various data formats such as strings, numbers, booleans, nulls, and special YAML values.
-         * Also, processes quoted strings and escaped characters.
+         * Returns the upper bound of a latency bucket. Bounds grow by a factor of sqrt(2) from
+         * 1 microsecond, so the finite buckets reach about 8 minutes.
          *
-         * @param value The input string containing the scalar value to parse.
-         * @return A JSON array representing the parsed sequence.
+         * @param bucket The bucket index.
+         * @return The bound in nanoseconds; the last bucket has no bound (max of `std::uint64_t`).
          */
-        static json parse_scalar(const std::string& value) {
-            std::string val = value;
-
-            // Remove leading/trailing whitespace
-            val.erase(0, val.find_first_not_of(" \t"));
-            val.erase(val.find_last_not_of(" \t") + 1);
+        static std::uint64_t bucket_bound_ns(const std::size_t bucket) {
+            static const auto bounds = [] {
+                std::array<std::uint64_t, bucket_count> values{};
+                for (std::size_t i = 0; i + 1 < bucket_count; ++i) {
+                    values[i] = static_cast<std::uint64_t>(std::llround(1000.0 * std::pow(2.0, 0.5 * static_cast<double>(i))));
+                }
+                values[bucket_count - 1] = (std::numeric_limits<std::uint64_t>::max)();
+                return values;
+            }();
+            return bounds[bucket];
+        }
 
-            // Check for JSON array syntax
-            if (is_json_array(val)) {
-                return parse_json_array(val);
+        /**
+         * @return The index of the bucket counting a latency.
+         */
+        static std::size_t bucket_of(const std::uint64_t latency_ns) {
+            std::size_t bucket = 0;
+            while (latency_ns > bucket_bound_ns(bucket)) {
+                ++bucket;
             }
+            return bucket;
+        }
 
-            // Check for JSON object syntax
-            if (is_json_object(val)) {
-                return parse_json_object(val);
+        /**
+         * Estimates a latency quantile by interpolating linearly inside the bucket that holds it.
+         *
+         * @param q The quantile in [0, 1], e.g. 0.99.
+         * @return The estimated latency in seconds (0 without calls).
+         */
+        [[nodiscard]] double latency_quantile(const double q) const {
+            if (calls == 0) {
+                return 0.0;
             }
-
-            // Remove quotes if present
-            if (!val.empty() && ((val.front() == '"' && val.back() == '"') ||
-                                (val.front() == '\'' && val.back() == '\''))) {
-                val = val.substr(1, val.size() - 2);
-                // Handle escaped characters in quoted strings
-                std::string result;
-                for (size_t i = 0; i < val.size(); ++i) {
-                    if (val[i] == '\\' && i + 1 < val.size()) {
-                        switch (val[i + 1]) {
-                            case 'n': result += '\n'; break;
-                            case 't': result += '\t'; break;
-                            case 'r': result += '\r'; break;
-                            case '\\': result += '\\'; break;
-                            case '"': result += '"'; break;
-                            case '\'': result += '\''; break;
-                            default: result += val[i + 1]; break;
-                        }
-                        ++i; // skip the escaped character
-                    } else {
-                        result += val[i];
-                    }
+            const double rank = std::min(1.0, std::max(0.0, q)) * static_cast<double>(calls);
+            double seen = 0.0;
+            for (std::size_t i = 0; i < bucket_count; ++i) {
+                if (buckets[i] == 0 || seen + static_cast<double>(buckets[i]) < rank) {
+                    seen += static_cast<double>(buckets[i]);
+                    continue;
                 }
-                return result;
+                const double lower = i == 0 ? 0.0 : static_cast<double>(bucket_bound_ns(i - 1));
+                if (i + 1 == bucket_count) {
+                    return lower / 1e9;
+                }
+                const double upper = static_cast<double>(bucket_bound_ns(i));
+                return (lower + (upper - lower) * (rank - seen) / static_cast<double>(buckets[i])) / 1e9;
             }
+            return static_cast<double>(bucket_bound_ns(bucket_count - 2)) / 1e9;
+        }
+    };
 
-            // Handle special YAML values
-            if (val == "null" || val == "~" || val == "Null" || val == "NULL") return nullptr;
-            if (val == "true" || val == "True" || val == "TRUE") return true;
-            if (val == "false" || val == "False" || val == "FALSE") return false;
+    /**
+     * Process-wide parse metrics: call and byte counts, failures by error type and a latency
+     * histogram per caller-supplied label. Set `yaml_parse_options::metrics` (and `metrics_label`)
+     * to record every parse made with those options.
+     *
+     * Every thread updates its own counters for a label with relaxed atomic increments; the
+     * counters are registered in a lock-free list on the thread's first parse with that label.
+     * `snapshot()` sums them per label and `write_prometheus` renders them in the Prometheus text
+     * exposition format.
+     */
+    class yaml_metrics {
+        struct shard {
+            std::string label;
+            std::thread::id owner;
+            std::atomic<std::uint64_t> calls{0};
+            std::atomic<std::uint64_t> bytes{0};
+            std::atomic<std::uint64_t> latency_sum_ns{0};
+            std::atomic<std::uint64_t> errors[5] = {};
+            std::atomic<std::uint64_t> buckets[yaml_parse_stats::bucket_count] = {};
+            shard* next = nullptr;
+        };
 
-            // Handle special float values
-            if (val == ".inf" || val == ".Inf" || val == ".INF" || val == "+.inf") {
-                return std::numeric_limits<double>::infinity();
-            }
+        static constexpr const char* error_types[5] = {"parse", "json", "io", "memory", "other"};
 
-            if (val == "-.inf" || val == "-.Inf" || val == "-.INF") {
-                return -std::numeric_limits<double>::infinity();
-            }
+        const std::uint64_t id;
+        std::atomic<shard*> shards{nullptr};
 
-            if (val == ".nan" || val == ".NaN" || val == ".NAN") {
-                return std::numeric_limits<double>::quiet_NaN();
-            }
+        static std::uint64_t next_id() {
+            static std::atomic<std::uint64_t> ids{0};
+            return ++ids;
+        }
 
-            // Try parsing as different number formats
-            try {
-                // Handle different number bases
-                if (val.size() > 2 && val[0] == '0') {
-                    if (val[1] == 'x' || val[1] == 'X') {
-                        // Hexadecimal
-                        return std::stoi(val, nullptr, 16);
-                    } else if (val[1] == 'o' || val[1] == 'O') {
-                        // Octal
-                        return std::stoi(val.substr(2), nullptr, 8);
-                    } else if (val[1] == 'b' || val[1] == 'B') {
-                        // Binary
-                        return std::stoi(val.substr(2), nullptr, 2);
-                    }
-                }
-
-                // Handle scientific notation and regular numbers
-                if (val.find('.') != std::string::npos
-                    || val.find('e') != std::string::npos
-                    || val.find('E') != std::string::npos) {
-                    return std::stod(val);
-                }
-
-                // Handle negative numbers
-                if (val[0] == '-' || val[0] == '+') {
-                    if (val.find('.') != std::string::npos
-                        || val.find('e') != std::string::npos
-                        || val.find('E') != std::string::npos) {
-                        return std::stod(val);
-                    } else {
-                        return std::stoll(val);
-                    }
+        /**
+         * Returns the calling thread's counters for a label, registering them on first use. The
+         * eight most recently used (registry, label) pairs are cached per thread, most recent
+         * first, so a thread alternating between up to eight labels never walks the shard list. A
+         * thread that reuses the id of a finished thread adopts its counters.
+         */
+        shard* thread_shard(const std::string_view label) {
+            struct cached_shard {
+                std::uint64_t metrics_id = 0;
+                shard* counters = nullptr;
+            };
+            constexpr std::size_t cache_size = 8;
+            thread_local cached_shard cache[cache_size];
+            for (std::size_t i = 0; i < cache_size; ++i) {
+                if (cache[i].metrics_id == id && cache[i].counters->label == label) {
+                    std::rotate(cache, cache + i, cache + i + 1);
+                    return cache[0].counters;
                 }
+            }
 
-                return std::stoll(val);
-            } catch (...) {
-                return val; // Return as string
+            const std::thread::id self = std::this_thread::get_id();
+            shard* counters = shards.load(std::memory_order_acquire);
+            while (counters != nullptr && (counters->owner != self || counters->label != label)) {
+                counters = counters->next;
+            }
+            if (counters == nullptr) {
+                counters = new shard;
+                counters->label = std::string(label);
+                counters->owner = self;
+                counters->next = shards.load(std::memory_order_relaxed);
+                while (!shards.compare_exchange_weak(counters->next, counters, std::memory_order_release,
+                                                     std::memory_order_relaxed)) {
+                }
             }
+            // The least recently used entry is dropped
+            std::rotate(cache, cache + cache_size - 1, cache + cache_size);
+            cache[0] = {id, counters};
+            return counters;
         }
 
         /**
-         * Parses a YAML-style sequence from the current position in the input lines, constructing a JSON array
-         * with the appropriate structure based on indentation and content rules.
+         * Counts one call in the calling thread's shard.
          *
-         * @param current_indent The current level of indentation in the input, used to determine sequence boundaries.
-         * @return A JSON array representing the parsed sequence.
-         * @throws std::runtime_error If syntax issues or unexpected input structures are encountered during parsing.
+         * @return The shard, for counting the call's error.
          */
-        json parse_sequence(const int current_indent) {
-            json array = json::array();
+        shard* record_call(const std::string_view label, const std::uint64_t bytes, const std::uint64_t latency_ns) {
+            shard* counters = thread_shard(label);
+            counters->calls.fetch_add(1, std::memory_order_relaxed);
+            counters->bytes.fetch_add(bytes, std::memory_order_relaxed);
+            counters->latency_sum_ns.fetch_add(latency_ns, std::memory_order_relaxed);
+            counters->buckets[yaml_parse_stats::bucket_of(latency_ns)].fetch_add(1, std::memory_order_relaxed);
+            return counters;
+        }
 
-            while (current_line < lines.size()) {
-                const std::string& line = lines[current_line];
+        /**
+         * @return The index in `error_types` of the exception being handled.
+         */
+        static std::size_t error_index(const std::exception_ptr& error) {
+            NLOHMANN_YAML_TRY {
+                std::rethrow_exception(error);
+            } NLOHMANN_YAML_CATCH(const std::bad_alloc&) {
+                return 3;
+            } NLOHMANN_YAML_CATCH(const std::ios_base::failure&) {
+                return 2;
+            } NLOHMANN_YAML_CATCH(const json::exception&) {
+                return 1;
+            } NLOHMANN_YAML_CATCH(const std::runtime_error&) {
+                return 0;
+            } NLOHMANN_YAML_CATCH(...) {
+                return 4;
+            }
+        }
 
-                // Skip empty lines
-                if (line.empty()) {
-                    current_line++;
-                    continue;
+        static void write_label(std::ostream& os, const std::string& value) {
+            for (const char c : value) {
+                if (c == '\\' || c == '"') {
+                    os << '\\' << c;
+                } else if (c == '\n') {
+                    os << "\\n";
+                } else {
+                    os << c;
                 }
+            }
+        }
 
-                const int line_indent = get_indent(line);
+    public:
+        yaml_metrics() : id(next_id()) {}
 
-                // If indentation is less than the current level, we're done
-                if (line_indent < current_indent) {
-                    break;
-                }
+        yaml_metrics(const yaml_metrics&) = delete;
+        yaml_metrics& operator=(const yaml_metrics&) = delete;
 
-                // If indentation doesn't match, break
-                if (line_indent != current_indent) {
-                    break;
-                }
+        ~yaml_metrics() {
+            for (shard* current = shards.load(); current != nullptr;) {
+                shard* next = current->next;
+                delete current;
+                current = next;
+            }
+        }
 
-                // Check if this is a sequence item
-                if (line[line_indent] != '-') {
-                    break;
-                }
+        /**
+         * @return The registry shared by the whole process.
+         */
+        static yaml_metrics& global() {
+            static yaml_metrics instance;
+            return instance;
+        }
 
-                current_line++;
+        /**
+         * Records one parse call.
+         *
+         * @param label The call site label.
+         * @param bytes The input size.
+         * @param latency_ns The duration of the call.
+         * @param error The exception the call failed with, or null if it succeeded.
+         */
+        void record(const std::string_view label, const std::uint64_t bytes, const std::uint64_t latency_ns,
+                    const std::exception_ptr& error = nullptr) {
+            shard* counters = record_call(label, bytes, latency_ns);
+            if (error) {
+                counters->errors[error_index(error)].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
 
-                // Extract the value after the dash
-                std::string value = line.substr(line_indent + 1);
-                value.erase(0, value.find_first_not_of(" \t"));
+        /**
+         * Records one parse call that failed without an exception, counted as a "parse" error.
+         *
+         * @param label The call site label.
+         * @param bytes The input size.
+         * @param latency_ns The duration of the call.
+         */
+        void record_failure(const std::string_view label, const std::uint64_t bytes, const std::uint64_t latency_ns) {
+            record_call(label, bytes, latency_ns)->errors[0].fetch_add(1, std::memory_order_relaxed);
+        }
 
-                if (value.empty()) {
-                    // Complex value on next line(s)
-                    int sub_indent = get_next_sub_indent(current_line, current_indent);
-                    if (sub_indent == -1) {
-                        throw std::runtime_error("Expected indented block for sequence item at line "
-                            + std::to_string(current_line - 1));
-                    }
-                    json sub = parse_value(sub_indent);
-                    if (sub.is_null()) {
-                        throw std::runtime_error("Failed to parse block for sequence item at line "
-                            + std::to_string(current_line - 1));
+        /**
+         * Sums the counters of all threads per label.
+         *
+         * @return The statistics of every label, sorted by label.
+         */
+        [[nodiscard]] std::vector<yaml_parse_stats> snapshot() const {
+            std::map<std::string, yaml_parse_stats> by_label;
+            for (const shard* current = shards.load(std::memory_order_acquire); current != nullptr;
+                 current = current->next) {
+                yaml_parse_stats& stats = by_label[current->label];
+                stats.label = current->label;
+                stats.calls += current->calls.load(std::memory_order_relaxed);
+                stats.bytes += current->bytes.load(std::memory_order_relaxed);
+                stats.latency_sum_ns += current->latency_sum_ns.load(std::memory_order_relaxed);
+                for (std::size_t i = 0; i < 5; ++i) {
+                    if (const std::uint64_t count = current->errors[i].load(std::memory_order_relaxed)) {
+                        stats.errors[error_types[i]] += count;
                     }
-                    array.push_back(sub);
-                } else if (!value.empty() && value[0] == '-') {
-                    // Inline nested sequence - handle specially
-                    json nested_array = json::array();
+                }
+                for (std::size_t i = 0; i < yaml_parse_stats::bucket_count; ++i) {
+                    stats.buckets[i] += current->buckets[i].load(std::memory_order_relaxed);
+                }
+            }
 
-                    // Parse the current line as nested sequence items
-                    std::string remaining = value;
-                    while (!remaining.empty() && remaining[0] == '-') {
-                        remaining = remaining.substr(1); // Remove the dash
-                        remaining.erase(0, remaining.find_first_not_of(" \t"));
+            std::vector<yaml_parse_stats> result;
+            result.reserve(by_label.size());
+            for (auto& entry : by_label) {
+                result.push_back(std::move(entry.second));
+            }
+            return result;
+        }
 
-                        // Find the next dash or end of line
-                        size_t next_dash = remaining.find(" -");
-                        std::string item_value;
-                        if (next_dash != std::string::npos) {
-                            item_value = remaining.substr(0, next_dash);
-                            remaining = remaining.substr(next_dash + 1);
-                            remaining.erase(0, remaining.find_first_not_of(" \t"));
-                        } else {
-                            item_value = remaining;
-                            remaining.clear();
-                        }
+        /**
+         * Writes the metrics in the Prometheus text exposition format: the counters
+         * `<prefix>_parse_calls_total`, `<prefix>_parse_bytes_total` and
+         * `<prefix>_parse_errors_total` (with a `type` label), and the histogram
+         * `<prefix>_parse_duration_seconds`, all labelled with `label`.
+         *
+         * @param os The output stream, e.g. the body of a metrics endpoint.
+         * @param prefix The metric name prefix.
+         */
+        void write_prometheus(std::ostream& os, const std::string& prefix = "nlohmann_yaml") const {
+            const std::vector<yaml_parse_stats> stats = snapshot();
+            const auto series = [&](const char* name, const char* type, const char* help, const auto& write_samples) {
+                os << "# HELP " << prefix << name << ' ' << help << "\n# TYPE " << prefix << name << ' ' << type << '\n';
+                for (const yaml_parse_stats& entry : stats) {
+                    write_samples(entry);
+                }
+            };
+            const auto sample = [&](const char* name, const yaml_parse_stats& entry, const char* extra_label = nullptr,
+                                    const std::string& extra_value = {}) -> std::ostream& {
+                os << prefix << name << "{label=\"";
+                write_label(os, entry.label);
+                os << '"';
+                if (extra_label) {
+                    os << ',' << extra_label << "=\"" << extra_value << '"';
+                }
+                return os << "} ";
+            };
 
-                        if (!item_value.empty()) {
-                            nested_array.push_back(parse_scalar(item_value));
-                        }
+            series("_parse_calls_total", "counter", "YAML parse calls.", [&](const yaml_parse_stats& entry) {
+                sample("_parse_calls_total", entry) << entry.calls << '\n';
+            });
+            series("_parse_bytes_total", "counter", "YAML input bytes parsed.", [&](const yaml_parse_stats& entry) {
+                sample("_parse_bytes_total", entry) << entry.bytes << '\n';
+            });
+            series("_parse_errors_total", "counter", "Failed YAML parse calls by error type.",
+                   [&](const yaml_parse_stats& entry) {
+                for (const auto& error : entry.errors) {
+                    sample("_parse_errors_total", entry, "type", error.first) << error.second << '\n';
+                }
+            });
+            series("_parse_duration_seconds", "histogram", "YAML parse latency.", [&](const yaml_parse_stats& entry) {
+                std::uint64_t cumulative = 0;
+                for (std::size_t i = 0; i < yaml_parse_stats::bucket_count; ++i) {
+                    cumulative += entry.buckets[i];
+                    std::ostringstream bound;
+                    if (i + 1 == yaml_parse_stats::bucket_count) {
+                        bound << "+Inf";
+                    } else {
+                        bound << static_cast<double>(yaml_parse_stats::bucket_bound_ns(i)) / 1e9;
                     }
+                    sample("_parse_duration_seconds_bucket", entry, "le", bound.str()) << cumulative << '\n';
+                }
+                sample("_parse_duration_seconds_sum", entry) << static_cast<double>(entry.latency_sum_ns) / 1e9 << '\n';
+                sample("_parse_duration_seconds_count", entry) << entry.calls << '\n';
+            });
+        }
 
-                    // Now check for continuation lines at higher indentation
-                    int sub_indent = -1;
-                    while (current_line < lines.size()) {
-                        const std::string& next_line = lines[current_line];
-                        if (next_line.empty()) {
-                            current_line++;
-                            continue;
-                        }
+        /**
+         * @return The metrics in the Prometheus text exposition format.
+         */
+        [[nodiscard]] std::string to_prometheus(const std::string& prefix = "nlohmann_yaml") const {
+            std::ostringstream os;
+            write_prometheus(os, prefix);
+            return os.str();
+        }
+    };
 
-                        const int next_indent = get_indent(next_line);
-                        if (next_indent <= current_indent) {
-                            break; // End of this nested sequence
-                        }
+    /**
+     * Runs `count` independent tasks on up to `threads` threads (the calling thread included),
+     * rethrowing the first failure once all of them have finished.
+     *
+     * @param threads The maximum number of threads.
+     * @param count The number of tasks.
+     * @param task Called with every task index in [0, count).
+     */
+    template <typename Task>
+    void yaml_run_tasks(const size_t threads, const size_t count, Task&& task) {
+        std::atomic<size_t> next{0};
+        std::exception_ptr failure;
+        std::mutex failure_mutex;
 
-                        if (next_line[next_indent] == '-') {
-                            if (sub_indent == -1) {
-                                sub_indent = next_indent;
-                            } else if (next_indent != sub_indent) {
-                                throw std::runtime_error(
-                                    "Inconsistent indentation in nested sequence continuation at line "
-                                    + std::to_string(current_line));
-                            }
-                            current_line++;
-                            std::string next_value = next_line.substr(next_indent + 1);
-                            next_value.erase(0, next_value.find_first_not_of(" \t"));
-                            nested_array.push_back(parse_scalar(next_value));
-                        } else {
-                            break;
-                        }
+        const auto worker = [&] {
+            for (size_t i = next++; i < count; i = next++) {
+                NLOHMANN_YAML_TRY {
+                    task(i);
+                } NLOHMANN_YAML_CATCH(...) {
+                    const std::lock_guard<std::mutex> lock(failure_mutex);
+                    if (!failure) {
+                        failure = std::current_exception();
                     }
+                }
+            }
+        };
 
-                    array.push_back(nested_array);
-                } else if (value.find(':') != std::string::npos) {
-                    // Inline mapping
-                    json obj = json::object();
+        std::vector<std::thread> workers;
+        const size_t worker_count = std::min(threads, count);
+        for (size_t i = 1; i < worker_count; ++i) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    /**
+     * Encodings of YAML input, as detected from the byte order mark or the null-byte pattern of
+     * the first character (YAML 1.2, section 5.2).
+     */
+    enum class yaml_encoding {
+        utf8,
+        utf16le,
+        utf16be,
+        utf32le,
+        utf32be
+    };
+
+    /**
+     * The detected encoding of an input and the size of its byte order mark.
+     */
+    struct yaml_encoding_info {
+        yaml_encoding encoding = yaml_encoding::utf8;
+        std::size_t bom_size = 0; ///< Bytes of the byte order mark to skip (0 if there is none)
+    };
+
+    /**
+     * Detects the encoding of YAML input from its leading bytes. Without a byte order mark, the
+     * null bytes around a leading ASCII character identify UTF-16 and UTF-32.
+     *
+     * @param input The input, or at least its first 4 bytes.
+     * @return The detected encoding; UTF-8 when nothing else matches.
+     */
+    inline yaml_encoding_info detect_yaml_encoding(const std::string_view input) {
+        const auto byte = [&](const size_t i) {
+            return i < input.size() ? static_cast<unsigned char>(input[i]) : -1;
+        };
+        if (input.size() >= 4 && byte(0) == 0x00 && byte(1) == 0x00) {
+            if (byte(2) == 0xfe && byte(3) == 0xff) {
+                return {yaml_encoding::utf32be, 4};
+            }
+            if (byte(2) == 0x00) {
+                return {yaml_encoding::utf32be, 0};
+            }
+        }
+        if (input.size() >= 4 && byte(2) == 0x00 && byte(3) == 0x00) {
+            if (byte(0) == 0xff && byte(1) == 0xfe) {
+                return {yaml_encoding::utf32le, 4};
+            }
+            if (byte(1) == 0x00) {
+                return {yaml_encoding::utf32le, 0};
+            }
+        }
+        if (byte(0) == 0xfe && byte(1) == 0xff) {
+            return {yaml_encoding::utf16be, 2};
+        }
+        if (byte(0) == 0xff && byte(1) == 0xfe) {
+            return {yaml_encoding::utf16le, 2};
+        }
+        if (input.size() >= 2 && byte(0) == 0x00) {
+            return {yaml_encoding::utf16be, 0};
+        }
+        if (input.size() >= 2 && byte(1) == 0x00) {
+            return {yaml_encoding::utf16le, 0};
+        }
+        if (byte(0) == 0xef && byte(1) == 0xbb && byte(2) == 0xbf) {
+            return {yaml_encoding::utf8, 3};
+        }
+        return {};
+    }
+
+    /**
+     * Writes one code point as UTF-8.
+     *
+     * @param out The output position; advanced past the written bytes.
+     * @param code_point A Unicode scalar value.
+     */
+    inline void yaml_write_utf8(char*& out, const std::uint32_t code_point) {
+        if (code_point < 0x80) {
+            *out++ = static_cast<char>(code_point);
+        } else if (code_point < 0x800) {
+            *out++ = static_cast<char>(0xc0 | (code_point >> 6));
+            *out++ = static_cast<char>(0x80 | (code_point & 0x3f));
+        } else if (code_point < 0x10000) {
+            *out++ = static_cast<char>(0xe0 | (code_point >> 12));
+            *out++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (code_point & 0x3f));
+        } else {
+            *out++ = static_cast<char>(0xf0 | (code_point >> 18));
+            *out++ = static_cast<char>(0x80 | ((code_point >> 12) & 0x3f));
+            *out++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (code_point & 0x3f));
+        }
+    }
+
+    /**
+     * Transcodes UTF-16 or UTF-32 input (without its byte order mark) to UTF-8. Runs of ASCII are
+     * converted 8 code units at a time with SSE2 where available; other characters go through the
+     * scalar encoder. The output is sized for the worst case once and trimmed at the end.
+     *
+     * @param input The encoded input.
+     * @param encoding The encoding of the input; UTF-8 input is copied unchanged.
+     * @param output Receives the UTF-8 text.
+     * @param error Receives the error message if the input is truncated, contains an unpaired
+     *              surrogate or a code point outside the Unicode range.
+     * @param offset The position of `input` in the whole input, added to the byte positions of
+     *               error messages when the input is transcoded in chunks.
+     * @return Whether the input was transcoded.
+     */
+    inline bool try_transcode_to_utf8(const std::string_view input, const yaml_encoding encoding, std::string& output,
+                                      std::string& error, const std::size_t offset = 0) {
+        const auto* src = reinterpret_cast<const unsigned char*>(input.data());
+
+        if (encoding == yaml_encoding::utf16le || encoding == yaml_encoding::utf16be) {
+            if (input.size() % 2 != 0) {
+                error = "Invalid UTF-16 input: odd number of bytes";
+                return false;
+            }
+            const bool big_endian = encoding == yaml_encoding::utf16be;
+            const size_t units = input.size() / 2;
+            const auto unit = [&](const size_t i) -> std::uint32_t {
+                return big_endian ? (src[2 * i] << 8) | src[2 * i + 1] : (src[2 * i + 1] << 8) | src[2 * i];
+            };
+
+            output.resize(units * 3); // a BMP code unit takes at most 3 bytes, a surrogate pair 4
+            char* out = output.data();
+            size_t i = 0;
+            while (i < units) {
+#if defined(NLOHMANN_YAML_HAS_SSE2)
+                for (; i + 8 <= units; i += 8) {
+                    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+                    if (big_endian) {
+                        block = _mm_or_si128(_mm_slli_epi16(block, 8), _mm_srli_epi16(block, 8));
+                    }
+                    const __m128i high = _mm_and_si128(block, _mm_set1_epi16(static_cast<short>(0xff80)));
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xffff) {
+                        break;
+                    }
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(block, block));
+                    out += 8;
+                }
+#endif
+                // Scalar path for the next block (or the tail) containing non-ASCII characters
+                for (const size_t block_end = std::min(units, i + 8); i < block_end; ++i) {
+                    std::uint32_t code_point = unit(i);
+                    if (code_point >= 0xd800 && code_point <= 0xdfff) {
+                        const std::uint32_t low = i + 1 < units ? unit(i + 1) : 0;
+                        if (code_point > 0xdbff || low < 0xdc00 || low > 0xdfff) {
+                            error = "Invalid UTF-16 input: unpaired surrogate at byte " + std::to_string(offset + 2 * i);
+                            return false;
+                        }
+                        code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+                        ++i;
+                    }
+                    yaml_write_utf8(out, code_point);
+                }
+            }
+            output.resize(static_cast<size_t>(out - output.data()));
+            return true;
+        }
+
+        if (encoding == yaml_encoding::utf32le || encoding == yaml_encoding::utf32be) {
+            if (input.size() % 4 != 0) {
+                error = "Invalid UTF-32 input: length is not a multiple of 4 bytes";
+                return false;
+            }
+            const bool big_endian = encoding == yaml_encoding::utf32be;
+            const size_t units = input.size() / 4;
+
+            output.resize(units * 4);
+            char* out = output.data();
+            size_t i = 0;
+            while (i < units) {
+#if defined(NLOHMANN_YAML_HAS_SSE2)
+                const auto load = [&](const size_t at) {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * at));
+                    if (big_endian) {
+                        const __m128i mask = _mm_set1_epi32(0x00ff00ff);
+                        v = _mm_or_si128(_mm_slli_epi32(v, 16), _mm_srli_epi32(v, 16));     // swap halves
+                        v = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, mask), 8),
+                                         _mm_and_si128(_mm_srli_epi16(v, 8), mask));        // swap bytes
+                    }
+                    return v;
+                };
+                const __m128i non_ascii = _mm_set1_epi32(static_cast<int>(0xffffff80));
+                for (; i + 8 <= units; i += 8) {
+                    const __m128i first = load(i);
+                    const __m128i second = load(i + 4);
+                    const __m128i high = _mm_and_si128(_mm_or_si128(first, second), non_ascii);
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) != 0xffff) {
+                        break;
+                    }
+                    const __m128i words = _mm_packs_epi32(first, second);
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(words, words));
+                    out += 8;
+                }
+#endif
+                for (const size_t block_end = std::min(units, i + 8); i < block_end; ++i) {
+                    const unsigned char* p = src + 4 * i;
+                    const std::uint32_t code_point = big_endian
+                        ? (std::uint32_t{p[0]} << 24) | (std::uint32_t{p[1]} << 16) | (std::uint32_t{p[2]} << 8) | p[3]
+                        : (std::uint32_t{p[3]} << 24) | (std::uint32_t{p[2]} << 16) | (std::uint32_t{p[1]} << 8) | p[0];
+                    if (code_point > 0x10ffff || (code_point >= 0xd800 && code_point <= 0xdfff)) {
+                        error = "Invalid UTF-32 input: invalid code point at byte " + std::to_string(offset + 4 * i);
+                        return false;
+                    }
+                    yaml_write_utf8(out, code_point);
+                }
+            }
+            output.resize(static_cast<size_t>(out - output.data()));
+            return true;
+        }
+
+        output.assign(input);
+        return true;
+    }
+
+    /**
+     * Transcodes UTF-16 or UTF-32 input (without its byte order mark) to UTF-8, see
+     * `try_transcode_to_utf8`.
+     *
+     * @param input The encoded input.
+     * @param encoding The encoding of the input; UTF-8 input is copied unchanged.
+     * @param output Receives the UTF-8 text.
+     * @throws std::runtime_error If the input is truncated, contains an unpaired surrogate or a
+     *                            code point outside the Unicode range.
+     */
+    inline void transcode_to_utf8(const std::string_view input, const yaml_encoding encoding, std::string& output) {
+        if (std::string error; !try_transcode_to_utf8(input, encoding, output, error)) {
+            NLOHMANN_YAML_THROW(std::runtime_error(error));
+        }
+    }
+
+    /**
+     * Subtypes of the `json::binary_t` values produced by the parser for data that is not kept as
+     * a regular JSON DOM.
+     */
+    enum class yaml_binary_subtype : std::uint8_t {
+        raw_json = 0x4a,      ///< The original text of an embedded JSON array or object
+        packed_int64 = 0x69,  ///< A sequence of integers as little-endian 64-bit two's complement values
+        packed_double = 0x64  ///< A sequence of floating-point numbers as little-endian IEEE 754 doubles
+    };
+
+    /**
+     * Options controlling how `basic_yaml_parser` builds the document.
+     */
+    struct yaml_parse_options {
+        /// Embedded JSON arrays/objects whose text is at least this many bytes are kept as raw
+        /// text instead of being parsed (0 disables the size threshold)
+        std::size_t raw_json_min_bytes = 0;
+
+        /// JSON pointers (e.g. "/services/0/payload") of values kept as raw text when they are
+        /// embedded JSON, regardless of their size
+        std::vector<std::string> raw_json_paths;
+
+        /// Whether raw JSON is checked with `json::accept` (no DOM is built); when disabled, only
+        /// bracket balance is checked
+        bool validate_raw_json = true;
+
+        /// Nested sequences (block or flow) of at least this many items that are all integers, or
+        /// all floating-point numbers, are stored packed (see `pack_numeric_sequence`); 0 disables
+        std::size_t packed_sequence_min_items = 0;
+
+        /// Threads used to index the input lines (0 = `std::thread::hardware_concurrency()`)
+        std::size_t index_threads = 0;
+
+        /// Inputs of at least this many bytes are indexed in parallel slices
+        std::size_t parallel_index_min_bytes = 100 * 1024 * 1024;
+
+        /// Stream input is read and indexed in chunks of this many bytes, so the raw text is never
+        /// held as a whole
+        std::size_t stream_chunk_bytes = 4 * 1024 * 1024;
+
+        /// Most nodes that aliases may copy into the document, counted over all aliases; exceeding
+        /// it is a parse error, which stops documents of nested aliases (`&b [*a, *a]`) from
+        /// growing exponentially. 0 allows 100 nodes per input byte, and at least a million
+        std::size_t max_alias_nodes = 0;
+
+        /// Records read, index, merge, parse and per-subtree spans when set
+        yaml_tracer* tracer = nullptr;
+
+        /// Records the call, its input bytes, latency and failure type under `metrics_label` when set
+        yaml_metrics* metrics = nullptr;
+
+        /// Call site label of the recorded metrics
+        std::string metrics_label;
+    };
+
+    /**
+     * Wraps JSON text into a raw JSON value: a `json::binary_t` with the `raw_json` subtype.
+     *
+     * @tparam BasicJsonType The JSON type of the value (`json` by default).
+     * @param text The JSON text, kept byte for byte.
+     * @return The raw JSON value.
+     */
+    template <typename BasicJsonType = json>
+    inline BasicJsonType make_raw_json(const std::string_view text) {
+        return BasicJsonType::binary(typename BasicJsonType::binary_t::container_type(text.begin(), text.end()),
+                                     static_cast<std::uint8_t>(yaml_binary_subtype::raw_json));
+    }
+
+    /**
+     * Determines whether a value is embedded JSON kept as raw text by the parser.
+     *
+     * @param value The value to check.
+     * @return True if the value is a binary with the `raw_json` subtype, otherwise false.
+     */
+    template <typename BasicJsonType, std::enable_if_t<detail::is_basic_json<BasicJsonType>::value, int> = 0>
+    inline bool is_raw_json(const BasicJsonType& value) {
+        if (!value.is_binary()) {
+            return false;
+        }
+        const auto& binary = value.get_binary();
+        return binary.has_subtype() && binary.subtype() == static_cast<std::uint8_t>(yaml_binary_subtype::raw_json);
+    }
+
+    /**
+     * Returns the original text of a raw JSON value. The view points into the value and is
+     * valid as long as the value is neither modified nor destroyed.
+     *
+     * @param value A raw JSON value.
+     * @return The JSON text exactly as it appeared in the YAML input.
+     * @throws std::runtime_error If the value is not raw JSON.
+     */
+    template <typename BasicJsonType, std::enable_if_t<detail::is_basic_json<BasicJsonType>::value, int> = 0>
+    inline std::string_view raw_json_view(const BasicJsonType& value) {
+        if (!is_raw_json(value)) {
+            NLOHMANN_YAML_THROW(std::runtime_error("Value is not raw JSON"));
+        }
+        const auto& binary = value.get_binary();
+        return {reinterpret_cast<const char*>(binary.data()), binary.size()};
+    }
+
+    /**
+     * Parses a raw JSON value into a regular JSON DOM, for callers that need to inspect it after all.
+     *
+     * @param value A raw JSON value.
+     * @return The parsed JSON.
+     * @throws std::runtime_error If the value is not raw JSON.
+     */
+    template <typename BasicJsonType, std::enable_if_t<detail::is_basic_json<BasicJsonType>::value, int> = 0>
+    inline BasicJsonType parse_raw_json(const BasicJsonType& value) {
+        const std::string_view text = raw_json_view(value);
+        return BasicJsonType::parse(text.begin(), text.end());
+    }
+
+    /**
+     * Reads 8 bytes as a little-endian 64-bit value, independently of the host byte order.
+     *
+     * @param bytes The first of the 8 bytes.
+     * @return The value.
+     */
+    inline std::uint64_t yaml_load_le64(const std::uint8_t* bytes) {
+        std::uint64_t value = 0;
+        for (std::size_t i = 8; i > 0; --i) {
+            value = (value << 8) | bytes[i - 1];
+        }
+        return value;
+    }
+
+    /**
+     * Contiguous read-only view of the values of a packed sequence.
+     *
+     * @tparam T `std::int64_t` or `double`.
+     */
+    template <typename T>
+    class yaml_packed_span {
+    public:
+        using value_type = T;
+        using const_iterator = const T*;
+
+        yaml_packed_span() = default;
+        yaml_packed_span(const T* data, const std::size_t size) : first(data), count(size) {}
+
+        [[nodiscard]] const T* data() const noexcept { return first; }
+        [[nodiscard]] std::size_t size() const noexcept { return count; }
+        [[nodiscard]] bool empty() const noexcept { return count == 0; }
+        [[nodiscard]] const T* begin() const noexcept { return first; }
+        [[nodiscard]] const T* end() const noexcept { return first + count; }
+        const T& operator[](const std::size_t index) const noexcept { return first[index]; }
+
+    private:
+        const T* first = nullptr;
+        std::size_t count = 0;
+    };
+
+    /**
+     * Determines whether a value is a numeric sequence stored packed by `pack_numeric_sequence`.
+     *
+     * @param value The value to check.
+     * @return True if the value is a binary with the `packed_int64` or `packed_double` subtype.
+     */
+    template <typename BasicJsonType, std::enable_if_t<detail::is_basic_json<BasicJsonType>::value, int> = 0>
+    inline bool is_packed_sequence(const BasicJsonType& value) {
+        if (!value.is_binary() || !value.get_binary().has_subtype()) {
+            return false;
+        }
+        const auto subtype = value.get_binary().subtype();
+        return subtype == static_cast<std::uint8_t>(yaml_binary_subtype::packed_int64)
+            || subtype == static_cast<std::uint8_t>(yaml_binary_subtype::packed_double);
+    }
+
+    /**
+     * Replaces an array whose elements are all integers, or all floating-point numbers, with a
+     * packed sequence: a `json::binary_t` holding 8 little-endian bytes per element, with the
+     * `packed_int64` or `packed_double` subtype. This takes 8 bytes per element instead of a
+     * 16-byte `json` node, and the values can be scanned as a contiguous span. Mixed, non-numeric
+     * and unsigned values beyond the `int64_t` range leave the array unchanged.
+     *
+     * @param value The array to pack in place.
+     * @param min_items Arrays with fewer elements are left unchanged.
+     * @return True if the array was packed.
+     */
+    template <typename BasicJsonType, std::enable_if_t<detail::is_basic_json<BasicJsonType>::value, int> = 0>
+    inline bool pack_numeric_sequence(BasicJsonType& value, const std::size_t min_items = 1) {
+        if (!value.is_array() || value.empty() || value.size() < min_items) {
+            return false;
+        }
+
+        const auto& array = value.template get_ref<const typename BasicJsonType::array_t&>();
+        const bool floats = array.front().is_number_float();
+        for (const auto& element : array) {
+            if (floats ? !element.is_number_float()
+                       : !element.is_number_integer() || (element.is_number_unsigned()
+                             && element.template get<std::uint64_t>() > static_cast<std::uint64_t>(
+                                    (std::numeric_limits<std::int64_t>::max)()))) {
+                return false;
+            }
+        }
+
+        typename BasicJsonType::binary_t::container_type bytes(array.size() * 8);
+        for (std::size_t i = 0; i < array.size(); ++i) {
+            std::uint64_t bits;
+            if (floats) {
+                const double number = array[i].template get<double>();
+                std::memcpy(&bits, &number, sizeof(bits));
+            } else {
+                bits = static_cast<std::uint64_t>(array[i].template get<std::int64_t>());
+            }
+            for (std::size_t b = 0; b < 8; ++b) {
+                bytes[i * 8 + b] = static_cast<std::uint8_t>(bits >> (8 * b));
+            }
+        }
+
+        value = BasicJsonType::binary(std::move(bytes), static_cast<std::uint8_t>(
+            floats ? yaml_binary_subtype::packed_double : yaml_binary_subtype::packed_int64));
+        return true;
+    }
+
+    /**
+     * Returns the values of a packed sequence as a span pointing into the value. The span is
+     * valid as long as the value is neither modified nor destroyed.
+     *
+     * @tparam T `std::int64_t` for `packed_int64` sequences, `double` for `packed_double` ones.
+     * @param value A packed sequence.
+     * @return The values, without copying.
+     * @throws std::runtime_error If the value is not a packed sequence of `T`, or on big-endian
+     *         hosts, where the little-endian bytes cannot be viewed in place (use
+     *         `unpack_sequence` there).
+     */
+    template <typename T, typename BasicJsonType,
+              std::enable_if_t<detail::is_basic_json<BasicJsonType>::value, int> = 0>
+    inline yaml_packed_span<T> packed_sequence_span(const BasicJsonType& value) {
+        static_assert(std::is_same<T, std::int64_t>::value || std::is_same<T, double>::value,
+                      "packed sequences hold std::int64_t or double values");
+        constexpr auto subtype = static_cast<std::uint8_t>(std::is_same<T, double>::value
+            ? yaml_binary_subtype::packed_double : yaml_binary_subtype::packed_int64);
+        if (!is_packed_sequence(value) || value.get_binary().subtype() != subtype) {
+            NLOHMANN_YAML_THROW(std::runtime_error(std::is_same<T, double>::value ? "Value is not a packed double sequence"
+                                                                                  : "Value is not a packed integer sequence"));
+        }
+#if defined(NLOHMANN_YAML_BIG_ENDIAN)
+        NLOHMANN_YAML_THROW(std::runtime_error("Packed sequences can only be viewed in place on little-endian hosts"));
+#else
+        const auto& binary = value.get_binary();
+        if (reinterpret_cast<std::uintptr_t>(binary.data()) % alignof(T) != 0) {
+            NLOHMANN_YAML_THROW(std::runtime_error("Packed sequence storage is not aligned"));
+        }
+        return {reinterpret_cast<const T*>(binary.data()), binary.size() / sizeof(T)};
+#endif
+    }
+
+    /**
+     * Converts a packed sequence back into a regular array.
+     *
+     * @param value A packed sequence.
+     * @return The array of numbers.
+     * @throws std::runtime_error If the value is not a packed sequence.
+     */
+    template <typename BasicJsonType, std::enable_if_t<detail::is_basic_json<BasicJsonType>::value, int> = 0>
+    inline BasicJsonType unpack_sequence(const BasicJsonType& value) {
+        if (!is_packed_sequence(value)) {
+            NLOHMANN_YAML_THROW(std::runtime_error("Value is not a packed sequence"));
+        }
+        const auto& binary = value.get_binary();
+        const bool floats = binary.subtype() == static_cast<std::uint8_t>(yaml_binary_subtype::packed_double);
+
+        typename BasicJsonType::array_t array;
+        array.reserve(binary.size() / 8);
+        for (std::size_t i = 0; i + 8 <= binary.size(); i += 8) {
+            const std::uint64_t bits = yaml_load_le64(binary.data() + i);
+            if (floats) {
+                double number;
+                std::memcpy(&number, &bits, sizeof(number));
+                array.emplace_back(number);
+            } else {
+                array.emplace_back(static_cast<std::int64_t>(bits));
+            }
+        }
+        return BasicJsonType(std::move(array));
+    }
+
+    /**
+     * Object container for `basic_json` that keeps its entries in a vector sorted by key: lookups
+     * are binary searches over contiguous memory and building needs no node allocations.
+     * Inserting a single key is O(n); the parser builds whole mappings with `assign_unsorted`,
+     * which sorts once. Like `boost::container::flat_map`, entries are stored as `std::pair<Key, T>`,
+     * so keys must not be modified through iterators.
+     */
+    template <class Key, class T, class Compare = std::less<Key>,
+              class Allocator = std::allocator<std::pair<const Key, T>>>
+    class yaml_flat_map {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<Key, T>;
+        using key_compare = Compare;
+        using container_type = std::vector<value_type,
+            typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>>;
+        using iterator = typename container_type::iterator;
+        using const_iterator = typename container_type::const_iterator;
+        using size_type = typename container_type::size_type;
+        using difference_type = typename container_type::difference_type;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+
+    private:
+        container_type entries;
+        key_compare compare;
+
+        template <typename KeyType>
+        const_iterator lower_bound(const KeyType& key) const {
+            return std::lower_bound(entries.begin(), entries.end(), key,
+                [this](const value_type& entry, const KeyType& k) { return compare(entry.first, k); });
+        }
+
+        template <typename KeyType>
+        iterator lower_bound(const KeyType& key) {
+            return entries.begin() + (static_cast<const yaml_flat_map&>(*this).lower_bound(key) - entries.cbegin());
+        }
+
+        template <typename KeyType>
+        bool matches(const const_iterator it, const KeyType& key) const {
+            return it != entries.end() && !compare(key, it->first);
+        }
+
+        template <typename KeyType>
+        using enable_if_key = std::enable_if_t<!std::is_convertible<KeyType, const_iterator>::value, int>;
+
+    public:
+        yaml_flat_map() = default;
+
+        explicit yaml_flat_map(const Allocator& alloc) : entries(alloc) {}
+
+        template <class It>
+        yaml_flat_map(It first, It last, const Allocator& alloc = Allocator()) : entries(alloc) {
+            insert(first, last);
+        }
+
+        yaml_flat_map(std::initializer_list<value_type> init, const Allocator& alloc = Allocator())
+            : yaml_flat_map(init.begin(), init.end(), alloc) {}
+
+        /**
+         * Replaces the contents with entries in any order, sorted once. For a key that occurs
+         * several times the last entry wins, as with repeated assignment.
+         *
+         * @param unsorted The new entries.
+         */
+        void assign_unsorted(container_type&& unsorted) {
+            entries = std::move(unsorted);
+            std::stable_sort(entries.begin(), entries.end(), [this](const value_type& lhs, const value_type& rhs) {
+                return compare(lhs.first, rhs.first);
+            });
+
+            size_type kept = 0;
+            for (size_type i = 0; i < entries.size(); ++i) {
+                if (i + 1 < entries.size() && !compare(entries[i].first, entries[i + 1].first)) {
+                    continue; // a later entry has the same key
+                }
+                if (kept != i) {
+                    entries[kept] = std::move(entries[i]);
+                }
+                ++kept;
+            }
+            entries.erase(entries.begin() + static_cast<difference_type>(kept), entries.end());
+        }
+
+        iterator begin() noexcept { return entries.begin(); }
+        const_iterator begin() const noexcept { return entries.begin(); }
+        const_iterator cbegin() const noexcept { return entries.cbegin(); }
+        iterator end() noexcept { return entries.end(); }
+        const_iterator end() const noexcept { return entries.end(); }
+        const_iterator cend() const noexcept { return entries.cend(); }
+
+        bool empty() const noexcept { return entries.empty(); }
+        size_type size() const noexcept { return entries.size(); }
+        size_type max_size() const noexcept { return entries.max_size(); }
+        void clear() noexcept { entries.clear(); }
+        void reserve(const size_type count) { entries.reserve(count); }
+
+        template <typename KeyType>
+        iterator find(const KeyType& key) {
+            const iterator it = lower_bound(key);
+            return matches(it, key) ? it : entries.end();
+        }
+
+        template <typename KeyType>
+        const_iterator find(const KeyType& key) const {
+            const const_iterator it = lower_bound(key);
+            return matches(it, key) ? it : entries.end();
+        }
+
+        template <typename KeyType>
+        size_type count(const KeyType& key) const {
+            return matches(lower_bound(key), key) ? 1 : 0;
+        }
+
+        template <typename KeyType>
+        T& at(const KeyType& key) {
+            const iterator it = find(key);
+            if (it == entries.end()) {
+                NLOHMANN_YAML_THROW(std::out_of_range("key not found"));
+            }
+            return it->second;
+        }
+
+        template <typename KeyType>
+        const T& at(const KeyType& key) const {
+            const const_iterator it = find(key);
+            if (it == entries.end()) {
+                NLOHMANN_YAML_THROW(std::out_of_range("key not found"));
+            }
+            return it->second;
+        }
+
+        template <typename KeyType, typename... Args>
+        std::pair<iterator, bool> emplace(KeyType&& key, Args&&... args) {
+            iterator it = lower_bound(key);
+            if (matches(it, key)) {
+                return {it, false};
+            }
+            it = entries.emplace(it, std::piecewise_construct, std::forward_as_tuple(key_type(std::forward<KeyType>(key))),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+            return {it, true};
+        }
+
+        template <typename KeyType>
+        T& operator[](KeyType&& key) {
+            return emplace(std::forward<KeyType>(key)).first->second;
+        }
+
+        template <typename KeyType>
+        const T& operator[](const KeyType& key) const {
+            return at(key);
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value) {
+            return emplace(value.first, value.second);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value) {
+            return emplace(std::move(value.first), std::move(value.second));
+        }
+
+        template <typename It>
+        void insert(It first, It last) {
+            for (; first != last; ++first) {
+                insert(*first);
+            }
+        }
+
+        template <typename KeyType, enable_if_key<KeyType> = 0>
+        size_type erase(const KeyType& key) {
+            const iterator it = find(key);
+            if (it == entries.end()) {
+                return 0;
+            }
+            entries.erase(it);
+            return 1;
+        }
+
+        iterator erase(const_iterator pos) {
+            return entries.erase(pos);
+        }
+
+        iterator erase(const_iterator first, const_iterator last) {
+            return entries.erase(first, last);
+        }
+
+        friend bool operator==(const yaml_flat_map& lhs, const yaml_flat_map& rhs) {
+            return lhs.entries == rhs.entries;
+        }
+
+        friend bool operator!=(const yaml_flat_map& lhs, const yaml_flat_map& rhs) {
+            return !(lhs == rhs);
+        }
+
+        friend bool operator<(const yaml_flat_map& lhs, const yaml_flat_map& rhs) {
+            return lhs.entries < rhs.entries;
+        }
+    };
+
+    /**
+     * Object container for `basic_json` that keeps insertion order like `ordered_map`, but finds
+     * keys through an open-addressing hash index instead of a linear scan. The index stores
+     * positions into the entry vector, so keys are not duplicated. Erasing is O(n) since the
+     * index is rebuilt. Entries are stored as `std::pair<Key, T>`; keys must not be modified
+     * through iterators.
+     */
+    template <class Key, class T, class IgnoredLess = std::less<Key>,
+              class Allocator = std::allocator<std::pair<const Key, T>>>
+    class yaml_ordered_hash_map {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<Key, T>;
+        using key_compare = std::equal_to<Key>;
+        using container_type = std::vector<value_type,
+            typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>>;
+        using iterator = typename container_type::iterator;
+        using const_iterator = typename container_type::const_iterator;
+        using size_type = typename container_type::size_type;
+        using difference_type = typename container_type::difference_type;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+
+    private:
+        static constexpr size_type empty_slot = static_cast<size_type>(-1);
+
+        container_type entries;
+        std::vector<size_type> slots; // entry positions; size is zero or a power of two
+
+        /**
+         * Finds the slot holding `key`, or the empty slot where it would be inserted.
+         */
+        size_type find_slot(const key_type& key) const {
+            const size_type mask = slots.size() - 1;
+            for (size_type slot = std::hash<key_type>{}(key) & mask;; slot = (slot + 1) & mask) {
+                if (slots[slot] == empty_slot || entries[slots[slot]].first == key) {
+                    return slot;
+                }
+            }
+        }
+
+        void rebuild_index(const size_type capacity) {
+            slots.assign(capacity, empty_slot);
+            for (size_type i = 0; i < entries.size(); ++i) {
+                slots[find_slot(entries[i].first)] = i;
+            }
+        }
+
+        size_type position_of(const key_type& key) const {
+            if (slots.empty()) {
+                return empty_slot;
+            }
+            return slots[find_slot(key)];
+        }
+
+    public:
+        yaml_ordered_hash_map() = default;
+
+        explicit yaml_ordered_hash_map(const Allocator& alloc) : entries(alloc) {}
+
+        template <class It>
+        yaml_ordered_hash_map(It first, It last, const Allocator& alloc = Allocator()) : entries(alloc) {
+            insert(first, last);
+        }
+
+        yaml_ordered_hash_map(std::initializer_list<value_type> init, const Allocator& alloc = Allocator())
+            : yaml_ordered_hash_map(init.begin(), init.end(), alloc) {}
+
+        iterator begin() noexcept { return entries.begin(); }
+        const_iterator begin() const noexcept { return entries.begin(); }
+        const_iterator cbegin() const noexcept { return entries.cbegin(); }
+        iterator end() noexcept { return entries.end(); }
+        const_iterator end() const noexcept { return entries.end(); }
+        const_iterator cend() const noexcept { return entries.cend(); }
+
+        bool empty() const noexcept { return entries.empty(); }
+        size_type size() const noexcept { return entries.size(); }
+        size_type max_size() const noexcept { return entries.max_size(); }
+
+        void clear() noexcept {
+            entries.clear();
+            slots.clear();
+        }
+
+        void reserve(const size_type count) {
+            entries.reserve(count);
+            size_type capacity = 16;
+            while (capacity < count * 2) {
+                capacity *= 2;
+            }
+            if (capacity > slots.size()) {
+                rebuild_index(capacity);
+            }
+        }
+
+        iterator find(const key_type& key) {
+            const size_type position = position_of(key);
+            return position == empty_slot ? entries.end() : entries.begin() + static_cast<difference_type>(position);
+        }
+
+        const_iterator find(const key_type& key) const {
+            const size_type position = position_of(key);
+            return position == empty_slot ? entries.end() : entries.begin() + static_cast<difference_type>(position);
+        }
+
+        size_type count(const key_type& key) const {
+            return position_of(key) == empty_slot ? 0 : 1;
+        }
+
+        T& at(const key_type& key) {
+            const iterator it = find(key);
+            if (it == entries.end()) {
+                NLOHMANN_YAML_THROW(std::out_of_range("key not found"));
+            }
+            return it->second;
+        }
+
+        const T& at(const key_type& key) const {
+            const const_iterator it = find(key);
+            if (it == entries.end()) {
+                NLOHMANN_YAML_THROW(std::out_of_range("key not found"));
+            }
+            return it->second;
+        }
+
+        template <typename... Args>
+        std::pair<iterator, bool> emplace(key_type key, Args&&... args) {
+            // Keep the load factor at or below one half
+            if ((entries.size() + 1) * 2 > slots.size()) {
+                rebuild_index(std::max<size_type>(16, slots.size() * 2));
+            }
+
+            const size_type slot = find_slot(key);
+            if (slots[slot] != empty_slot) {
+                return {entries.begin() + static_cast<difference_type>(slots[slot]), false};
+            }
+
+            slots[slot] = entries.size();
+            entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+            return {std::prev(entries.end()), true};
+        }
+
+        T& operator[](const key_type& key) {
+            if (const iterator it = find(key); it != entries.end()) {
+                return it->second;
+            }
+            return emplace(key).first->second;
+        }
+
+        const T& operator[](const key_type& key) const {
+            return at(key);
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value) {
+            return emplace(value.first, value.second);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value) {
+            return emplace(std::move(value.first), std::move(value.second));
+        }
+
+        template <typename It>
+        void insert(It first, It last) {
+            for (; first != last; ++first) {
+                insert(*first);
+            }
+        }
+
+        size_type erase(const key_type& key) {
+            const iterator it = find(key);
+            if (it == entries.end()) {
+                return 0;
+            }
+            erase(it);
+            return 1;
+        }
+
+        iterator erase(const_iterator pos) {
+            return erase(pos, std::next(pos));
+        }
+
+        iterator erase(const_iterator first, const_iterator last) {
+            const iterator next = entries.erase(first, last);
+            rebuild_index(slots.size());
+            return next;
+        }
+
+        friend bool operator==(const yaml_ordered_hash_map& lhs, const yaml_ordered_hash_map& rhs) {
+            return lhs.entries == rhs.entries;
+        }
+
+        friend bool operator!=(const yaml_ordered_hash_map& lhs, const yaml_ordered_hash_map& rhs) {
+            return !(lhs == rhs);
+        }
+
+        friend bool operator<(const yaml_ordered_hash_map& lhs, const yaml_ordered_hash_map& rhs) {
+            return lhs.entries < rhs.entries;
+        }
+    };
+
+    /**
+     * `std::unordered_map` adapted to the object container signature of `basic_json` (which
+     * passes a comparator, not a hash, as third argument).
+     */
+    template <class Key, class T, class IgnoredLess = std::less<Key>,
+              class Allocator = std::allocator<std::pair<const Key, T>>>
+    struct yaml_unordered_map : std::unordered_map<Key, T, std::hash<Key>, std::equal_to<Key>, Allocator> {
+        using container_type = std::unordered_map<Key, T, std::hash<Key>, std::equal_to<Key>, Allocator>;
+        using key_compare = std::equal_to<Key>; // lookups by key_type only
+        using container_type::container_type;
+    };
+
+    /// JSON type whose objects are sorted flat vectors
+    using yaml_flat_json = basic_json<yaml_flat_map>;
+
+    /// JSON type whose objects keep insertion order with hashed lookup
+    using yaml_ordered_hash_json = basic_json<yaml_ordered_hash_map>;
+
+    /// JSON type whose objects are hash maps without a defined order
+    using yaml_unordered_json = basic_json<yaml_unordered_map>;
+
+    /**
+     * Collects the entries of a mapping while it is parsed and produces the object once the
+     * mapping ends. By default every entry is inserted right away (a repeated key replaces the
+     * earlier value); specializations for an object container can build it in bulk instead.
+     *
+     * @tparam BasicJsonType The JSON type being built.
+     * @tparam ObjectType The object container of BasicJsonType.
+     */
+    template <typename BasicJsonType, typename ObjectType = typename BasicJsonType::object_t>
+    class yaml_object_builder {
+        BasicJsonType object = BasicJsonType::object();
+
+    public:
+        void insert(typename BasicJsonType::string_t key, BasicJsonType value) {
+            object[std::move(key)] = std::move(value);
+        }
+
+        bool empty() const {
+            return object.empty();
+        }
+
+        BasicJsonType finish() {
+            return std::move(object);
+        }
+    };
+
+    /**
+     * Builds flat-map objects with a single sort at the end of the mapping.
+     */
+    template <typename BasicJsonType, class Key, class T, class Compare, class Allocator>
+    class yaml_object_builder<BasicJsonType, yaml_flat_map<Key, T, Compare, Allocator>> {
+        using object_t = yaml_flat_map<Key, T, Compare, Allocator>;
+        typename object_t::container_type entries;
+
+    public:
+        void insert(typename BasicJsonType::string_t key, BasicJsonType value) {
+            entries.emplace_back(std::move(key), std::move(value));
+        }
+
+        bool empty() const {
+            return entries.empty();
+        }
+
+        BasicJsonType finish() {
+            BasicJsonType object = BasicJsonType::object();
+            object.template get_ref<object_t&>().assign_unsorted(std::move(entries));
+            return object;
+        }
+    };
+
+    class yaml_struct_reader;
+
+    /**
+     * YAML parsing class providing functionality for parsing YAML inputs, extracting
+     * structures, managing indentation, and handling embedded JSON blocks.
+     *
+     * @tparam ScalarResolver A `yaml_resolver_chain` of custom resolvers applied to plain scalars
+     *                        before the built-in typing (empty by default).
+     * @tparam BasicJsonType The JSON type to build, e.g. `yaml_flat_json` (`json` by default).
+     */
+    template <typename ScalarResolver = yaml_resolver_chain<>, typename BasicJsonType = json>
+    class basic_yaml_parser {
+        friend class yaml_struct_reader;
+
+    public:
+        /**
+         * Anchors of a document and what their aliases have cost so far; shared by the pieces of a
+         * document parsed one at a time (see `parse(anchor_table&)`).
+         */
+        struct anchor_table {
+            std::unordered_map<std::string, BasicJsonType> nodes; ///< Nodes defined with `&name`
+            std::size_t alias_nodes = 0;                           ///< Nodes copied by aliases
+            std::size_t input_bytes = 0;                           ///< Input bytes parsed so far
+        };
+
+        private:
+        std::vector<std::string> lines;
+        std::vector<size_t> line_bytes;
+        std::vector<int> indents;
+        std::vector<size_t> block_ends; ///< Built on first use by `block_end`
+        size_t current_line = 0;
+        yaml_parse_options options;
+
+        // JSON pointer of the value being parsed, only maintained when raw_json_paths is set
+        bool track_paths = false;
+        std::string path;
+
+        // Nodes defined with `&name` so far, copied wherever `*name` appears
+        anchor_table anchors;
+
+        // Whether a lone scalar may form the document; pieces of a root mapping skip it instead
+        bool scalar_root = true;
+
+        // First error of this parser, see `fail`
+        std::string failure;
+
+        // Scalar typing time and count, only measured when tracing
+        mutable std::uint64_t typing_ns = 0;
+        mutable std::uint64_t typed_scalars = 0;
+
+        // Start time and input size of this parser's call, for `options.metrics`
+        const std::chrono::steady_clock::time_point created = std::chrono::steady_clock::now();
+        size_t input_size = 0;
+
+        /**
+         * Records this parser's call in `options.metrics`, if set.
+         *
+         * @param error The exception the call failed with, or null if it succeeded or failed
+         *              with a recorded `failure`.
+         */
+        void record_metrics(const std::exception_ptr& error = nullptr) const {
+            if (options.metrics) {
+                const auto elapsed = std::chrono::steady_clock::now() - created;
+                const auto latency_ns = static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+                if (!error && !failure.empty()) {
+                    options.metrics->record_failure(options.metrics_label, input_size, latency_ns);
+                } else {
+                    options.metrics->record(options.metrics_label, input_size, latency_ns, error);
+                }
+            }
+        }
+
+        /**
+         * Reports a parse error. With exceptions it throws; without them it keeps the first error
+         * and moves past the last line, so every parsing loop ends and `parse()` returns the error
+         * as a status. Callers stop their own loop right after calling it.
+         *
+         * @param message The error message.
+         * @throws std::runtime_error With the message, unless exceptions are disabled.
+         */
+        void fail(const std::string& message) {
+            if (failure.empty()) {
+                failure = message;
+            }
+            current_line = lines.size();
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            NLOHMANN_YAML_THROW(std::runtime_error(message));
+#endif
+        }
+
+        /**
+         * Appends a reference token to the current path for the lifetime of the object.
+         */
+        class path_segment {
+            std::string& path;
+            const size_t saved_size;
+
+        public:
+            path_segment(basic_yaml_parser& parser, const std::string& key)
+                : path(parser.path), saved_size(parser.path.size()) {
+                if (parser.track_paths) {
+                    path += '/';
+                    for (const char c : key) {
+                        if (c == '~') {
+                            path += "~0";
+                        } else if (c == '/') {
+                            path += "~1";
+                        } else {
+                            path += c;
+                        }
+                    }
+                }
+            }
+
+            path_segment(basic_yaml_parser& parser, const size_t index)
+                : path(parser.path), saved_size(parser.path.size()) {
+                if (parser.track_paths) {
+                    path += '/';
+                    path += std::to_string(index);
+                }
+            }
+
+            path_segment(const path_segment&) = delete;
+            path_segment& operator=(const path_segment&) = delete;
+
+            ~path_segment() {
+                path.resize(saved_size);
+            }
+        };
+
+        /**
+         * Line range covered by a root-level key, recorded for parse-time memory reports.
+         */
+        struct root_span {
+            std::string key;
+            size_t first_line;
+            size_t end_line;
+        };
+
+        /**
+         * Finds the start of a comment in a line. A '#' only starts a comment at the beginning of
+         * the line or after whitespace, and never inside a quoted scalar.
+         *
+         * @param line The raw line to scan.
+         * @param quote The quote character open at the start of the line ('\0' for none); receives
+         *              the quote still open at the end of the line.
+         * @param opened_at Receives the position of the quote still open at the end of the line, or
+         *                  std::string::npos if it was already open at the start or none is open.
+         * @return The position of the comment's '#', or std::string::npos if the line has no comment.
+         */
+        static size_t find_comment(const std::string& line, char& quote, size_t& opened_at) {
+            opened_at = std::string::npos;
+            if (quote == '\0' && line.find_first_of("#\"'") == std::string::npos) {
+                return std::string::npos;
+            }
+
+            for (size_t i = 0; i < line.size(); ++i) {
+                const char c = line[i];
+                if (quote == '"') {
+                    if (c == '\\') {
+                        ++i; // skip the escaped character
+                    } else if (c == '"') {
+                        quote = '\0';
+                    }
+                } else if (quote == '\'') {
+                    if (c == '\'') {
+                        if (i + 1 < line.size() && line[i + 1] == '\'') {
+                            ++i; // '' is an escaped single quote
+                        } else {
+                            quote = '\0';
+                        }
+                    }
+                } else if (c == '#') {
+                    if (i == 0 || line[i - 1] == ' ' || line[i - 1] == '\t') {
+                        opened_at = std::string::npos;
+                        return i;
+                    }
+                } else if (c == '"' || c == '\'') {
+                    // Quotes only open a scalar at the start of a token, not inside a word like "don't"
+                    if (const char prev = i == 0 ? ' ' : line[i - 1];
+                        prev == ' ' || prev == '\t' || prev == ':' || prev == ',' || prev == '[' || prev == '{') {
+                        quote = c;
+                        opened_at = i;
+                    }
+                }
+            }
+            if (quote == '\0') {
+                opened_at = std::string::npos;
+            }
+            return std::string::npos;
+        }
+
+        /**
+         * Line tables built by the indexing pass: the cleaned line text, its raw size and its
+         * indentation, plus the quoted scalar still open at the end of the indexed text.
+         */
+        struct line_index {
+            std::vector<std::string> lines;
+            std::vector<size_t> line_bytes;
+            std::vector<int> indents;
+            char open_quote = '\0';
+            int quote_indent = 0;
+        };
+
+        /**
+         * Indexes a slice of the input that starts at the beginning of a line: every line is
+         * recorded with its comment and trailing whitespace removed, its raw size (including the
+         * newline) for input accounting, and its indentation.
+         *
+         * A quoted scalar that starts a value and is not closed on its line continues on the
+         * following blank or more indented lines, so no comment is stripped from those.
+         *
+         * @param text The slice to index.
+         * @param index Receives the lines of the slice, in order, and the quote state at its end.
+         * @param quote The quote open at the start of the slice ('\0' for none).
+         * @param quote_indent The indentation of the line that opened that quote.
+         */
+        static void index_lines(const std::string_view text, line_index& index, char quote = '\0',
+                                int quote_indent = 0) {
+            size_t begin = 0;
+            while (begin < text.size()) {
+                size_t end = text.find('\n', begin);
+                if (end == std::string_view::npos) {
+                    end = text.size();
+                }
+
+                std::string line(text.substr(begin, end - begin));
+                index.line_bytes.push_back(line.size() + 1);
+
+                // A quoted scalar only continues on lines indented deeper than the one opening it
+                const int raw_indent = get_indent(line);
+                if (quote != '\0' && line.find_first_not_of(" \t\r") != std::string::npos
+                    && raw_indent <= quote_indent) {
+                    quote = '\0';
+                }
+
+                // Remove comments
+                size_t opened_at;
+                if (const size_t comment_pos = find_comment(line, quote, opened_at);
+                    comment_pos != std::string::npos) {
+                    line.erase(comment_pos);
+                }
+                if (opened_at != std::string::npos) {
+                    // Only a quote opening a value (after "key:", "-" or at the line start) spans lines
+                    const size_t prev = opened_at == 0 ? std::string::npos : line.find_last_not_of(" \t", opened_at - 1);
+                    if (prev == std::string::npos || line[prev] == ':' || line[prev] == '-') {
+                        quote_indent = raw_indent;
+                    } else {
+                        quote = '\0';
+                    }
+                }
+                // Remove trailing whitespace (handle whitespace-only lines safely)
+                if (!line.empty()) {
+                    if (const auto last = line.find_last_not_of(" \t\r\n"); last != std::string::npos) {
+                        line.erase(last + 1);
+                    } else {
+                        line.clear();
+                    }
+                }
+
+                // Keep all lines, including empty ones, to maintain the line structure
+                index.indents.push_back(get_indent(line));
+                index.lines.push_back(std::move(line));
+                begin = end + 1;
+            }
+            index.open_quote = quote;
+            index.quote_indent = quote_indent;
+        }
+
+        /**
+         * Builds the line tables for the whole input. UTF-8 input (with or without a byte order
+         * mark) is indexed in place; UTF-16 and UTF-32 input is transcoded to UTF-8 first.
+         *
+         * @param text The complete input.
+         * @throws std::runtime_error If UTF-16/UTF-32 input is malformed.
+         */
+        void preprocess_input(std::string_view text) {
+            input_size = text.size();
+            const yaml_encoding_info detected = detect_yaml_encoding(text);
+            text.remove_prefix(detected.bom_size);
+            if (detected.encoding == yaml_encoding::utf8) {
+                index_input(text);
+                return;
+            }
+
+            std::string utf8;
+            {
+                yaml_trace_scope span(options.tracer, "transcode");
+                if (std::string error; !try_transcode_to_utf8(text, detected.encoding, utf8, error)) {
+                    fail(error);
+                    return;
+                }
+                span.set_items(utf8.size());
+            }
+            index_input(utf8);
+        }
+
+        /**
+         * Builds the line tables for UTF-8 input held in memory, see `append_lines`.
+         *
+         * @param text The complete input.
+         */
+        void index_input(const std::string_view text) {
+            yaml_trace_scope span(options.tracer, "index");
+            line_index state;
+            append_lines(text, index_threads_for(text.size(), text.size()), state);
+            span.set_items(lines.size());
+        }
+
+        /**
+         * @param input_bytes The input bytes seen so far.
+         * @param text_bytes The bytes about to be indexed.
+         * @return The threads to index `text_bytes` with: several once the input has reached
+         *         `parallel_index_min_bytes`, one otherwise.
+         */
+        [[nodiscard]] size_t index_threads_for(const size_t input_bytes, const size_t text_bytes) const {
+            const size_t threads = options.index_threads != 0 ? options.index_threads
+                                                              : std::max(1u, std::thread::hardware_concurrency());
+            return input_bytes < options.parallel_index_min_bytes || text_bytes < threads ? 1 : threads;
+        }
+
+        /**
+         * Indexes UTF-8 text that starts at the beginning of a line and appends its lines to the
+         * line tables. With several threads the text is cut into slices at line breaks, indexed in
+         * parallel, then concatenated. Only a quoted scalar spanning a slice boundary carries state
+         * across lines; the (rare) slice that starts inside one is indexed again with the quote
+         * state its predecessor ended in.
+         *
+         * @param text The text to index.
+         * @param threads The threads to index it with.
+         * @param state The quote open at the start of the text; receives the one open at its end.
+         */
+        void append_lines(const std::string_view text, const size_t threads, line_index& state) {
+            if (threads == 1) {
+                line_index index;
+                index_lines(text, index, state.open_quote, state.quote_indent);
+                state.open_quote = index.open_quote;
+                state.quote_indent = index.quote_indent;
+                if (lines.empty()) {
+                    lines = std::move(index.lines);
+                    line_bytes = std::move(index.line_bytes);
+                    indents = std::move(index.indents);
+                } else {
+                    std::move(index.lines.begin(), index.lines.end(), std::back_inserter(lines));
+                    line_bytes.insert(line_bytes.end(), index.line_bytes.begin(), index.line_bytes.end());
+                    indents.insert(indents.end(), index.indents.begin(), index.indents.end());
+                }
+                return;
+            }
+
+            // Slice boundaries, moved forward to the start of the next line
+            std::vector<size_t> bounds{0};
+            for (size_t i = 1; i < threads; ++i) {
+                const size_t newline = text.find('\n', std::max(bounds.back(), i * text.size() / threads));
+                if (newline == std::string_view::npos) {
+                    break;
+                }
+                if (newline + 1 < text.size()) {
+                    bounds.push_back(newline + 1);
+                }
+            }
+            bounds.push_back(text.size());
+
+            std::vector<line_index> slices(bounds.size() - 1);
+            yaml_run_tasks(threads, slices.size(), [&](const size_t slice) {
+                yaml_trace_scope slice_span(options.tracer, "index slice");
+                if (slice == 0) {
+                    index_lines(text.substr(0, bounds[1]), slices[0], state.open_quote, state.quote_indent);
+                } else {
+                    index_lines(text.substr(bounds[slice], bounds[slice + 1] - bounds[slice]), slices[slice]);
+                }
+                slice_span.set_items(slices[slice].lines.size());
+            });
+
+            yaml_trace_scope merge_span(options.tracer, "merge");
+
+            for (size_t slice = 1; slice < slices.size(); ++slice) {
+                if (const line_index& previous = slices[slice - 1]; previous.open_quote != '\0') {
+                    line_index reindexed;
+                    index_lines(text.substr(bounds[slice], bounds[slice + 1] - bounds[slice]), reindexed,
+                                previous.open_quote, previous.quote_indent);
+                    slices[slice] = std::move(reindexed);
+                }
+            }
+            state.open_quote = slices.back().open_quote;
+            state.quote_indent = slices.back().quote_indent;
+
+            size_t total = lines.size();
+            for (const auto& slice : slices) {
+                total += slice.lines.size();
+            }
+            lines.reserve(total);
+            line_bytes.reserve(total);
+            indents.reserve(total);
+            for (auto& slice : slices) {
+                std::move(slice.lines.begin(), slice.lines.end(), std::back_inserter(lines));
+                line_bytes.insert(line_bytes.end(), slice.line_bytes.begin(), slice.line_bytes.end());
+                indents.insert(indents.end(), slice.indents.begin(), slice.indents.end());
+            }
+        }
+
+        /**
+         * Reads the input stream in chunks of `stream_chunk_bytes` and indexes each chunk as it
+         * arrives, so only one chunk of raw text (plus the partial line at its end) is held at a
+         * time. UTF-16 and UTF-32 input is transcoded chunk by chunk; a code unit sequence cut by
+         * a chunk boundary waits for the next chunk. Once the input read so far reaches
+         * `parallel_index_min_bytes`, chunks are indexed in parallel slices.
+         *
+         * @param input The stream containing the YAML document.
+         * @throws std::runtime_error If UTF-16/UTF-32 input is malformed.
+         */
+        void preprocess_input(std::istream& input) {
+            yaml_trace_scope read_span(options.tracer, "read");
+            std::string chunk(std::max<size_t>(options.stream_chunk_bytes, 4), '\0');
+            std::string text;    // UTF-8 text not indexed yet: the partial last line, then the new chunk
+            std::string encoded; // UTF-16/UTF-32 bytes not transcoded yet
+            size_t transcoded = 0;
+            yaml_encoding_info detected;
+            line_index state;
+
+            for (bool first = true;; first = false) {
+                input.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                std::string_view bytes(chunk.data(), static_cast<size_t>(input.gcount()));
+                const bool last = !input;
+                input_size += bytes.size();
+                if (first) {
+                    detected = detect_yaml_encoding(bytes);
+                    bytes.remove_prefix(detected.bom_size);
+                }
+
+                if (detected.encoding == yaml_encoding::utf8) {
+                    text.append(bytes);
+                } else {
+                    yaml_trace_scope span(options.tracer, "transcode");
+                    encoded.append(bytes);
+                    const size_t ready = last ? encoded.size() : transcodable_bytes(encoded, detected.encoding);
+                    std::string utf8;
+                    if (std::string error; !try_transcode_to_utf8(std::string_view(encoded).substr(0, ready),
+                                                                  detected.encoding, utf8, error, transcoded)) {
+                        fail(error);
+                        return;
+                    }
+                    transcoded += ready;
+                    encoded.erase(0, ready);
+                    text.append(utf8);
+                    span.set_items(utf8.size());
+                }
+
+                // Index up to the last complete line; the rest waits for the next chunk
+                const size_t newline = text.rfind('\n');
+                const size_t complete = last ? text.size() : newline == std::string::npos ? 0 : newline + 1;
+                if (complete != 0) {
+                    yaml_trace_scope span(options.tracer, "index");
+                    append_lines(std::string_view(text).substr(0, complete), index_threads_for(input_size, complete),
+                                 state);
+                    text.erase(0, complete);
+                    span.set_items(lines.size());
+                }
+                if (last) {
+                    break;
+                }
+            }
+            read_span.set_items(input_size);
+        }
+
+        /**
+         * @param encoded UTF-16 or UTF-32 bytes read so far.
+         * @param encoding Their encoding.
+         * @return How many leading bytes hold complete characters, leaving out a trailing partial
+         *         code unit and a trailing UTF-16 high surrogate whose pair has not been read yet.
+         */
+        static size_t transcodable_bytes(const std::string& encoded, const yaml_encoding encoding) {
+            if (encoding == yaml_encoding::utf32le || encoding == yaml_encoding::utf32be) {
+                return encoded.size() - encoded.size() % 4;
+            }
+            size_t ready = encoded.size() - encoded.size() % 2;
+            if (ready != 0) {
+                const size_t high_byte = encoding == yaml_encoding::utf16be ? ready - 2 : ready - 1;
+                if (const auto high = static_cast<unsigned char>(encoded[high_byte]); high >= 0xd8 && high <= 0xdb) {
+                    ready -= 2;
+                }
+            }
+            return ready;
+        }
+
+        /**
+         * Calculates the indentation level of a given line based on spaces and tabs.
+         *
+         * @param line The string for which the indentation level needs to be calculated.
+         * @return The total indentation count, treating spaces as 1 unit and tabs as 2 units by default.
+         */
+        static int get_indent(const std::string& line) {
+            int indent = 0;
+            for (const char i : line) {
+                if (i == ' ') {
+                    indent++;
+                } else if (i == '\t') {
+                    indent += 2;  // Treat tab as 2 spaces (adjust to 4 or 8 if preferred based on convention)
+                } else {
+                    break;
+                }
+            }
+            return indent;
+        }
+
+        /**
+         * Determines the next line's indentation level that is greater than the parent indentation,
+         * starting from a specified line index. Skips empty lines and stops search at the first
+         * line with an indentation level that does not match the condition.
+         *
+         * @param start_line The index of the line to start checking from.
+         * @param parent_indent The indentation level of the parent line used as a reference.
+         * @return The indentation level of the next suitable line if it exists; otherwise, returns -1.
+         */
+        [[nodiscard]] int get_next_sub_indent(const size_t start_line, const int parent_indent) const {
+            size_t peek = start_line;
+            while (peek < lines.size()) {
+                const std::string& p_line = lines[peek];
+
+                if (p_line.empty()) {
+                    ++peek;
+                    continue;
+                }
+
+                if (const int p_indent = indents[peek]; p_indent > parent_indent) {
+                    return p_indent;
+                }
+
+                return -1;
+            }
+            return -1;
+        }
+
+        /**
+         * Parses a JSON array from a given string and returns the corresponding JSON object.
+         * The input string must represent a valid JSON array syntax.
+         *
+         * @param str The string containing the JSON array to parse.
+         * @return A JSON object representing the parsed array.
+         * @throws std::runtime_error If the input string is not a valid JSON array.
+         */
+        BasicJsonType parse_json_array(const std::string& str) {
+            BasicJsonType array = BasicJsonType::parse(str, nullptr, false);
+            if (array.is_discarded()) {
+                fail("Invalid JSON array syntax: " + str);
+                return nullptr;
+            }
+            return array;
+        }
+
+        /**
+         * Parses a JSON object from a given string and returns the corresponding JSON representation.
+         * The input string must represent a valid JSON object syntax.
+         *
+         * @param str The string containing the JSON object to parse.
+         * @return A JSON object representing the parsed input string.
+         * @throws std::runtime_error If the input string is not a valid JSON object.
+         */
+        BasicJsonType parse_json_object(const std::string& str) {
+            BasicJsonType object = BasicJsonType::parse(str, nullptr, false);
+            if (object.is_discarded()) {
+                fail("Invalid JSON object syntax: " + str);
+                return nullptr;
+            }
+            return object;
+        }
+
+        /**
+         * Determines whether the provided string represents a valid JSON array.
+         * A valid JSON array is identified by being non-empty, trimmed of leading
+         * and trailing whitespace, and starting with '[' and ending with ']'.
+         *
+         * @param str The string to check for JSON array syntax.
+         * @return True if the string represents a JSON array, otherwise false.
+         */
+        static bool is_json_array(const std::string& str) {
+            std::string trimmed = str;
+            trimmed.erase(0, trimmed.find_first_not_of(" \t"));
+            trimmed.erase(trimmed.find_last_not_of(" \t") + 1);
+            return !trimmed.empty() && trimmed.front() == '[' && trimmed.back() == ']';
+        }
+
+        /**
+         * Determines whether the provided string represents a valid JSON object.
+         * A valid JSON object is identified by being non-empty, trimmed of leading
+         * and trailing whitespace, and starting with '{' and ending with '}'.
+         *
+         * @param str The string to check for JSON object syntax.
+         * @return True if the string represents a JSON object, otherwise false.
+         */
+        static bool is_json_object(const std::string& str) {
+            std::string trimmed = str;
+            trimmed.erase(0, trimmed.find_first_not_of(" \t"));
+            trimmed.erase(trimmed.find_last_not_of(" \t") + 1);
+            return !trimmed.empty() && trimmed.front() == '{' && trimmed.back() == '}';
+        }
+
+        /**
+         * Determines whether the given string starts with a JSON token
+         * after ignoring leading whitespace.
+         *
+         * @param str The input string to analyze.
+         * @return True if the string starts with a '[' or '{' character after
+         *         whitespace is trimmed; otherwise, false.
+         */
+        static bool starts_with_json_token(const std::string& str) {
+            const size_t i = str.find_first_not_of(" \t");
+            if (i == std::string::npos) return false;
+            const char c = str[i];
+            return c == '[' || c == '{';
+        }
+
+        /**
+         * Determines whether a value starts with a quote or a JSON token, in which case it is a
+         * single scalar even if it contains a ':' (e.g. `- "a: b"` or `- {"a": 1}`).
+         *
+         * @param str The value to analyze, without leading whitespace.
+         * @return True if the value starts with '"', '\'', '[' or '{'; otherwise, false.
+         */
+        static bool starts_with_quote_or_json_token(const std::string& str) {
+            return !str.empty() && (str[0] == '"' || str[0] == '\'' || str[0] == '[' || str[0] == '{');
+        }
+
+        /**
+         * Finds the quote closing a quoted scalar, skipping `\"` escapes in double-quoted and `''`
+         * in single-quoted scalars.
+         *
+         * @param text The text holding the scalar.
+         * @param open The position of the opening quote.
+         * @return The position of the closing quote, or std::string::npos if it is not on this line.
+         */
+        static size_t find_closing_quote(const std::string& text, const size_t open) {
+            const char quote = text[open];
+            for (size_t i = open + 1; i < text.size(); ++i) {
+                if (quote == '"' && text[i] == '\\') {
+                    ++i;
+                } else if (text[i] == quote) {
+                    if (quote == '\'' && i + 1 < text.size() && text[i + 1] == '\'') {
+                        ++i;
+                    } else {
+                        return i;
+                    }
+                }
+            }
+            return std::string::npos;
+        }
+
+        /**
+         * Finds the colon ending the key of a mapping entry. A quoted key (as written by `to_yaml`
+         * for keys holding ':' or '#', or starting with an indicator) ends at its closing quote; a
+         * plain key ends at the first ':'.
+         *
+         * @param line The line holding the entry.
+         * @param from The position of the key.
+         * @return The position of the colon, or std::string::npos if the line holds none.
+         */
+        static size_t find_key_colon(const std::string& line, const size_t from) {
+            if (from < line.size() && (line[from] == '"' || line[from] == '\'')) {
+                if (const size_t close = find_closing_quote(line, from); close != std::string::npos) {
+                    const size_t colon = line.find_first_not_of(" \t", close + 1);
+                    if (colon != std::string::npos && line[colon] == ':'
+                        && (colon + 1 == line.size() || line[colon + 1] == ' ' || line[colon + 1] == '\t')) {
+                        return colon;
+                    }
+                }
+            }
+            return line.find(':', from);
+        }
+
+        /**
+         * Determines whether a sequence item starts with a quoted mapping key, e.g. `- "a:b": 1`.
+         *
+         * @param value The item text after the dash, without leading whitespace.
+         * @return True if a quoted key and its colon start the item.
+         */
+        static bool starts_with_quoted_key(const std::string& value) {
+            if (value.empty() || (value[0] != '"' && value[0] != '\'')) {
+                return false;
+            }
+            const size_t close = find_closing_quote(value, 0);
+            const size_t colon = find_key_colon(value, 0);
+            return close != std::string::npos && colon != std::string::npos && colon > close;
+        }
+
+        /**
+         * Removes the quotes of a quoted key and resolves its escapes; plain keys are unchanged.
+         *
+         * @param key The key, without surrounding whitespace.
+         */
+        static void unquote_key(std::string& key) {
+            if (!key.empty() && (key[0] == '"' || key[0] == '\'') && find_closing_quote(key, 0) == key.size() - 1) {
+                key = unquote(key);
+            }
+        }
+
+        /**
+         * Removes the quotes of a quoted scalar and resolves its escapes.
+         *
+         * @param quoted The scalar, starting and ending with the same quote character.
+         * @return The scalar's text.
+         */
+        static std::string unquote(const std::string& quoted) {
+            const bool single_quoted = quoted.front() == '\'';
+            const std::string_view val = std::string_view(quoted).substr(1, quoted.size() - 2);
+            // Handle escaped characters in quoted strings
+            std::string result;
+            for (size_t i = 0; i < val.size(); ++i) {
+                if (single_quoted && val[i] == '\'' && i + 1 < val.size() && val[i + 1] == '\'') {
+                    result += '\''; // '' is an escaped single quote
+                    ++i;
+                } else if (val[i] == '\\' && i + 1 < val.size()) {
+                    switch (val[i + 1]) {
+                        case 'n': result += '\n'; break;
+                        case 't': result += '\t'; break;
+                        case 'r': result += '\r'; break;
+                        case '\\': result += '\\'; break;
+                        case '"': result += '"'; break;
+                        case '\'': result += '\''; break;
+                        default: result += val[i + 1]; break;
+                    }
+                    ++i; // skip the escaped character
+                } else {
+                    result += val[i];
+                }
+            }
+            return result;
+        }
+
+        /**
+         * Keeps embedded JSON text as a raw JSON value when the options select it, by size or by
+         * the path of the value being parsed. The text is already known to be bracket-balanced.
+         *
+         * @param text The JSON array or object text.
+         * @param out Receives the raw JSON value.
+         * @return True if the text was kept raw; false if it should be parsed normally, which
+         *         includes text that fails validation so the regular error handling applies.
+         */
+        bool try_keep_raw_json(const std::string& text, BasicJsonType& out) const {
+            const bool by_size = options.raw_json_min_bytes != 0 && text.size() >= options.raw_json_min_bytes;
+            if (!by_size && !(track_paths && std::find(options.raw_json_paths.begin(),
+                                                       options.raw_json_paths.end(), path)
+                                             != options.raw_json_paths.end())) {
+                return false;
+            }
+
+            if (options.validate_raw_json && !BasicJsonType::accept(text)) {
+                return false;
+            }
+
+            out = make_raw_json<BasicJsonType>(text);
+            return true;
+        }
+
+        /**
+         * Stores a nested sequence packed when `packed_sequence_min_items` selects it.
+         *
+         * @param sequence The parsed sequence, replaced in place if it is packed.
+         */
+        void pack_if_selected(BasicJsonType& sequence) const {
+            if (options.packed_sequence_min_items != 0) {
+                pack_numeric_sequence(sequence, options.packed_sequence_min_items);
+            }
+        }
+
+        /**
+         * Attempts to collect a contiguous JSON block from the current position in the input lines,
+         * starting at a specified indentation level.
+         *
+         * A valid JSON block must begin with either '{' or '[' and adhere to a proper JSON structure,
+         * including balanced brackets and braces. The process respects string literals and escape
+         * characters to avoid misinterpreting JSON content.
+         *
+         * @param current_indent The expected indentation level for the JSON block to start.
+         * @param out_json A reference to a string where the collected JSON block will be stored if successfully found.
+         * @return A boolean indicating whether a valid JSON block was successfully collected.
+         *         Returns true if a valid JSON block is found, false otherwise.
+         */
+        bool try_collect_json_block(const int current_indent, std::string& out_json) {
+            const size_t saved_line = current_line;
+
+            size_t i = current_line;
+            bool started = false;
+
+            int curly = 0;
+            int square = 0;
+            bool in_string = false;
+            char quote_char = '\0';
+            bool escape = false;
+
+            std::string buffer;
+
+            while (i < lines.size()) {
+                const std::string& raw = lines[i];
+
+                // Skip empty lines before we start
+                if (!started && raw.empty()) {
+                    i++;
+                    continue;
+                }
+
+                const int indent = indents[i];
+
+                // If we haven't started yet, ensure this line is at the expected indent and starts with { or [
+                if (!started) {
+                    if (indent != current_indent) {
+                        break;
+                    }
+                    std::string content = raw.substr(indent);
+                    // Trim leading spaces for start check
+                    const size_t s = content.find_first_not_of(" \t");
+                    if (s == std::string::npos) {
+                        // nothing meaningful on this line
+                        i++;
+                        continue;
+                    }
+                    if (const char first = content[s]; first != '{' && first != '[') {
+                        // Not a JSON block start
+                        break;
+                    }
+                    started = true;
+                }
+
+                // Once started, lines with indent less than current_indent terminate unless we already balanced
+                if (started && indent < current_indent) {
+                    break;
+                }
+
+                // Only the block's own indentation is removed, so nested lines keep their layout
+                const std::string content = raw.substr(current_indent);
+
+                // Append content to buffer (newline separates lines; JSON allows whitespace)
+                if (!buffer.empty()) {
+                    buffer.push_back('\n');
+                }
+                buffer.append(content);
+
+                // Scan content to update bracket/brace counters while respecting strings
+                for (const char c : content) {
+                    if (in_string) {
+                        if (escape) {
+                            escape = false;
+                        } else if (c == '\\') {
+                            escape = true;
+                        } else if (c == quote_char) {
+                            in_string = false;
+                        }
+                    } else {
+                        if (c == '"' || c == '\'') {
+                            in_string = true;
+                            quote_char = c;
+                        } else if (c == '{') {
+                            ++curly;
+                        } else if (c == '}') {
+                            --curly;
+                        } else if (c == '[') {
+                            ++square;
+                        } else if (c == ']') {
+                            --square;
+                        }
+                    }
+                }
+
+                ++i;
+
+                if (started && curly <= 0 && square <= 0) {
+                    // Completed a JSON value
+                    current_line = i;
+                    out_json = buffer;
+                    return true;
+                }
+            }
+
+            // Not a valid/complete JSON block – restore and signal failure
+            current_line = saved_line;
+            return false;
+        }
+
+        /**
+         * Parses a number in decimal, hexadecimal (0x), octal (0o) or binary (0b) notation, or in
+         * floating-point/scientific notation. The whole value must be consumed, so values such as
+         * "30s" or "1.2.3" are not numbers. Integers beyond the signed 64-bit range are returned
+         * as unsigned when they fit.
+         *
+         * @param val The trimmed scalar text.
+         * @param out Receives the parsed number.
+         * @return True if the value is a number, otherwise false.
+         */
+        static bool parse_number(const std::string& val, BasicJsonType& out) {
+            if (val.empty()) {
+                return false;
+            }
+
+            const char* const first = val.data();
+            const char* const last = first + val.size();
+
+            // Handle different number bases
+            if (val.size() > 2 && val[0] == '0') {
+                int base = 0;
+                if (val[1] == 'x' || val[1] == 'X') {
+                    base = 16;
+                } else if (val[1] == 'o' || val[1] == 'O') {
+                    base = 8;
+                } else if (val[1] == 'b' || val[1] == 'B') {
+                    base = 2;
+                }
+
+                if (base != 0) {
+                    // from_chars takes a sign, which the digits after a base prefix must not have
+                    if (val[2] == '-') {
+                        return false;
+                    }
+                    std::int64_t value = 0;
+                    const auto [ptr, ec] = std::from_chars(first + 2, last, value, base);
+                    if (ec != std::errc() || ptr != last) {
+                        return false;
+                    }
+                    out = value;
+                    return true;
+                }
+            }
+
+            // Numbers start with a digit, a sign or a decimal point
+            if (const char c = val[0]; (c < '0' || c > '9') && c != '-' && c != '+' && c != '.') {
+                return false;
+            }
+
+            // Handle scientific notation and regular numbers
+            if (val.find_first_of(".eE") != std::string::npos) {
+                char* end = nullptr;
+                const double value = std::strtod(first, &end);
+                if (end != last || std::isinf(value)) {
+                    return false;
+                }
+                out = value;
+                return true;
+            }
+
+            // Handle integers, with an optional sign
+            const char* const digits = val[0] == '+' ? first + 1 : first;
+            std::int64_t value = 0;
+            const auto [ptr, ec] = std::from_chars(digits, last, value);
+            if (ec == std::errc() && ptr == last) {
+                out = value;
+                return true;
+            }
+
+            if (ec == std::errc::result_out_of_range && *digits != '-') {
+                std::uint64_t unsigned_value = 0;
+                if (const auto [uptr, uec] = std::from_chars(digits, last, unsigned_value);
+                    uec == std::errc() && uptr == last) {
+                    out = unsigned_value;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /**
+         * Checks whether a quoted scalar is closed in a piece of text, honouring the escapes of its
+         * quote style (backslash escapes in double quotes, '' in single quotes).
+         *
+         * @param text The text to scan.
+         * @param from The position to start scanning at, which lies inside the quoted scalar.
+         * @param quote The quote character ('"' or '\'').
+         * @return True if the closing quote is found.
+         */
+        static bool closes_quote(const std::string_view text, size_t from, const char quote) {
+            for (size_t i = from; i < text.size(); ++i) {
+                if (quote == '"' && text[i] == '\\') {
+                    ++i; // skip the escaped character
+                } else if (text[i] == quote) {
+                    if (quote == '\'' && i + 1 < text.size() && text[i + 1] == '\'') {
+                        ++i; // '' is an escaped single quote
+                    } else {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Checks whether a line of a double-quoted scalar ends with an escaped line break, i.e. an
+         * odd number of trailing backslashes.
+         */
+        static bool ends_with_escaped_break(const std::string_view text) {
+            const size_t last = text.find_last_not_of('\\');
+            const size_t backslashes = text.size() - (last == std::string_view::npos ? 0 : last + 1);
+            return backslashes % 2 == 1;
+        }
+
+        /**
+         * Checks whether a line cannot continue a plain scalar because it starts a sequence entry or
+         * a mapping entry of its own.
+         */
+        static bool starts_structure(const std::string_view content) {
+            if (content[0] == '-' && (content.size() == 1 || content[1] == ' ' || content[1] == '\t')) {
+                return true;
+            }
+            for (size_t colon = content.find(':'); colon != std::string_view::npos; colon = content.find(':', colon + 1)) {
+                if (colon + 1 == content.size() || content[colon + 1] == ' ' || content[colon + 1] == '\t') {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Folds a flow scalar that continues on the lines following the current one. A plain scalar
+         * continues on every non-empty line indented at least `min_indent` that does not start an
+         * entry of its own; a quoted scalar left open on its first line continues up to the line
+         * closing it. Following YAML line folding, each line break between two non-empty lines
+         * becomes a space, n empty lines become n newlines, and an escaped line break in a
+         * double-quoted scalar joins the lines directly.
+         *
+         * The folded length is computed from the line table first, so the result is built with a
+         * single allocation. The continuation lines are consumed.
+         *
+         * @param first The scalar text on its first line, without leading whitespace.
+         * @param min_indent The minimum indentation of a continuation line.
+         * @return The folded scalar text, or `first` if the scalar does not continue.
+         */
+        std::string fold_continuation(const std::string& first, const int min_indent) {
+            const char quote = !first.empty() && (first[0] == '"' || first[0] == '\'') ? first[0] : '\0';
+            if (quote != '\0' && closes_quote(first, 1, quote)) {
+                return first;
+            }
+
+            // One past the last continuation line
+            size_t end = current_line;
+            for (size_t i = current_line; i < lines.size(); ++i) {
+                if (lines[i].empty()) {
+                    continue;
+                }
+                if (indents[i] < min_indent) {
+                    break;
+                }
+                if (quote != '\0') {
+                    if (closes_quote(lines[i], static_cast<size_t>(indents[i]), quote)) {
+                        end = i + 1;
+                        break;
+                    }
+                } else if (starts_structure(std::string_view(lines[i]).substr(static_cast<size_t>(indents[i])))) {
+                    break;
+                } else {
+                    end = i + 1;
+                }
+            }
+            if (end == current_line) {
+                return first; // single line, or an unterminated quoted scalar left to the scalar rules
+            }
+
+            // Emits the folded scalar piece by piece, for sizing and then for building
+            const auto fold = [&](auto&& append) {
+                std::string_view previous = first;
+                size_t empty_lines = 0;
+                for (size_t i = current_line; i < end; ++i) {
+                    if (lines[i].empty()) {
+                        ++empty_lines;
+                        continue;
+                    }
+                    if (quote == '"' && ends_with_escaped_break(previous)) {
+                        previous.remove_suffix(1);
+                        append(previous);
+                    } else {
+                        append(previous);
+                        if (empty_lines == 0) {
+                            append(std::string_view(" "));
+                        }
+                    }
+                    for (; empty_lines > 0; --empty_lines) {
+                        append(std::string_view("\n"));
+                    }
+                    previous = std::string_view(lines[i]).substr(static_cast<size_t>(indents[i]));
+                }
+                append(previous);
+            };
+
+            size_t length = 0;
+            fold([&](const std::string_view piece) { length += piece.size(); });
+            std::string folded;
+            folded.reserve(length);
+            fold([&](const std::string_view piece) { folded.append(piece); });
+
+            current_line = end;
+            return folded;
+        }
+
+        /**
+         * Splits a leading `&name` anchor off a value.
+         *
+         * @param value The value after a key or dash. The anchor and the blanks after it are
+         *              removed, leaving it empty when the anchored node is the block below.
+         * @return The anchor name, or an empty string if the value has no anchor.
+         */
+        static std::string take_anchor(std::string& value) {
+            if (value.size() < 2 || value[0] != '&') {
+                return {};
+            }
+            const size_t end = value.find_first_of(" \t");
+            std::string name = value.substr(1, end == std::string::npos ? std::string::npos : end - 1);
+            value.erase(0, end == std::string::npos ? value.size() : value.find_first_not_of(" \t", end));
+            return name;
+        }
+
+        /**
+         * Records a node under its anchor name, if it has one.
+         *
+         * @param name The anchor name, or an empty string.
+         * @param node The parsed node.
+         * @return The node.
+         */
+        BasicJsonType anchored(const std::string& name, BasicJsonType node) {
+            if (!name.empty()) {
+                anchors.nodes[name] = node;
+            }
+            return node;
+        }
+
+        /**
+         * @return The most nodes aliases may copy into the document, see
+         *         `yaml_parse_options::max_alias_nodes`.
+         */
+        [[nodiscard]] std::size_t alias_node_limit() const {
+            if (options.max_alias_nodes != 0) {
+                return options.max_alias_nodes;
+            }
+            return std::max<std::size_t>(1000000, 100 * anchors.input_bytes);
+        }
+
+        /**
+         * Counts the nodes of a value, giving up once the count exceeds `limit`, so the work is
+         * bounded by the limit rather than by the size of the value.
+         *
+         * @param value The value to count.
+         * @param limit The count past which counting stops.
+         * @return The number of nodes, or a number above `limit`.
+         */
+        static std::size_t count_nodes(const BasicJsonType& value, const std::size_t limit) {
+            std::size_t count = 1;
+            if (value.is_structured()) {
+                for (const BasicJsonType& child : value) {
+                    if (count > limit) {
+                        break;
+                    }
+                    count += count_nodes(child, limit - count);
+                }
+            }
+            return count;
+        }
+
+        /**
+         * Parses a scalar value from a string and converts it to the appropriate JSON-compatible type.
+         * Handles various data formats such as strings, numbers, booleans, nulls, and special YAML values.
+         * Also, processes quoted strings and escaped characters.
+         *
+         * @param value The input string containing the scalar value to parse.
+         * @return A JSON array representing the parsed sequence.
+         */
+        BasicJsonType parse_scalar(const std::string& value) {
+            if (options.tracer) {
+                const std::uint64_t start = options.tracer->now();
+                BasicJsonType result = type_scalar(value);
+                typing_ns += options.tracer->now() - start;
+                ++typed_scalars;
+                return result;
+            }
+            return type_scalar(value);
+        }
+
+        /**
+         * Converts a scalar to its JSON value; see `parse_scalar`.
+         *
+         * @param value The input string containing the scalar value to parse.
+         * @return The typed scalar.
+         */
+        BasicJsonType type_scalar(const std::string& value) {
+            std::string val = value;
+
+            // Remove leading/trailing whitespace
+            val.erase(0, val.find_first_not_of(" \t"));
+            val.erase(val.find_last_not_of(" \t") + 1);
+
+            // An alias stands for a copy of the node its anchor was defined on; without such an
+            // anchor (`*.log`), the scalar stays a plain string
+            if (val.size() > 1 && val[0] == '*') {
+                if (const auto anchor = anchors.nodes.find(val.substr(1)); anchor != anchors.nodes.end()) {
+                    const std::size_t limit = alias_node_limit();
+                    anchors.alias_nodes += count_nodes(anchor->second, limit - std::min(anchors.alias_nodes, limit));
+                    if (anchors.alias_nodes > limit) {
+                        fail("Aliases expand to more than " + std::to_string(limit) + " nodes at line "
+                            + std::to_string(current_line - 1));
+                        return nullptr;
+                    }
+                    return anchor->second;
+                }
+            }
+
+            // Check for JSON array syntax
+            if (is_json_array(val)) {
+                if (BasicJsonType raw; try_keep_raw_json(val, raw)) {
+                    return raw;
+                }
+                BasicJsonType array = parse_json_array(val);
+                pack_if_selected(array);
+                return array;
+            }
+
+            // Check for JSON object syntax
+            if (is_json_object(val)) {
+                if (BasicJsonType raw; try_keep_raw_json(val, raw)) {
+                    return raw;
+                }
+                return parse_json_object(val);
+            }
+
+            // Remove quotes if present
+            if (val.size() >= 2 && ((val.front() == '"' && val.back() == '"') ||
+                                    (val.front() == '\'' && val.back() == '\''))) {
+                return unquote(val);
+            }
+
+            // Custom resolvers see plain scalars before the built-in typing
+            if (BasicJsonType resolved; ScalarResolver::resolve(val, resolved)) {
+                return resolved;
+            }
+
+            // Handle special YAML values
+            if (val == "null" || val == "~" || val == "Null" || val == "NULL") return nullptr;
+            if (val == "true" || val == "True" || val == "TRUE") return true;
+            if (val == "false" || val == "False" || val == "FALSE") return false;
+
+            // Handle special float values
+            if (val == ".inf" || val == ".Inf" || val == ".INF" || val == "+.inf") {
+                return std::numeric_limits<double>::infinity();
+            }
+
+            if (val == "-.inf" || val == "-.Inf" || val == "-.INF") {
+                return -std::numeric_limits<double>::infinity();
+            }
+
+            if (val == ".nan" || val == ".NaN" || val == ".NAN") {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+
+            // Try parsing as different number formats
+            if (BasicJsonType number; parse_number(val, number)) {
+                return number;
+            }
+
+            return val; // Return as string
+        }
+
+        /**
+         * Parses a YAML-style sequence from the current position in the input lines, constructing a JSON array
+         * with the appropriate structure based on indentation and content rules.
+         *
+         * @param current_indent The current level of indentation in the input, used to determine sequence boundaries.
+         * @return A JSON array representing the parsed sequence.
+         * @throws std::runtime_error If syntax issues or unexpected input structures are encountered during parsing.
+         */
+        BasicJsonType parse_sequence(const int current_indent) {
+            BasicJsonType array = BasicJsonType::array();
+
+            while (current_line < lines.size()) {
+                const std::string& line = lines[current_line];
+
+                // Skip empty lines
+                if (line.empty()) {
+                    current_line++;
+                    continue;
+                }
+
+                const int line_indent = indents[current_line];
+
+                // If indentation is less than the current level, we're done
+                if (line_indent < current_indent) {
+                    break;
+                }
+
+                // If indentation doesn't match, break
+                if (line_indent != current_indent) {
+                    break;
+                }
+
+                // Check if this is a sequence item
+                if (line[line_indent] != '-') {
+                    break;
+                }
+
+                current_line++;
+                const path_segment item(*this, array.size());
+
+                // Extract the value after the dash
+                std::string value = line.substr(line_indent + 1);
+                value.erase(0, value.find_first_not_of(" \t"));
+                const std::string anchor = take_anchor(value);
+
+                if (value.empty()) {
+                    // Complex value on next line(s)
+                    int sub_indent = get_next_sub_indent(current_line, current_indent);
+                    if (sub_indent == -1) {
+                        fail("Expected indented block for sequence item at line "
+                            + std::to_string(current_line - 1));
+                        break;
+                    }
+                    BasicJsonType sub = parse_value(sub_indent);
+                    if (sub.is_null()) {
+                        fail("Failed to parse block for sequence item at line "
+                            + std::to_string(current_line - 1));
+                        break;
+                    }
+                    array.push_back(anchored(anchor, std::move(sub)));
+                } else if (value[0] == '-' && (value.size() == 1 || value[1] == ' ' || value[1] == '\t')) {
+                    // Inline nested sequence ("- - a"; "- -3" is a negative number) - handle specially
+                    BasicJsonType nested_array = BasicJsonType::array();
+
+                    // Parse the current line as nested sequence items
+                    std::string remaining = value;
+                    while (!remaining.empty() && remaining[0] == '-') {
+                        remaining = remaining.substr(1); // Remove the dash
+                        remaining.erase(0, remaining.find_first_not_of(" \t"));
+
+                        // Find the next dash or end of line
+                        size_t next_dash = remaining.find(" -");
+                        std::string item_value;
+                        if (next_dash != std::string::npos) {
+                            item_value = remaining.substr(0, next_dash);
+                            remaining = remaining.substr(next_dash + 1);
+                            remaining.erase(0, remaining.find_first_not_of(" \t"));
+                        } else {
+                            item_value = remaining;
+                            remaining.clear();
+                        }
+
+                        if (!item_value.empty()) {
+                            const path_segment nested_item(*this, nested_array.size());
+                            nested_array.push_back(parse_scalar(item_value));
+                        }
+                    }
+
+                    // Now check for continuation lines at higher indentation
+                    int sub_indent = -1;
+                    while (current_line < lines.size()) {
+                        const std::string& next_line = lines[current_line];
+                        if (next_line.empty()) {
+                            current_line++;
+                            continue;
+                        }
+
+                        const int next_indent = indents[current_line];
+                        if (next_indent <= current_indent) {
+                            break; // End of this nested sequence
+                        }
+
+                        if (next_line[next_indent] == '-') {
+                            if (sub_indent == -1) {
+                                sub_indent = next_indent;
+                            } else if (next_indent != sub_indent) {
+                                fail("Inconsistent indentation in nested sequence continuation at line "
+                                    + std::to_string(current_line));
+                                break;
+                            }
+                            current_line++;
+                            std::string next_value = next_line.substr(next_indent + 1);
+                            next_value.erase(0, next_value.find_first_not_of(" \t"));
+                            const path_segment nested_item(*this, nested_array.size());
+                            nested_array.push_back(parse_scalar(next_value));
+                        } else {
+                            break;
+                        }
+                    }
+
+                    array.push_back(anchored(anchor, std::move(nested_array)));
+                } else if ((!starts_with_quote_or_json_token(value) && value.find(':') != std::string::npos)
+                           || starts_with_quoted_key(value)) {
+                    // Inline mapping; "- &a key: value" would anchor the first key
+                    if (!anchor.empty()) {
+                        fail("Anchors on mapping keys are not supported at line "
+                            + std::to_string(current_line - 1));
+                        break;
+                    }
+                    yaml_object_builder<BasicJsonType> obj;
 
                     // Parse the first key-value pair from the current line
-                    size_t colon_pos = value.find(':');
+                    size_t colon_pos = find_key_colon(value, 0);
                     std::string key = value.substr(0, colon_pos);
                     key.erase(key.find_last_not_of(" \t") + 1);
+                    unquote_key(key);
+
+                    std::string val = value.substr(colon_pos + 1);
+                    val.erase(0, val.find_first_not_of(" \t"));
+                    const std::string val_anchor = take_anchor(val);
+
+                    if (val.empty()) {
+                        int sub_indent = get_next_sub_indent(current_line, current_indent);
+                        if (sub_indent == -1) {
+                            fail("Expected indented block for key '" + key
+                                + "' at line " + std::to_string(current_line - 1));
+                            break;
+                        }
+                        const path_segment first_key(*this, key);
+                        BasicJsonType sub = parse_value(sub_indent);
+                        if (sub.is_null()) {
+                            fail("Failed to parse block for key '" + key
+                                + "' at line " + std::to_string(current_line - 1));
+                            break;
+                        }
+                        obj.insert(std::move(key), anchored(val_anchor, std::move(sub)));
+                    } else {
+                        const path_segment first_key(*this, key);
+                        const int key_column = static_cast<int>(lines[current_line - 1].size() - value.size());
+                        obj.insert(std::move(key), anchored(val_anchor, parse_scalar(fold_continuation(val, key_column + 1))));
+                    }
+
+                    // Now check for additional key-value pairs at a consistent higher indentation
+                    int key_indent = -1;
+                    while (current_line < lines.size()) {
+                        const std::string& next_line = lines[current_line];
+                        if (next_line.empty()) {
+                            current_line++;
+                            continue;
+                        }
+
+                        const int next_indent = indents[current_line];
+
+                        // If indentation is less than or equal to sequence item level, we're done
+                        if (next_indent <= current_indent) {
+                            break;
+                        }
+
+                        // Must have a colon to be a mapping entry
+                        size_t next_colon_pos = find_key_colon(next_line, static_cast<size_t>(next_indent));
+                        if (next_colon_pos == std::string::npos) {
+                            break;
+                        }
+
+                        // Set or check consistent key indentation
+                        if (key_indent == -1) {
+                            key_indent = next_indent;
+                        } else if (next_indent != key_indent) {
+                            break;
+                        }
+
+                        current_line++;
+
+                        std::string next_key = next_line.substr(next_indent, next_colon_pos - next_indent);
+                        next_key.erase(next_key.find_last_not_of(" \t") + 1);
+                        unquote_key(next_key);
+
+                        std::string next_val = next_line.substr(next_colon_pos + 1);
+                        next_val.erase(0, next_val.find_first_not_of(" \t"));
+                        const std::string next_anchor = take_anchor(next_val);
+
+                        const path_segment next_key_segment(*this, next_key);
+                        if (next_val.empty()) {
+                            int next_sub_indent = get_next_sub_indent(current_line, key_indent);
+                            if (next_sub_indent == -1) {
+                                fail("Expected indented block for key '" + next_key
+                                    + "' at line " + std::to_string(current_line - 1));
+                                break;
+                            }
+                            BasicJsonType next_sub = parse_value(next_sub_indent);
+                            if (next_sub.is_null()) {
+                                fail("Failed to parse block for key '" + next_key
+                                    + "' at line " + std::to_string(current_line - 1));
+                                break;
+                            }
+                            obj.insert(std::move(next_key), anchored(next_anchor, std::move(next_sub)));
+                        } else {
+                            obj.insert(std::move(next_key),
+                                       anchored(next_anchor, parse_scalar(fold_continuation(next_val, key_indent + 1))));
+                        }
+                    }
+
+                    array.push_back(obj.finish());
+                } else {
+                    // Simple scalar value (including JSON arrays and objects)
+                    array.push_back(anchored(anchor, parse_scalar(fold_continuation(value, current_indent + 1))));
+                }
+            }
+
+            return array;
+        }
+
+        /**
+         * Parses a YAML-style mapping structure from the current line and returns it
+         * as a JSON object. The method verifies indentation consistency, extracts keys
+         * and values, handles nested mappings, and processes scalar values.
+         *
+         * @param current_indent The current indentation level to compare against the lines
+         *                       being parsed. Determines the scope of the mapping.
+         * @return A JSON object constructed from the parsed mapping structure.
+         *         Keys represent YAML mapping keys, and values represent their corresponding parsed values.
+         * @throws std::runtime_error If the expected structure (e.g., indented block for a key)
+         *                            is missing, or parsing fails for nested blocks.
+         */
+        BasicJsonType parse_mapping(const int current_indent) {
+            yaml_object_builder<BasicJsonType> object;
+
+            while (current_line < lines.size()) {
+                const std::string& line = lines[current_line];
+
+                // Skip empty lines
+                if (line.empty()) {
+                    current_line++;
+                    continue;
+                }
+
+                const int line_indent = indents[current_line];
+
+                // If indentation is less than the current level, we're done
+                if (line_indent < current_indent) {
+                    break;
+                }
+
+                // If indentation doesn't match the current level, break
+                if (line_indent != current_indent) {
+                    break;
+                }
+
+                // Look for key-value separator
+                const size_t colon_pos = find_key_colon(line, static_cast<size_t>(line_indent));
+                if (colon_pos == std::string::npos) {
+                    break; // Not a mapping line
+                }
+
+                current_line++;
+
+                // Extract key and value
+                std::string key = line.substr(line_indent, colon_pos - line_indent);
+                key.erase(key.find_last_not_of(" \t") + 1);
+                unquote_key(key);
+
+                std::string value = line.substr(colon_pos + 1);
+                value.erase(0, value.find_first_not_of(" \t"));
+                const std::string anchor = take_anchor(value);
+
+                if (value.empty()) {
+                    // Complex value on next line(s)
+                    const int sub_indent = get_next_sub_indent(current_line, current_indent);
+                    if (sub_indent == -1) {
+                        fail("Expected indented block for key '" + key
+                            + "' at line " + std::to_string(current_line - 1));
+                        break;
+                    }
+                    const path_segment entry(*this, key);
+                    BasicJsonType sub = parse_value(sub_indent);
+                    if (sub.is_null()) {
+                        fail("Failed to parse block for key '" + key
+                            + "' at line " + std::to_string(current_line - 1));
+                        break;
+                    }
+                    object.insert(std::move(key), anchored(anchor, std::move(sub)));
+                } else {
+                    // Simple scalar value (including JSON arrays and objects)
+                    const path_segment entry(*this, key);
+                    object.insert(std::move(key), anchored(anchor, parse_scalar(fold_continuation(value, current_indent + 1))));
+                }
+            }
+
+            return object.finish();
+        }
+
+        /**
+         * Parses a single value from the current YAML lines using the provided indentation level.
+         * Determines the type of the value (scalar, sequence, mapping, or JSON block) based on
+         * the content and indentation rules.
+         *
+         * @param current_indent The expected indentation level for parsing the current value.
+         *                        Lines with greater indentation are ignored, and lines with
+         *                        lesser indentation indicate the end of the current structure.
+         * @return A JSON representation of the parsed value. Returns `nullptr` if no valid value
+         *         can be parsed or if the operation reaches the end of the input lines.
+         */
+        BasicJsonType parse_value(const int current_indent) {
+            while (current_line < lines.size()) {
+                const std::string& line = lines[current_line];
+
+                // Skip empty lines
+                if (line.empty()) {
+                    current_line++;
+                    continue;
+                }
+
+                const int line_indent = indents[current_line];
+
+                // If indentation is less than expected, return null
+                if (line_indent < current_indent) {
+                    return nullptr;
+                }
+
+                // If indentation matches, determine the type
+                if (line_indent == current_indent) {
+                    const std::string at_level = line.substr(line_indent);
+
+                    // If this line starts with a JSON token, try to parse a (potentially multi-line) JSON block
+                    if (starts_with_json_token(at_level)) {
+                        const size_t saved = current_line;
+                        if (std::string json_text; try_collect_json_block(current_indent, json_text)) {
+                            if (BasicJsonType raw; try_keep_raw_json(json_text, raw)) {
+                                return raw;
+                            }
+                            BasicJsonType block = BasicJsonType::parse(json_text, nullptr, false);
+                            if (!block.is_discarded()) {
+                                pack_if_selected(block);
+                                return block;
+                            }
+                            // If parsing fails, revert and fall through to other handlers
+                            current_line = saved;
+                        }
+                    }
+
+                    if (line[line_indent] == '-') {
+                        BasicJsonType sequence = parse_sequence(current_indent);
+                        pack_if_selected(sequence);
+                        return sequence;
+                    } else if (line.find(':') != std::string::npos) {
+                        return parse_mapping(current_indent);
+                    } else {
+                        current_line++;
+                        return parse_scalar(fold_continuation(at_level, current_indent));
+                    }
+                } else {
+                    // Skip lines with greater indentation until we find our level
+                    current_line++;
+                    continue;
+                }
+            }
+
+            return nullptr;
+        }
+
+        /**
+         * Traces the parsing of a root-level entry: a "parse subtree" span labelled with the key,
+         * and a nested "scalar typing" span whose duration is the total time spent typing the
+         * subtree's scalars. Typing is interleaved with structure building, so that span is
+         * drawn from the start of the subtree rather than at the exact moments it ran.
+         */
+        class subtree_trace {
+            const basic_yaml_parser& parser;
+            yaml_trace_scope span;
+            std::uint64_t start_ns = 0;
+
+        public:
+            subtree_trace(const basic_yaml_parser& owner, const std::string& key)
+                : parser(owner), span(owner.options.tracer, "parse subtree", key) {
+                if (parser.options.tracer) {
+                    parser.typing_ns = 0;
+                    parser.typed_scalars = 0;
+                    start_ns = parser.options.tracer->now();
+                }
+            }
+
+            subtree_trace(const subtree_trace&) = delete;
+            subtree_trace& operator=(const subtree_trace&) = delete;
+
+            ~subtree_trace() {
+                if (yaml_tracer* tracer = parser.options.tracer) {
+                    tracer->record("scalar typing", "yaml", start_ns, start_ns + parser.typing_ns, {},
+                                   parser.typed_scalars);
+                    span.set_items(parser.typed_scalars);
+                }
+            }
+        };
+
+        /**
+         * Parses a document that holds a single scalar or flow collection, as `to_yaml` writes for
+         * such roots: a quoted scalar, a `[...]` or `{...}` collection, or a plain scalar without a
+         * key colon on the first non-empty line, followed by nothing but its folded continuation.
+         *
+         * @param result Receives the typed root value.
+         * @return True if the document is a lone scalar; otherwise false, with no lines consumed.
+         */
+        bool parse_root_scalar(BasicJsonType& result) {
+            size_t first = 0;
+            while (first < lines.size() && lines[first].empty()) {
+                first++;
+            }
+            if (first == lines.size() || indents[first] != 0) {
+                return false;
+            }
+
+            const std::string& line = lines[first];
+            const bool quoted = line[0] == '"' || line[0] == '\'';
+            if (line.compare(0, 3, "---") == 0 || line.compare(0, 3, "...") == 0
+                || (line[0] == '-' && (line.size() == 1 || line[1] == ' ' || line[1] == '\t'))
+                || (quoted && find_closing_quote(line, 0) != line.find_last_not_of(" \t"))
+                || (!quoted && line[0] != '[' && line[0] != '{' && find_key_colon(line, 0) != std::string::npos)) {
+                return false;
+            }
+
+            current_line = first + 1;
+            const std::string value = fold_continuation(line, 1);
+            for (size_t i = current_line; i < lines.size(); ++i) {
+                if (!lines[i].empty()) {
+                    current_line = 0;
+                    return false;
+                }
+            }
+            current_line = lines.size();
+            result = parse_scalar(value);
+            return true;
+        }
+
+        /**
+         * Parses the root of the document, which is a mapping, a sequence or a lone scalar.
+         *
+         * @param spans When not null, receives the line range of every root-level key.
+         * @return A JSON representation of the parsed document.
+         * @throws std::runtime_error If the input structure is invalid or unprocessable.
+         */
+        BasicJsonType parse_root(std::vector<root_span>* spans) {
+            yaml_object_builder<BasicJsonType> root;
+            current_line = 0;
+
+            if (BasicJsonType scalar; scalar_root && parse_root_scalar(scalar)) {
+                return scalar;
+            }
+
+            while (current_line < lines.size()) {
+                const std::string& line = lines[current_line];
+
+                // Skip empty lines
+                if (line.empty()) {
+                    current_line++;
+                    continue;
+                }
+
+                const int line_indent = indents[current_line];
+
+                // Check if this is a sequence at the root level
+                if (line[0] == '-') {
+                    if (root.empty()) {
+                        return parse_sequence(0);
+                    } else {
+                        fail("Cannot mix sequences and mappings at root level");
+                        break;
+                    }
+                }
+
+                // Look for mapping
+                const size_t colon_pos = find_key_colon(line, static_cast<size_t>(line_indent));
+                if (colon_pos == std::string::npos) {
+                    current_line++;
+                    continue; // Skip lines that aren't key-value pairs
+                }
+
+                // Extract key and value
+                std::string key = line.substr(line_indent, colon_pos - line_indent);
+                key.erase(key.find_last_not_of(" \t") + 1);
+                unquote_key(key);
+
+                std::string value = line.substr(colon_pos + 1);
+                value.erase(0, value.find_first_not_of(" \t"));
+                const std::string anchor = take_anchor(value);
+
+                if (spans) {
+                    // The previous key owns everything up to this line, comments and blank lines included
+                    if (!spans->empty()) {
+                        spans->back().end_line = current_line;
+                    }
+                    spans->push_back({key, current_line, lines.size()});
+                }
+
+                current_line++;
+                const subtree_trace subtree(*this, key);
+
+                if (value.empty()) {
+                    // Complex value on next line(s)
+                    const int sub_indent = get_next_sub_indent(current_line, line_indent);
+                    if (sub_indent == -1) {
+                        fail("Expected indented block for key '" + key
+                            + "' at line " + std::to_string(current_line - 1));
+                        break;
+                    }
+
+                    const path_segment entry(*this, key);
+                    BasicJsonType sub = parse_value(sub_indent);
+                    if (sub.is_null()) {
+                        fail("Failed to parse block for key '" + key
+                            + "' at line " + std::to_string(current_line - 1));
+                        break;
+                    }
+
+                    root.insert(std::move(key), anchored(anchor, std::move(sub)));
+                } else {
+                    // Simple scalar value (including JSON arrays and objects)
+                    const path_segment entry(*this, key);
+                    root.insert(std::move(key), anchored(anchor, parse_scalar(fold_continuation(value, line_indent + 1))));
+                }
+            }
+
+            return root.finish();
+        }
+
+        /**
+         * Parses the root in a "parse" span and records the call in the metrics registry.
+         *
+         * @param spans When not null, receives the line range of every root-level key.
+         * @return The document, or a discarded value if parsing failed without exceptions.
+         */
+        BasicJsonType parse_traced(std::vector<root_span>* spans) {
+            if (failed()) {
+                return BasicJsonType(BasicJsonType::value_t::discarded);
+            }
+            yaml_trace_scope span(options.tracer, "parse");
+            BasicJsonType root;
+            NLOHMANN_YAML_TRY {
+                root = parse_root(spans);
+            } NLOHMANN_YAML_CATCH(...) {
+                record_metrics(std::current_exception());
+                NLOHMANN_YAML_RETHROW;
+            }
+            record_metrics();
+            if (failed()) {
+                return BasicJsonType(BasicJsonType::value_t::discarded);
+            }
+            return root;
+        }
+
+    public:
+        /**
+         * Constructs a YAML parser object initialized with an input stream. The input
+         * stream is preprocessed to prepare the parser for analyzing the YAML content.
+         *
+         * @param is An input stream containing the raw YAML data to be parsed.
+         * @param parse_options Options controlling how the document is built.
+         */
+        explicit basic_yaml_parser(std::istream& is, const yaml_parse_options& parse_options = {})
+            : options(parse_options), track_paths(!parse_options.raw_json_paths.empty()) {
+            NLOHMANN_YAML_TRY {
+                preprocess_input(is);
+            } NLOHMANN_YAML_CATCH(...) {
+                record_metrics(std::current_exception());
+                NLOHMANN_YAML_RETHROW;
+            }
+            if (failed()) {
+                record_metrics();
+            }
+        }
+
+        /**
+         * Constructs a YAML parser object for a document held in memory, which is indexed
+         * directly without going through a stream.
+         *
+         * @param text The raw YAML data to be parsed.
+         * @param parse_options Options controlling how the document is built.
+         */
+        explicit basic_yaml_parser(const std::string_view text, const yaml_parse_options& parse_options = {})
+            : options(parse_options), track_paths(!parse_options.raw_json_paths.empty()) {
+            NLOHMANN_YAML_TRY {
+                preprocess_input(text);
+            } NLOHMANN_YAML_CATCH(...) {
+                record_metrics(std::current_exception());
+                NLOHMANN_YAML_RETHROW;
+            }
+            if (failed()) {
+                record_metrics();
+            }
+        }
+
+        /**
+         * @return Whether parsing failed. Only observable with exceptions disabled, where errors
+         *         are reported through `error()` instead of thrown.
+         */
+        [[nodiscard]] bool failed() const noexcept {
+            return !failure.empty();
+        }
+
+        /**
+         * @return The message of the first parse error, or an empty string.
+         */
+        [[nodiscard]] const std::string& error() const noexcept {
+            return failure;
+        }
+
+        /**
+         * Returns the end of the block a line opens: the first following non-empty line that is not
+         * indented deeper, or the number of lines. For an empty line this is the next non-empty
+         * line. Lines are numbered like in error messages, from 0, after comments are removed. The
+         * table for all lines is built by the first call, in one pass with a stack of the lines
+         * whose blocks are still open; later calls are O(1). `parse()` reads every line and never
+         * builds it; readers that skip blocks (`yaml_struct_reader`) jump with it.
+         *
+         * @param line The index of the line.
+         * @return The index of the line after the block.
+         */
+        size_t block_end(const size_t line) {
+            if (block_ends.size() != lines.size()) {
+                block_ends.assign(lines.size(), lines.size());
+                std::vector<size_t> open;
+                size_t first_empty = 0;
+                for (size_t i = 0; i < lines.size(); ++i) {
+                    if (lines[i].empty()) {
+                        continue;
+                    }
+                    while (!open.empty() && indents[open.back()] >= indents[i]) {
+                        block_ends[open.back()] = i;
+                        open.pop_back();
+                    }
+                    open.push_back(i);
+                    std::fill(block_ends.begin() + static_cast<std::ptrdiff_t>(first_empty),
+                              block_ends.begin() + static_cast<std::ptrdiff_t>(i), i);
+                    first_empty = i + 1;
+                }
+            }
+            return block_ends[line];
+        }
+
+        /**
+         * Parses a YAML-like document into a JSON object. It processes the input lines, identifying
+         * and handling mappings, sequences, and scalar values. This method expects a line-based
+         * representation of a YAML document and assumes correct formatting.
+         *
+         * @return A JSON object representing the parsed structure of the input document.
+         *         This includes mappings, sequences, scalar values, and nested structures.
+         *         Throws an exception if the input structure is invalid or unprocessable; with
+         *         exceptions disabled, returns a discarded value and sets `error()` instead.
+         */
+        BasicJsonType parse() {
+            anchors.input_bytes = input_size;
+            return parse_traced(nullptr);
+        }
+
+        /**
+         * Parses the document like `parse()`, resolving aliases against anchors defined by earlier
+         * pieces of the same document (as read by `yaml_mapping_stream`). A piece is always part of
+         * a root mapping, so a lone scalar in it is skipped rather than read as the document.
+         *
+         * @param known_anchors The anchors defined so far; receives the anchors of this piece too.
+         *                      Aliases in all pieces together share one `max_alias_nodes` budget.
+         * @param root_keys When not null, receives the root-level keys in input order, once per
+         *                  occurrence.
+         * @return A JSON object representing the parsed structure of the input document.
+         */
+        BasicJsonType parse(anchor_table& known_anchors, std::vector<std::string>* root_keys = nullptr) {
+            anchors = std::move(known_anchors);
+            anchors.input_bytes += input_size;
+            scalar_root = false;
+            std::vector<root_span> spans;
+            BasicJsonType root = parse_traced(root_keys ? &spans : nullptr);
+            known_anchors = std::move(anchors);
+            if (root_keys) {
+                root_keys->clear();
+                for (root_span& span : spans) {
+                    root_keys->push_back(std::move(span.key));
+                }
+            }
+            return root;
+        }
+
+        /**
+         * Parses the document like `parse()` and additionally fills a memory report that relates
+         * the raw input bytes of every root-level key to the estimated bytes of its parsed subtree.
+         *
+         * @param report Receives the memory report of the parsed document.
+         * @param depth How many levels of children to report; root-level keys are level 1.
+         * @return A JSON object representing the parsed structure of the input document, or a
+         *         discarded value (with `report` left untouched) if it failed without exceptions.
+         */
+        BasicJsonType parse(yaml_memory_report& report, const std::size_t depth = 1) {
+            static_assert(std::is_same<BasicJsonType, json>::value, "memory reports are only available for nlohmann::json");
+            if (failed()) {
+                return BasicJsonType(BasicJsonType::value_t::discarded);
+            }
+            anchors.input_bytes = input_size;
+            std::vector<root_span> spans;
+            BasicJsonType root = parse_traced(&spans);
+            if (failed()) {
+                return root;
+            }
+
+            report = memory_report(root, depth);
+            for (const size_t bytes : line_bytes) {
+                report.input_bytes += bytes;
+            }
+
+            if (root.is_object() && depth > 0) {
+                std::map<std::string, size_t> input_per_key;
+                for (const auto& span : spans) {
+                    // Repeated keys overwrite each other, so their input adds up
+                    size_t& bytes = input_per_key[span.key];
+                    for (size_t i = span.first_line; i < span.end_line; ++i) {
+                        bytes += line_bytes[i];
+                    }
+                }
+
+                // Children are reported in the object's iteration order
+                auto child = report.children.begin();
+                for (auto it = root.cbegin(); it != root.cend() && child != report.children.end(); ++it, ++child) {
+                    child->input_bytes = input_per_key[it.key()];
+                }
+            }
+
+            return root;
+        }
+
+        /**
+         * Walks a flat root mapping without building the document: `visit(key, value)` is called
+         * with every root key and its typed scalar value, in input order.
+         *
+         * @param visit Called as `visit(const std::string& key, BasicJsonType&& value)`.
+         * @throws std::runtime_error If the root is not a mapping of scalars.
+         */
+        template <typename Visitor>
+        void visit_flat_mapping(Visitor&& visit) {
+            yaml_trace_scope span(options.tracer, "parse");
+            if (failed()) {
+                return;
+            }
+            current_line = 0;
+            while (current_line < lines.size()) {
+                const std::string& line = lines[current_line];
+                if (line.empty()) {
+                    current_line++;
+                    continue;
+                }
+                if (indents[current_line] != 0 || line[0] == '-') {
+                    fail("Expected a flat mapping at line " + std::to_string(current_line));
+                    break;
+                }
+
+                const size_t colon_pos = find_key_colon(line, 0);
+                if (colon_pos == std::string::npos) {
+                    current_line++;
+                    continue; // Skip lines that aren't key-value pairs, like parse()
+                }
+                current_line++;
+
+                std::string key = line.substr(0, colon_pos);
+                key.erase(key.find_last_not_of(" \t") + 1);
+                unquote_key(key);
+
+                std::string value = line.substr(colon_pos + 1);
+                value.erase(0, value.find_first_not_of(" \t"));
+
+                BasicJsonType scalar;
+                if (!value.empty()) {
+                    scalar = parse_scalar(fold_continuation(value, 1));
+                }
+                if (value.empty() || scalar.is_structured() || scalar.is_binary()) {
+                    fail("Key '" + key + "' does not hold a scalar in a flat mapping");
+                    break;
+                }
+                visit(key, std::move(scalar));
+            }
+            span.set_items(lines.size());
+        }
+    };
+
+    /**
+     * YAML parser with the default scalar typing.
+     */
+    using yaml_parser = basic_yaml_parser<>;
+
+    /**
+     * Parses a YAML input stream and converts it to a JSON object.
+     *
+     * @param input The input stream containing YAML data to be parsed.
+     * @return A JSON object representing the parsed data from the YAML input.
+     */
+    inline json parse_yaml(std::istream& input) {
+        yaml_parser parser(input);
+        return parser.parse();
+    }
+
+    /**
+     * Parses a YAML string and converts it to a JSON object.
+     *
+     * @param input The input string containing YAML data to be parsed.
+     * @return A JSON object representing the parsed data from the YAML string.
+     */
+    inline json parse_yaml(const std::string& input) {
+        yaml_parser parser(input);
+        return parser.parse();
+    }
+
+    /**
+     * Parses a YAML input stream with a custom scalar resolver chain, e.g.
+     * `parse_yaml<yaml_resolver_chain<yaml_duration_resolver, yaml_byte_size_resolver>>(input)`.
+     *
+     * @tparam ScalarResolver A `yaml_resolver_chain` applied to plain scalars.
+     * @param input The input stream containing YAML data to be parsed.
+     * @return A JSON object representing the parsed data from the YAML input.
+     */
+    template <typename ScalarResolver>
+    inline json parse_yaml(std::istream& input) {
+        basic_yaml_parser<ScalarResolver> parser(input);
+        return parser.parse();
+    }
+
+    /**
+     * Parses a YAML input stream with the given options, e.g. to keep large embedded JSON
+     * blocks as raw text.
+     *
+     * @param input The input stream containing YAML data to be parsed.
+     * @param options Options controlling how the document is built.
+     * @return A JSON object representing the parsed data from the YAML input.
+     */
+    inline json parse_yaml(std::istream& input, const yaml_parse_options& options) {
+        yaml_parser parser(input, options);
+        return parser.parse();
+    }
+
+    /**
+     * Parses a YAML string with the given options.
+     *
+     * @param input The input string containing YAML data to be parsed.
+     * @param options Options controlling how the document is built.
+     * @return A JSON object representing the parsed data from the YAML string.
+     */
+    inline json parse_yaml(const std::string& input, const yaml_parse_options& options) {
+        yaml_parser parser(input, options);
+        return parser.parse();
+    }
+
+    /**
+     * Parses a YAML string and reports a parse error as a status instead of an exception. This is
+     * the error path of builds without exceptions (`-fno-exceptions` or `JSON_NOEXCEPTION`), and
+     * works the same with them.
+     *
+     * @param input The input string containing YAML data to be parsed.
+     * @param result Receives the parsed document; left untouched if parsing fails.
+     * @param error Receives the error message if parsing fails.
+     * @param options Options controlling how the document is built.
+     * @return Whether the input was parsed.
+     */
+    inline bool try_parse_yaml(const std::string_view input, json& result, std::string& error,
+                               const yaml_parse_options& options = {}) {
+#if defined(NLOHMANN_YAML_NOEXCEPTION)
+        yaml_parser parser(input, options);
+        json document = parser.parse();
+        if (parser.failed()) {
+            error = parser.error();
+            return false;
+        }
+        result = std::move(document);
+        return true;
+#else
+        try {
+            yaml_parser parser(input, options);
+            result = parser.parse();
+            return true;
+        } catch (const std::runtime_error& e) {
+            error = e.what();
+            return false;
+        }
+#endif
+    }
+
+    /**
+     * Parses a YAML string with a custom scalar resolver chain.
+     *
+     * @tparam ScalarResolver A `yaml_resolver_chain` applied to plain scalars.
+     * @param input The input string containing YAML data to be parsed.
+     * @return A JSON object representing the parsed data from the YAML string.
+     */
+    template <typename ScalarResolver>
+    inline json parse_yaml(const std::string& input) {
+        basic_yaml_parser<ScalarResolver> parser(input);
+        return parser.parse();
+    }
+
+    /**
+     * Parses a YAML input stream into another JSON type, such as `yaml_flat_json`,
+     * `yaml_ordered_hash_json` or `nlohmann::ordered_json`.
+     *
+     * @tparam BasicJsonType The JSON type to build.
+     * @tparam ScalarResolver A `yaml_resolver_chain` applied to plain scalars.
+     * @param input The input stream containing YAML data to be parsed.
+     * @param options Options controlling how the document is built.
+     * @return The parsed document.
+     */
+    template <typename BasicJsonType, typename ScalarResolver = yaml_resolver_chain<>>
+    inline BasicJsonType parse_yaml_as(std::istream& input, const yaml_parse_options& options = {}) {
+        basic_yaml_parser<ScalarResolver, BasicJsonType> parser(input, options);
+        return parser.parse();
+    }
+
+    /**
+     * Parses a YAML string into another JSON type.
+     *
+     * @tparam BasicJsonType The JSON type to build.
+     * @tparam ScalarResolver A `yaml_resolver_chain` applied to plain scalars.
+     * @param input The input string containing YAML data to be parsed.
+     * @param options Options controlling how the document is built.
+     * @return The parsed document.
+     */
+    template <typename BasicJsonType, typename ScalarResolver = yaml_resolver_chain<>>
+    inline BasicJsonType parse_yaml_as(const std::string& input, const yaml_parse_options& options = {}) {
+        basic_yaml_parser<ScalarResolver, BasicJsonType> parser(input, options);
+        return parser.parse();
+    }
+
+    /**
+     * Parses a YAML input stream and reports, per root-level key, the raw input bytes next to
+     * the estimated memory held by the parsed subtree.
+     *
+     * @param input The input stream containing YAML data to be parsed.
+     * @param report Receives the memory report of the parsed document.
+     * @param depth How many levels of children to report; root-level keys are level 1.
+     * @return A JSON object representing the parsed data from the YAML input.
+     */
+    inline json parse_yaml(std::istream& input, yaml_memory_report& report, const std::size_t depth = 1) {
+        yaml_parser parser(input);
+        return parser.parse(report, depth);
+    }
+
+    /**
+     * Parses a YAML string and reports, per root-level key, the raw input bytes next to
+     * the estimated memory held by the parsed subtree.
+     *
+     * @param input The input string containing YAML data to be parsed.
+     * @param report Receives the memory report of the parsed document.
+     * @param depth How many levels of children to report; root-level keys are level 1.
+     * @return A JSON object representing the parsed data from the YAML string.
+     */
+    inline json parse_yaml(const std::string& input, yaml_memory_report& report, const std::size_t depth = 1) {
+        yaml_parser parser(input);
+        return parser.parse(report, depth);
+    }
+
+    /**
+     * A parsed document with a generation counter that is incremented by every reload or
+     * modification. Path handles created by `compile_path` cache a direct reference to their node
+     * and compare generations to find out when the reference has to be resolved again.
+     *
+     * The document is neither copyable nor movable, because handles refer to it. It is not
+     * synchronized: reloads must not run concurrently with lookups.
+     *
+     * @tparam BasicJsonType The JSON type of the document (`json` by default).
+     */
+    template <typename BasicJsonType = json>
+    class basic_yaml_document {
+    public:
+        /**
+         * Creates a document holding the given value.
+         *
+         * @param value The initial content (an empty object by default).
+         */
+        explicit basic_yaml_document(BasicJsonType value = BasicJsonType::object()) : content(std::move(value)) {}
+
+        /**
+         * Parses the initial content from a YAML stream.
+         *
+         * @param input The input stream containing YAML data to be parsed.
+         * @param options Options controlling how the document is built.
+         */
+        explicit basic_yaml_document(std::istream& input, const yaml_parse_options& options = {})
+            : content(parse_yaml_as<BasicJsonType>(input, options)) {}
+
+        basic_yaml_document(const basic_yaml_document&) = delete;
+        basic_yaml_document& operator=(const basic_yaml_document&) = delete;
+
+        /**
+         * Replaces the content with a newly parsed YAML stream. The current content is kept if
+         * parsing fails.
+         *
+         * @param input The input stream containing YAML data to be parsed.
+         * @param options Options controlling how the document is built.
+         * @throws std::runtime_error If the input is not valid YAML.
+         */
+        void reload(std::istream& input, const yaml_parse_options& options = {}) {
+            replace(parse_yaml_as<BasicJsonType>(input, options));
+        }
+
+        /**
+         * Replaces the content with a newly parsed YAML string.
+         *
+         * @param input The input string containing YAML data to be parsed.
+         * @param options Options controlling how the document is built.
+         * @throws std::runtime_error If the input is not valid YAML.
+         */
+        void reload(const std::string& input, const yaml_parse_options& options = {}) {
+            replace(parse_yaml_as<BasicJsonType>(input, options));
+        }
+
+        /**
+         * Replaces the content with the given value.
+         *
+         * @param value The new content.
+         */
+        void replace(BasicJsonType value) {
+            content = std::move(value);
+            ++current_generation;
+        }
+
+        /**
+         * Modifies the content in place; path handles resolve again afterward.
+         *
+         * @param edit Called with a mutable reference to the content.
+         */
+        template <typename Edit>
+        void modify(Edit&& edit) {
+            ++current_generation; // also when the edit throws halfway through
+            std::forward<Edit>(edit)(content);
+        }
+
+        /**
+         * @return The content. Use `modify` or `replace` to change it.
+         */
+        [[nodiscard]] const BasicJsonType& root() const noexcept {
+            return content;
+        }
+
+        /**
+         * @return The number of reloads and modifications so far, plus one.
+         */
+        [[nodiscard]] std::uint64_t generation() const noexcept {
+            return current_generation;
+        }
+
+    private:
+        BasicJsonType content;
+        std::uint64_t current_generation = 1;
+    };
+
+    using yaml_document = basic_yaml_document<>;
+
+    /**
+     * A JSON pointer compiled against a `basic_yaml_document`. The node is looked up when the
+     * handle is created and cached; later reads cost a single generation comparison until the
+     * document is reloaded or modified, when the path is looked up again. The handle refers to the
+     * document, which must outlive it.
+     *
+     * A handle can be read from several threads at once, under the same rule as its document: no
+     * reload or modification may run concurrently. The cached node and its generation are
+     * published through atomics, so threads that look the path up again after a change do not
+     * race each other.
+     *
+     * @tparam BasicJsonType The JSON type of the document.
+     */
+    template <typename BasicJsonType = json>
+    class basic_yaml_path_handle {
+    public:
+        /**
+         * Compiles a JSON pointer for a document.
+         *
+         * @param document The document the path is resolved in.
+         * @param path A JSON pointer such as "/limits/rps".
+         * @throws std::runtime_error If the path is not a valid JSON pointer.
+         */
+        basic_yaml_path_handle(const basic_yaml_document<BasicJsonType>& document, const std::string& path)
+            : document(&document), pointer(parse_pointer(path)) {
+            resolve();
+        }
+
+        basic_yaml_path_handle(const basic_yaml_path_handle& other)
+            : document(other.document), pointer(other.pointer) {
+            resolve();
+        }
+
+        basic_yaml_path_handle& operator=(const basic_yaml_path_handle& other) {
+            if (this != &other) {
+                document = other.document;
+                pointer = other.pointer;
+                resolve();
+            }
+            return *this;
+        }
+
+        /**
+         * @return The node at the path, or nullptr if the current document has no such node.
+         */
+        [[nodiscard]] const BasicJsonType* find() const {
+            const std::uint64_t generation = document->generation();
+            if (resolved_generation.load(std::memory_order_acquire) != generation) {
+                resolve();
+            }
+            return node.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @return The node at the path.
+         * @throws std::runtime_error If the current document has no such node.
+         */
+        const BasicJsonType& operator*() const {
+            const BasicJsonType* found = find();
+            if (found == nullptr) {
+                NLOHMANN_YAML_THROW(std::runtime_error("Path not found: " + pointer.to_string()));
+            }
+            return *found;
+        }
+
+        const BasicJsonType* operator->() const {
+            return &**this;
+        }
+
+        /**
+         * Converts the node at the path with `get<T>()`.
+         *
+         * @throws std::runtime_error If the current document has no such node.
+         */
+        template <typename T>
+        T get() const {
+            return (**this).template get<T>();
+        }
+
+        /**
+         * @return Whether the current document has a node at the path.
+         */
+        [[nodiscard]] bool exists() const {
+            return find() != nullptr;
+        }
+
+        /**
+         * @return The path as a JSON pointer string.
+         */
+        [[nodiscard]] std::string path() const {
+            return pointer.to_string();
+        }
+
+    private:
+        using pointer_type = typename BasicJsonType::json_pointer;
+
+        static pointer_type parse_pointer(const std::string& path) {
+#if defined(NLOHMANN_YAML_NOEXCEPTION)
+            return pointer_type(path); // an invalid path is reported by the JSON pointer itself
+#else
+            try {
+                return pointer_type(path);
+            } catch (const std::exception& e) {
+                NLOHMANN_YAML_THROW(std::runtime_error("Invalid path '" + path + "': " + e.what()));
+            }
+#endif
+        }
+
+        /**
+         * Looks the path up in the current document. Concurrent callers see the same generation
+         * and store the same node; the node is stored before the generation is released, so a
+         * reader that acquires the new generation also sees its node.
+         */
+        void resolve() const {
+            const BasicJsonType& root = document->root();
+            const BasicJsonType* found = nullptr;
+            NLOHMANN_YAML_TRY {
+                if (root.contains(pointer)) {
+                    found = &root.at(pointer);
+                }
+            } NLOHMANN_YAML_CATCH(const std::exception&) {
+                // e.g. a non-numeric token addressing an array: no such node
+            }
+            node.store(found, std::memory_order_relaxed);
+            resolved_generation.store(document->generation(), std::memory_order_release);
+        }
+
+        const basic_yaml_document<BasicJsonType>* document;
+        pointer_type pointer;
+        mutable std::atomic<const BasicJsonType*> node{nullptr};
+        mutable std::atomic<std::uint64_t> resolved_generation{0};
+    };
+
+    using yaml_path_handle = basic_yaml_path_handle<>;
+
+    /**
+     * Compiles a JSON pointer into a handle that reads the node directly until the document
+     * changes.
+     *
+     * @param document The document the path is resolved in.
+     * @param path A JSON pointer such as "/limits/rps".
+     * @return The path handle.
+     * @throws std::runtime_error If the path is not a valid JSON pointer.
+     */
+    template <typename BasicJsonType>
+    inline basic_yaml_path_handle<BasicJsonType> compile_path(const basic_yaml_document<BasicJsonType>& document,
+                                                              const std::string& path) {
+        return basic_yaml_path_handle<BasicJsonType>(document, path);
+    }
+
+    /**
+     * A byte range [begin, end) of a YAML buffer.
+     */
+    struct yaml_byte_range {
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    /**
+     * Finds the first item boundary of a root sequence at or after a byte offset: the start of a
+     * line with a '-' in column 0 followed by a blank or the end of the line. Continuation lines of
+     * quoted scalars, block scalars and flow collections inside an item are indented deeper than
+     * its dash, so such a line is always the start of an item and can be found without knowing
+     * anything that precedes the offset.
+     *
+     * @param buffer The UTF-8 YAML document.
+     * @param offset The byte offset to start searching at.
+     * @return The offset of the next item boundary, or `buffer.size()` if there is none.
+     */
+    inline std::size_t yaml_next_item_boundary(const std::string_view buffer, std::size_t offset) {
+        if (offset >= buffer.size()) {
+            return buffer.size();
+        }
+        if (offset > 0 && buffer[offset - 1] != '\n') {
+            offset = buffer.find('\n', offset);
+            if (offset == std::string_view::npos) {
+                return buffer.size();
+            }
+            ++offset;
+        }
+
+        while (offset < buffer.size()) {
+            if (buffer[offset] == '-') {
+                const size_t next = offset + 1;
+                if (next == buffer.size() || buffer[next] == ' ' || buffer[next] == '\t' || buffer[next] == '\r'
+                    || buffer[next] == '\n') {
+                    return offset;
+                }
+            }
+            offset = buffer.find('\n', offset);
+            if (offset == std::string_view::npos) {
+                return buffer.size();
+            }
+            ++offset;
+        }
+        return buffer.size();
+    }
+
+    /**
+     * Computes one range of `yaml_partition` on its own, so a worker can find its slice of the input
+     * without a coordinator: only the item boundaries after the two cut points are searched.
+     *
+     * @param buffer The UTF-8 YAML document holding a root sequence.
+     * @param count The number of ranges the buffer is split into.
+     * @param index The range to compute, in [0, count).
+     * @return The byte range; it is empty if a single item spans its whole share of the buffer.
+     * @throws std::runtime_error If `index` is not smaller than `count`.
+     */
+    inline yaml_byte_range yaml_partition_range(const std::string_view buffer, const std::size_t count,
+                                                const std::size_t index) {
+        if (index >= count) {
+            NLOHMANN_YAML_THROW(std::runtime_error("Partition index " + std::to_string(index) + " is out of range"));
+        }
+        const std::size_t share = buffer.size() / count;
+        const std::size_t begin = index == 0 ? 0 : yaml_next_item_boundary(buffer, share * index);
+        const std::size_t end = index + 1 == count ? buffer.size() : yaml_next_item_boundary(buffer, share * (index + 1));
+        return {begin, end};
+    }
+
+    /**
+     * Splits a document holding a root sequence into `count` contiguous byte ranges cut at item
+     * boundaries (see `yaml_next_item_boundary`), each of which `parse_yaml_range` parses on its
+     * own. The first range also holds whatever precedes the first item (comments, blank lines).
+     *
+     * @param buffer The UTF-8 YAML document holding a root sequence.
+     * @param count The number of ranges; ranges are empty where one item spans a whole share.
+     * @return The ranges, in order, covering the whole buffer.
+     * @throws std::runtime_error If `count` is 0.
+     */
+    inline std::vector<yaml_byte_range> yaml_partition(const std::string_view buffer, const std::size_t count) {
+        if (count == 0) {
+            NLOHMANN_YAML_THROW(std::runtime_error("Cannot partition input into 0 ranges"));
+        }
+        std::vector<yaml_byte_range> ranges;
+        ranges.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            ranges.push_back(yaml_partition_range(buffer, count, i));
+        }
+        return ranges;
+    }
+
+    /**
+     * Parses the root sequence items held in one byte range of a document, as returned by
+     * `yaml_partition`. Only the range is indexed and parsed; concatenating the results of all
+     * ranges gives the root sequence of the whole document.
+     *
+     * @param buffer The UTF-8 YAML document holding a root sequence.
+     * @param range The byte range to parse; it must start at an item boundary or at 0.
+     * @param options Options controlling how the items are built.
+     * @return A JSON array holding the items of the range (empty if it only holds comments).
+     * @throws std::runtime_error If the range lies outside the buffer or does not hold sequence items.
+     */
+    inline json parse_yaml_range(const std::string_view buffer, const yaml_byte_range range,
+                                 const yaml_parse_options& options = {}) {
+        if (range.begin > range.end || range.end > buffer.size()) {
+            NLOHMANN_YAML_THROW(std::runtime_error("Byte range is outside the input buffer"));
+        }
+        yaml_parser parser(buffer.substr(range.begin, range.end - range.begin), options);
+        json items = parser.parse();
+        if (items.is_array()) {
+            return items;
+        }
+        if (items.empty()) {
+            return json::array();
+        }
+        NLOHMANN_YAML_THROW(std::runtime_error("Byte range does not hold root sequence items"));
+    }
+
+    /**
+     * Splits a stream into YAML documents. A "---" line starts a document (text after the marker
+     * becomes its first line), a "..." line ends one, and directives ("%YAML") before a document
+     * are skipped. Lines are handed out unparsed, so the reader stays cheap next to the parsers.
+     */
+    class yaml_document_reader {
+        std::istream& input;
+        std::string line;
+        std::string carry;  ///< Text following the "---" marker that started the next document
+        bool open = false;  ///< Whether a "---" marker started the document being read
+
+        static bool is_marker(const std::string& text, const char* marker) {
+            return text.compare(0, 3, marker) == 0
+                && (text.size() == 3 || text[3] == ' ' || text[3] == '\t' || text[3] == '\r');
+        }
+
+    public:
+        explicit yaml_document_reader(std::istream& stream) : input(stream) {}
+
+        /**
+         * Reads the next document.
+         *
+         * @param document Receives the text of the document.
+         * @param has_content Set to whether the document holds anything besides comments and
+         *                    blank lines (an empty document is null).
+         * @return False once the stream holds no further document.
+         */
+        bool next(std::string& document, bool& has_content) {
+            document.clear();
+            has_content = false;
+            const auto append = [&](const std::string& text) {
+                if (!has_content) {
+                    const size_t first = text.find_first_not_of(" \t\r");
+                    has_content = first != std::string::npos && text[first] != '#';
+                }
+                document += text;
+                document += '\n';
+            };
+
+            if (!carry.empty()) {
+                append(carry);
+                carry.clear();
+            }
+            while (std::getline(input, line)) {
+                if (is_marker(line, "---")) {
+                    const size_t rest = line.find_first_not_of(" \t\r", 3);
+                    if (open || has_content) {
+                        carry = rest == std::string::npos ? std::string() : line.substr(rest);
+                        return true; // the marker starts the next document
+                    }
+                    open = true;
+                    if (rest != std::string::npos) {
+                        append(line.substr(rest));
+                    }
+                } else if (is_marker(line, "...")) {
+                    if (open || has_content) {
+                        open = false;
+                        return true;
+                    }
+                } else if (!open && !has_content && !line.empty() && line[0] == '%') {
+                    continue; // directive
+                } else {
+                    append(line);
+                }
+            }
+
+            const bool found = open || has_content;
+            open = false;
+            return found;
+        }
+    };
+
+    /**
+     * Options of the multi-document parse pipeline.
+     */
+    struct yaml_pipeline_options {
+        /// Worker threads parsing documents (0 = `std::thread::hardware_concurrency()`)
+        std::size_t threads = 0;
+
+        /// Documents read but not yet delivered; the reader waits while this many are in flight,
+        /// which bounds memory when the consumer is slower than the parsers (0 = 4 per worker)
+        std::size_t max_in_flight = 0;
+
+        /// Options used to parse every document
+        yaml_parse_options parse;
+    };
+
+    /**
+     * Parses a stream of `---`-separated YAML documents in a pipeline: a reader thread splits the
+     * documents, worker threads parse them, and the calling thread delivers the results in input
+     * order. Results wait in a window of `max_in_flight` slots indexed by document number, so the
+     * reader is held back (backpressure) whenever the oldest undelivered document is still being
+     * parsed or consumed.
+     *
+     * @param input The stream of documents; it is only read by the reader thread.
+     * @param on_document Called on the calling thread with every document (`json&&`), in order.
+     * @param options The pipeline options.
+     * @throws std::runtime_error If a document fails to parse; the documents before it have been
+     *                            delivered. Exceptions thrown by `on_document` are propagated too.
+     *                            With exceptions disabled, such a document is delivered as a
+     *                            discarded value instead.
+     */
+    template <typename Callback>
+    void parse_yaml_stream(std::istream& input, Callback&& on_document, const yaml_pipeline_options& options = {}) {
+        const size_t threads = options.threads != 0 ? options.threads
+                                                    : std::max(1u, std::thread::hardware_concurrency());
+        const size_t window = options.max_in_flight != 0 ? options.max_in_flight : 4 * threads;
+
+        struct job {
+            size_t index;
+            std::string text;
+            bool has_content;
+        };
+        struct slot {
+            json document;
+            std::exception_ptr error;
+            bool ready = false;
+        };
+
+        std::vector<slot> slots(window);
+        std::deque<job> jobs;
+        std::mutex mutex;
+        std::condition_variable job_ready;
+        std::condition_variable slot_ready;
+        std::condition_variable window_free;
+        size_t read_count = 0;
+        size_t delivered = 0;
+        bool reading_done = false;
+        bool stop = false;
+        std::exception_ptr reader_error;
+
+        std::vector<std::thread> pipeline;
+        const auto shutdown = [&] {
+            {
+                const std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            job_ready.notify_all();
+            window_free.notify_all();
+            for (auto& thread : pipeline) {
+                thread.join();
+            }
+        };
+        struct shutdown_guard {
+            const decltype(shutdown)& run;
+            ~shutdown_guard() { run(); }
+        } guard{shutdown};
+
+        pipeline.emplace_back([&] {
+            NLOHMANN_YAML_TRY {
+                yaml_document_reader reader(input);
+                std::string text;
+                bool has_content;
+                while (reader.next(text, has_content)) {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    window_free.wait(lock, [&] { return stop || read_count - delivered < window; });
+                    if (stop) {
+                        return;
+                    }
+                    jobs.push_back({read_count++, std::move(text), has_content});
+                    text = std::string();
+                    lock.unlock();
+                    job_ready.notify_one();
+                }
+            } NLOHMANN_YAML_CATCH(...) {
+                const std::lock_guard<std::mutex> lock(mutex);
+                reader_error = std::current_exception();
+            }
+            {
+                const std::lock_guard<std::mutex> lock(mutex);
+                reading_done = true;
+            }
+            job_ready.notify_all();
+            slot_ready.notify_all();
+        });
+
+        for (size_t i = 0; i < threads; ++i) {
+            pipeline.emplace_back([&] {
+                for (;;) {
+                    job current;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        job_ready.wait(lock, [&] { return stop || reading_done || !jobs.empty(); });
+                        if (stop || jobs.empty()) {
+                            return;
+                        }
+                        current = std::move(jobs.front());
+                        jobs.pop_front();
+                    }
+
+                    slot result;
+                    NLOHMANN_YAML_TRY {
+                        if (current.has_content) {
+                            yaml_parser parser(std::string_view(current.text), options.parse);
+                            result.document = parser.parse();
+                        }
+                    } NLOHMANN_YAML_CATCH(...) {
+                        result.error = std::current_exception();
+                    }
+                    result.ready = true;
+                    {
+                        const std::lock_guard<std::mutex> lock(mutex);
+                        slots[current.index % window] = std::move(result);
+                    }
+                    slot_ready.notify_one();
+                }
+            });
+        }
+
+        for (;;) {
+            json document;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                slot& next = slots[delivered % window];
+                slot_ready.wait(lock, [&] { return next.ready || (reading_done && delivered == read_count); });
+                if (!next.ready) {
+                    if (reader_error) {
+                        std::rethrow_exception(reader_error);
+                    }
+                    break;
+                }
+                next.ready = false;
+                if (next.error) {
+                    std::rethrow_exception(next.error);
+                }
+                document = std::move(next.document);
+                ++delivered;
+            }
+            window_free.notify_one();
+            on_document(std::move(document));
+        }
+    }
+
+    /**
+     * Parses every document of a `---`-separated stream with `parse_yaml_stream`.
+     *
+     * @param input The stream of documents.
+     * @param options The pipeline options.
+     * @return The documents, in input order.
+     * @throws std::runtime_error If a document fails to parse.
+     */
+    inline std::vector<json> parse_yaml_documents(std::istream& input, const yaml_pipeline_options& options = {}) {
+        std::vector<json> documents;
+        parse_yaml_stream(input, [&](json&& document) { documents.push_back(std::move(document)); }, options);
+        return documents;
+    }
+
+    /**
+     * Reads a document whose root is a mapping one root entry at a time. Each entry (its key line
+     * and the indented lines below it) is read, parsed on its own and handed out as a
+     * `std::pair<std::string, json>`; only the current entry is held in memory, so a mapping with
+     * millions of keys is processed in memory bounded by its largest entry:
+     *
+     *     for (auto&& [key, value] : nlohmann::yaml_mapping_stream(input)) { ... }
+     *
+     * Entries are yielded in input order; a repeated key is yielded once per occurrence. Lines that
+     * parse to several root keys (`config: {` followed by indented JSON members, which this parser
+     * reads as keys) yield each of them. Aliases
+     * resolve against the anchors of earlier entries, which are kept for the whole stream.
+     */
+    class yaml_mapping_stream {
+    public:
+        using value_type = std::pair<std::string, json>;
+
+        /**
+         * Input iterator over the root entries; advancing it reads and parses the next entry.
+         */
+        class iterator {
+            yaml_mapping_stream* stream = nullptr;
+
+            explicit iterator(yaml_mapping_stream* owner) : stream(owner) {}
+            friend class yaml_mapping_stream;
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = yaml_mapping_stream::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = value_type*;
+            using reference = value_type&;
+
+            iterator() = default;
+
+            reference operator*() const { return stream->entry; }
+            pointer operator->() const { return &stream->entry; }
+
+            iterator& operator++() {
+                if (!stream->advance()) {
+                    stream = nullptr;
+                }
+                return *this;
+            }
+
+            bool operator==(const iterator& other) const { return stream == other.stream; }
+            bool operator!=(const iterator& other) const { return stream != other.stream; }
+        };
+
+        /**
+         * Creates a stream over the root entries of a document; nothing is read until `begin()`.
+         *
+         * @param is The input stream; it must outlive the mapping stream.
+         * @param parse_options Options used to parse every entry.
+         */
+        explicit yaml_mapping_stream(std::istream& is, const yaml_parse_options& parse_options = {})
+            : input(is), options(parse_options) {}
+
+        /**
+         * Reads the first entry. The stream can only be iterated once.
+         *
+         * @throws std::runtime_error If the first entry is malformed or the root is not a mapping.
+         */
+        iterator begin() {
+            if (!started) {
+                started = true;
+                return iterator(advance() ? this : nullptr);
+            }
+            return iterator(has_entry ? this : nullptr);
+        }
+
+        iterator end() { return iterator(); }
+
+    private:
+        std::istream& input;
+        yaml_parse_options options;
+        std::string line;
+        std::string text;          ///< Lines of the entry being parsed; reused between entries
+        bool has_pending = false;  ///< Whether `line` holds the first line of the next entry
+        bool started = false;
+        bool has_entry = false;
+        value_type entry;
+        yaml_parser::anchor_table anchors;     ///< Anchors defined by earlier entries
+        json pending;                          ///< Keys of the last parsed entry not yielded yet
+        std::vector<std::string> pending_keys; ///< Root keys of the last parsed entry, in input order
+        size_t next_key = 0;                   ///< Next index in `pending_keys`
+
+        /**
+         * Checks whether a line starts a root entry: it has content in column 0 and is not a
+         * comment, directive or document marker.
+         */
+        static bool starts_entry(const std::string& text) {
+            if (text.empty() || text[0] == ' ' || text[0] == '\t' || text[0] == '\r' || text[0] == '#'
+                || text[0] == '%') {
+                return false;
+            }
+            return text.compare(0, 3, "---") != 0 && text.compare(0, 3, "...") != 0;
+        }
+
+        /**
+         * Reads and parses the next root entry into `entry`.
+         *
+         * @return False at the end of the input.
+         * @throws std::runtime_error If the entry is malformed or the root is not a mapping.
+         */
+        bool advance() {
+            if (take_pending()) {
+                return true;
+            }
+            for (;;) {
+                while (!has_pending && std::getline(input, line)) {
+                    has_pending = starts_entry(line);
+                }
+                if (!has_pending) {
+                    has_entry = false;
+                    return false;
+                }
+
+                // The entry runs up to the next line with content in column 0
+                text.assign(line).push_back('\n');
+                has_pending = false;
+                while (std::getline(input, line)) {
+                    if (starts_entry(line)) {
+                        has_pending = true;
+                        break;
+                    }
+                    text.append(line).push_back('\n');
+                }
+
+                yaml_parser parser(std::string_view(text), options);
+                pending = parser.parse(anchors, &pending_keys);
+                if (!pending.is_object()) {
+                    NLOHMANN_YAML_THROW(std::runtime_error("Root of the document is not a mapping"));
+                }
+                next_key = 0;
+                if (take_pending()) {
+                    return true;
+                }
+                // No keys: a column-0 line that is not an entry, skipped like in parse()
+            }
+        }
+
+        /**
+         * Moves the next key of the last parsed entry into `entry`. An entry's lines usually hold
+         * one root key, but can hold several (e.g. after an unterminated flow mapping); they are
+         * yielded in input order, a key repeated within the entry once with its final value.
+         *
+         * @return False once all keys of the entry are yielded.
+         */
+        bool take_pending() {
+            while (next_key < pending_keys.size()) {
+                std::string& key = pending_keys[next_key++];
+                const auto found = pending.find(key);
+                if (found == pending.end()) {
+                    continue; // repeated key, already yielded
+                }
+                entry.second = std::move(*found);
+                pending.erase(found);
+                entry.first = std::move(key);
+                has_entry = true;
+                return true;
+            }
+            return false;
+        }
+    };
+
+    /**
+     * Seeded 64-bit hash of a byte string. Input is read 8 bytes at a time in little-endian order,
+     * so hashes (and the frozen map images built on them) do not depend on the host.
+     *
+     * @param text The bytes to hash.
+     * @param seed The seed; different seeds give independent hash functions.
+     * @return The hash value.
+     */
+    inline std::uint64_t yaml_hash64(const std::string_view text, const std::uint64_t seed) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(text.data());
+        const auto load = [&](const size_t at, const size_t count) {
+            std::uint64_t word = 0;
+            for (size_t i = count; i > 0; --i) {
+                word = (word << 8) | bytes[at + i - 1];
+            }
+            return word;
+        };
+        const auto mix = [](std::uint64_t h) {
+            h *= 0x9fb21c651e98df25ULL;
+            return h ^ (h >> 29);
+        };
+
+        std::uint64_t h = seed ^ (0x9e3779b97f4a7c15ULL * (text.size() + 1));
+        size_t i = 0;
+        for (; i + 8 <= text.size(); i += 8) {
+            h = mix(h ^ load(i, 8));
+        }
+        h = mix(h ^ load(i, text.size() - i) ^ (std::uint64_t{text.size() - i} << 56));
+
+        // splitmix64 finalizer
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        return h ^ (h >> 31);
+    }
+
+    /**
+     * Immutable string-to-scalar table with a minimal perfect hash (CHD: hash, displace and
+     * compress). Keys are hashed into buckets of about 4 keys; each bucket stores a displacement
+     * pair (d0, d1) that sends its keys to free slots `(f1 + d0 * f2 + d1) % n` of an n-slot
+     * entry table, so a lookup reads one displacement pair, one 16-byte entry and the key bytes,
+     * with no probing.
+     *
+     * The whole table is one contiguous little-endian image: a 32-byte header, the displacement
+     * pairs, the entries (key offset/size, value offset/size) and the key and value arenas. The
+     * image can be written to a file as is and used again through `from_bytes` without copying,
+     * e.g. from a memory-mapped file.
+     *
+     * Values are kept as text: strings as their contents, other scalars (numbers, booleans, null)
+     * as JSON text; `value` restores the typed scalar.
+     */
+    class yaml_frozen_map {
+        static constexpr char magic[4] = {'Y', 'F', 'M', '1'};
+        static constexpr size_t header_size = 32;
+        static constexpr size_t entry_size = 16;
+        static constexpr std::uint32_t json_text_flag = 0x80000000u;
+
+        std::shared_ptr<const std::string> storage; ///< Owned image, when the map was built rather than viewed
+        std::string_view image;
+
+        std::uint32_t count = 0;
+        std::uint32_t buckets = 0;
+        std::uint64_t seed = 0;
+        const char* displacements = nullptr;
+        const char* entries = nullptr;
+        const char* keys = nullptr;
+        const char* values = nullptr;
+
+        static std::uint32_t load32(const char* at) {
+            const auto* bytes = reinterpret_cast<const unsigned char*>(at);
+            return std::uint32_t{bytes[0]} | (std::uint32_t{bytes[1]} << 8) | (std::uint32_t{bytes[2]} << 16)
+                | (std::uint32_t{bytes[3]} << 24);
+        }
+
+        static void store32(char* at, const std::uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                at[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+            }
+        }
+
+        /// Slot of a key hash, given its bucket's displacement pair
+        static std::uint32_t slot_of(const std::uint64_t hash, const std::uint32_t d0, const std::uint32_t d1,
+                                     const std::uint32_t slots) {
+            const std::uint64_t f1 = (hash >> 32) % slots;
+            const std::uint64_t f2 = (hash & 0xffffffffu) % slots;
+            return static_cast<std::uint32_t>((f1 + std::uint64_t{d0} * f2 + d1) % slots);
+        }
+
+        /// Sets up the section pointers from `image`, validating its layout
+        void attach() {
+            if (image.size() < header_size || image.compare(0, 4, std::string_view(magic, 4)) != 0) {
+                NLOHMANN_YAML_THROW(std::runtime_error("Invalid frozen map image"));
+            }
+            const char* base = image.data();
+            count = load32(base + 4);
+            buckets = load32(base + 8);
+            const std::uint64_t key_bytes = load32(base + 12);
+            const std::uint64_t value_bytes = load32(base + 16);
+            seed = std::uint64_t{load32(base + 24)} | (std::uint64_t{load32(base + 28)} << 32);
+
+            const std::uint64_t expected = header_size + std::uint64_t{buckets} * 8
+                + std::uint64_t{count} * entry_size + key_bytes + value_bytes;
+            if (expected != image.size() || (count != 0 && buckets == 0)) {
+                NLOHMANN_YAML_THROW(std::runtime_error("Invalid frozen map image"));
+            }
+            displacements = base + header_size;
+            entries = displacements + size_t{buckets} * 8;
+            keys = entries + size_t{count} * entry_size;
+            values = keys + key_bytes;
+
+            for (std::uint32_t i = 0; i < count; ++i) {
+                const char* entry = entries + size_t{i} * entry_size;
+                if (std::uint64_t{load32(entry)} + load32(entry + 4) > key_bytes
+                    || std::uint64_t{load32(entry + 8)} + (load32(entry + 12) & ~json_text_flag) > value_bytes) {
+                    NLOHMANN_YAML_THROW(std::runtime_error("Invalid frozen map image"));
+                }
+            }
+        }
+
+        /// Finds the entry of a key, or nullptr
+        const char* find_entry(const std::string_view key) const {
+            if (count == 0) {
+                return nullptr;
+            }
+            const std::uint64_t hash = yaml_hash64(key, seed);
+            const char* pair = displacements + size_t{hash % buckets} * 8;
+            const char* entry = entries + size_t{slot_of(hash, load32(pair), load32(pair + 4), count)} * entry_size;
+            if (load32(entry + 4) != key.size() || std::memcmp(keys + load32(entry), key.data(), key.size()) != 0) {
+                return nullptr;
+            }
+            return entry;
+        }
+
+    public:
+        /**
+         * Accumulates keys and scalar values into contiguous arenas and builds the table.
+         */
+        class builder {
+            struct record {
+                std::uint32_t key_offset;
+                std::uint32_t key_size;
+                std::uint32_t value_offset;
+                std::uint32_t value_size; ///< With `json_text_flag` for non-string scalars
+            };
+
+            std::string key_arena;
+            std::string value_arena;
+            std::vector<record> records;
+
+            static std::uint32_t checked_size(const size_t size) {
+                if (size >= json_text_flag) {
+                    NLOHMANN_YAML_THROW(std::runtime_error("Frozen map arenas are limited to 2 GiB"));
+                }
+                return static_cast<std::uint32_t>(size);
+            }
+
+        public:
+            /**
+             * Adds an entry; a repeated key replaces the earlier value, as in `parse_yaml`.
+             *
+             * @param key The key.
+             * @param value A scalar (string, number, boolean or null).
+             * @throws std::runtime_error If the value is not a scalar or the arenas grow past 2 GiB.
+             */
+            void add(const std::string_view key, const json& value) {
+                if (value.is_structured() || value.is_binary()) {
+                    NLOHMANN_YAML_THROW(std::runtime_error("Frozen map values must be scalars"));
+                }
+                record entry{};
+                entry.key_offset = checked_size(key_arena.size());
+                entry.key_size = static_cast<std::uint32_t>(key.size());
+                key_arena.append(key);
+                entry.value_offset = checked_size(value_arena.size());
+                if (value.is_string()) {
+                    value_arena += value.get_ref<const std::string&>();
+                    entry.value_size = checked_size(value_arena.size()) - entry.value_offset;
+                } else {
+                    value_arena += value.dump();
+                    entry.value_size = (checked_size(value_arena.size()) - entry.value_offset) | json_text_flag;
+                }
+                checked_size(key_arena.size());
+                records.push_back(entry);
+            }
+
+            /**
+             * Builds the table. Seeds are retried until every bucket finds a displacement, which
+             * takes a single attempt in practice.
+             *
+             * @return The frozen map, owning its image.
+             */
+            yaml_frozen_map build() const {
+                const auto key_of = [&](const record& entry) {
+                    return std::string_view(key_arena).substr(entry.key_offset, entry.key_size);
+                };
+
+                // Keep the last occurrence of every key
+                std::vector<std::uint32_t> order(records.size());
+                std::vector<std::uint64_t> hashes(records.size());
+                for (std::uint32_t i = 0; i < records.size(); ++i) {
+                    order[i] = i;
+                    hashes[i] = yaml_hash64(key_of(records[i]), 0);
+                }
+                std::sort(order.begin(), order.end(), [&](const std::uint32_t a, const std::uint32_t b) {
+                    if (hashes[a] != hashes[b]) {
+                        return hashes[a] < hashes[b];
+                    }
+                    const int compared = key_of(records[a]).compare(key_of(records[b]));
+                    return compared != 0 ? compared < 0 : a > b;
+                });
+                std::vector<std::uint32_t> unique;
+                unique.reserve(order.size());
+                for (size_t i = 0; i < order.size(); ++i) {
+                    if (i == 0 || key_of(records[order[i]]) != key_of(records[order[i - 1]])) {
+                        unique.push_back(order[i]);
+                    }
+                }
+
+                const auto count = static_cast<std::uint32_t>(unique.size());
+                const std::uint32_t bucket_count = std::max<std::uint32_t>(1, (count + 3) / 4);
+                std::vector<std::uint32_t> pairs(size_t{bucket_count} * 2);
+                std::vector<std::uint32_t> slot_record(count);
+
+                for (std::uint64_t seed = 0; count != 0; ++seed) {
+                    if (place(unique, seed, bucket_count, key_of, pairs, slot_record)) {
+                        return assemble(seed, bucket_count, pairs, slot_record);
+                    }
+                }
+                return assemble(0, bucket_count, pairs, slot_record);
+            }
+
+        private:
+            /// Finds a displacement pair for every bucket, largest buckets first
+            template <typename KeyOf>
+            bool place(const std::vector<std::uint32_t>& unique, const std::uint64_t seed,
+                       const std::uint32_t bucket_count, const KeyOf& key_of, std::vector<std::uint32_t>& pairs,
+                       std::vector<std::uint32_t>& slot_record) const {
+                const auto count = static_cast<std::uint32_t>(unique.size());
+                std::vector<std::uint32_t> f1(count);
+                std::vector<std::uint32_t> f2(count);
+                std::vector<std::vector<std::uint32_t>> members(bucket_count);
+                for (std::uint32_t i = 0; i < count; ++i) {
+                    const std::uint64_t hash = yaml_hash64(key_of(records[unique[i]]), seed);
+                    f1[i] = static_cast<std::uint32_t>((hash >> 32) % count);
+                    f2[i] = static_cast<std::uint32_t>((hash & 0xffffffffu) % count);
+                    members[hash % bucket_count].push_back(i);
+                }
+                std::vector<std::uint32_t> by_size(bucket_count);
+                for (std::uint32_t b = 0; b < bucket_count; ++b) {
+                    by_size[b] = b;
+                }
+                std::stable_sort(by_size.begin(), by_size.end(), [&](const std::uint32_t a, const std::uint32_t b) {
+                    return members[a].size() > members[b].size();
+                });
+
+                std::vector<bool> taken(count);
+                std::vector<std::uint32_t> bases;
+                std::vector<std::uint32_t> slots;
+                // A bucket that needs more tries than this restarts the build with a new seed
+                const std::uint64_t budget = std::uint64_t{count} * 64 + (1u << 20);
+                for (const std::uint32_t bucket : by_size) {
+                    const auto& keys_in_bucket = members[bucket];
+                    if (keys_in_bucket.empty()) {
+                        break;
+                    }
+                    bool placed = false;
+                    std::uint64_t tries = 0;
+                    for (std::uint32_t d0 = 0; d0 < count && !placed && tries < budget; ++d0) {
+                        // Slots for d1 = 0; every further d1 moves all keys of the bucket one slot on
+                        bases.clear();
+                        for (const std::uint32_t key : keys_in_bucket) {
+                            bases.push_back(static_cast<std::uint32_t>((f1[key] + std::uint64_t{d0} * f2[key]) % count));
+                        }
+                        for (std::uint32_t d1 = 0; d1 < count && tries < budget; ++d1, ++tries) {
+                            slots.clear();
+                            for (const std::uint32_t base : bases) {
+                                std::uint32_t slot = base + d1;
+                                if (slot >= count) {
+                                    slot -= count;
+                                }
+                                if (taken[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                                    break;
+                                }
+                                slots.push_back(slot);
+                            }
+                            if (slots.size() == keys_in_bucket.size()) {
+                                for (size_t k = 0; k < slots.size(); ++k) {
+                                    taken[slots[k]] = true;
+                                    slot_record[slots[k]] = unique[keys_in_bucket[k]];
+                                }
+                                pairs[size_t{bucket} * 2] = d0;
+                                pairs[size_t{bucket} * 2 + 1] = d1;
+                                placed = true;
+                                break;
+                            }
+                        }
+                    }
+                    if (!placed) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            /// Writes the image, with entries and arenas in slot order
+            yaml_frozen_map assemble(const std::uint64_t seed, const std::uint32_t bucket_count,
+                                     const std::vector<std::uint32_t>& pairs,
+                                     const std::vector<std::uint32_t>& slot_record) const {
+                const auto count = static_cast<std::uint32_t>(slot_record.size());
+                size_t key_bytes = 0;
+                size_t value_bytes = 0;
+                for (const std::uint32_t index : slot_record) {
+                    key_bytes += records[index].key_size;
+                    value_bytes += records[index].value_size & ~json_text_flag;
+                }
+
+                std::string out;
+                out.assign(header_size + size_t{bucket_count} * 8 + size_t{count} * entry_size + key_bytes + value_bytes, '\0');
+                char* base = out.data();
+                std::memcpy(base, magic, 4);
+                store32(base + 4, count);
+                store32(base + 8, bucket_count);
+                store32(base + 12, checked_size(key_bytes));
+                store32(base + 16, checked_size(value_bytes));
+                store32(base + 24, static_cast<std::uint32_t>(seed));
+                store32(base + 28, static_cast<std::uint32_t>(seed >> 32));
+
+                char* pair = base + header_size;
+                for (const std::uint32_t displacement : pairs) {
+                    store32(pair, displacement);
+                    pair += 4;
+                }
+
+                char* entry = base + header_size + size_t{bucket_count} * 8;
+                char* key_out = entry + size_t{count} * entry_size;
+                char* value_out = key_out + key_bytes;
+                std::uint32_t key_offset = 0;
+                std::uint32_t value_offset = 0;
+                for (const std::uint32_t index : slot_record) {
+                    const record& source = records[index];
+                    const std::uint32_t value_size = source.value_size & ~json_text_flag;
+                    store32(entry, key_offset);
+                    store32(entry + 4, source.key_size);
+                    store32(entry + 8, value_offset);
+                    store32(entry + 12, source.value_size);
+                    std::memcpy(key_out + key_offset, key_arena.data() + source.key_offset, source.key_size);
+                    std::memcpy(value_out + value_offset, value_arena.data() + source.value_offset, value_size);
+                    key_offset += source.key_size;
+                    value_offset += value_size;
+                    entry += entry_size;
+                }
+
+                yaml_frozen_map map;
+                map.storage = std::make_shared<const std::string>(std::move(out));
+                map.image = *map.storage;
+                map.attach();
+                return map;
+            }
+        };
+
+        yaml_frozen_map() = default;
+
+        /**
+         * Uses a serialized image (see `bytes`) in place, without copying it.
+         *
+         * @param bytes The image; it must stay valid and unchanged while the map is used.
+         * @return A map viewing the image.
+         * @throws std::runtime_error If the image is malformed.
+         */
+        static yaml_frozen_map from_bytes(const std::string_view bytes) {
+            yaml_frozen_map map;
+            map.image = bytes;
+            map.attach();
+            return map;
+        }
+
+        /**
+         * The serialized image, suitable for writing to a file and reading back with `from_bytes`.
+         */
+        [[nodiscard]] std::string_view bytes() const {
+            return image;
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            return count;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return count == 0;
+        }
+
+        [[nodiscard]] bool contains(const std::string_view key) const {
+            return find_entry(key) != nullptr;
+        }
+
+        /**
+         * Looks up the text of a value: a string's contents, or the JSON text of another scalar.
+         *
+         * @param key The key to look up.
+         * @return The value text, pointing into the image, or std::nullopt if the key is absent.
+         */
+        [[nodiscard]] std::optional<std::string_view> find(const std::string_view key) const {
+            const char* entry = find_entry(key);
+            if (entry == nullptr) {
+                return std::nullopt;
+            }
+            return std::string_view(values + load32(entry + 8), load32(entry + 12) & ~json_text_flag);
+        }
+
+        /**
+         * Looks up a value as a typed JSON scalar.
+         *
+         * @param key The key to look up.
+         * @return The scalar value.
+         * @throws std::runtime_error If the key is absent.
+         */
+        [[nodiscard]] json value(const std::string_view key) const {
+            const char* entry = find_entry(key);
+            if (entry == nullptr) {
+                NLOHMANN_YAML_THROW(std::runtime_error("Key '" + std::string(key) + "' not found in frozen map"));
+            }
+            const std::uint32_t size = load32(entry + 12);
+            const std::string_view text(values + load32(entry + 8), size & ~json_text_flag);
+            return (size & json_text_flag) != 0 ? json::parse(text) : json(std::string(text));
+        }
+    };
+
+    /**
+     * Parses a flat mapping of scalars straight into a `yaml_frozen_map`, without building a
+     * document: the parser's line index is walked once and each typed scalar goes directly into
+     * the table's arenas.
+     *
+     * @param input The stream containing the YAML mapping.
+     * @param options Options controlling how the input is read and typed.
+     * @return The frozen map.
+     * @throws std::runtime_error If the root is not a flat mapping of scalars.
+     */
+    inline yaml_frozen_map build_frozen_map(std::istream& input, const yaml_parse_options& options = {}) {
+        yaml_parser parser(input, options);
+        yaml_frozen_map::builder builder;
+        parser.visit_flat_mapping([&](const std::string& key, json&& value) { builder.add(key, value); });
+        if (parser.failed()) {
+            NLOHMANN_YAML_THROW(std::runtime_error(parser.error()));
+        }
+        return builder.build();
+    }
+
+    /**
+     * Parses a flat mapping of scalars held in a string into a `yaml_frozen_map`.
+     *
+     * @param input The YAML mapping.
+     * @param options Options controlling how the input is read and typed.
+     * @return The frozen map.
+     * @throws std::runtime_error If the root is not a flat mapping of scalars.
+     */
+    inline yaml_frozen_map build_frozen_map(const std::string& input, const yaml_parse_options& options = {}) {
+        yaml_parser parser(std::string_view(input), options);
+        yaml_frozen_map::builder builder;
+        parser.visit_flat_mapping([&](const std::string& key, json&& value) { builder.add(key, value); });
+        if (parser.failed()) {
+            NLOHMANN_YAML_THROW(std::runtime_error(parser.error()));
+        }
+        return builder.build();
+    }
+
+    /**
+     * 64-bit FNV-1a hash of a key, usable in constant expressions. Code generated by `yaml2cpp`
+     * dispatches on it with a `switch`, so a key is hashed once and compared once.
+     *
+     * @param key The key.
+     * @return The hash value.
+     */
+    constexpr std::uint64_t yaml_key_hash(const std::string_view key) {
+        std::uint64_t hash = 0xcbf29ce484222325ULL;
+        for (const char c : key) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    /**
+     * Pull reader over the block structure of a document, used by the parsers `yaml2cpp`
+     * generates for a known schema. It reuses the parser's line index (encodings, comments,
+     * indentation, multi-line scalars) but builds no DOM: the generated code asks for the keys and
+     * items it expects and converts scalars straight into typed struct members.
+     */
+    class yaml_struct_reader {
+        yaml_parser parser;
+        size_t inline_column = std::string::npos; ///< Column of a mapping that starts on a "- " line
+        size_t key_line = 0;                      ///< Line of the key last read by `next_key`
+        std::string folded;                       ///< Storage of the last multi-line scalar
+        std::string unquoted_key;                 ///< Storage of the last quoted key, unescaped
+
+        static std::string_view trim(std::string_view text) {
+            const size_t first = text.find_first_not_of(" \t");
+            if (first == std::string_view::npos) {
+                return {};
+            }
+            return text.substr(first, text.find_last_not_of(" \t") - first + 1);
+        }
+
+        [[noreturn]] void fail(const std::string& message) const {
+            NLOHMANN_YAML_THROW(std::runtime_error(message + " at line " + std::to_string(parser.current_line)));
+        }
+
+        /// Whether a plain scalar is null, which leaves a member at its default like `from_json` does
+        static bool is_null(const std::string_view text) {
+            return text == "null" || text == "~" || text == "Null" || text == "NULL";
+        }
+
+        /**
+         * Types an inline value the way `parse_yaml` types it, for the forms the specialized readers
+         * do not handle themselves (flow mappings and sequences, other number notations).
+         */
+        json typed(const std::string_view text) {
+            json value = parser.type_scalar(std::string(text));
+            if (parser.failed()) {
+                fail(parser.error());
+            }
+            return value;
+        }
+
+        /// Converts a scalar that is not a plain decimal like `get<T>()` converts the typed value
+        template <typename Number>
+        void read_typed_number(const std::string_view text, Number& out, const char* expected) {
+            const json value = typed(text);
+            if (value.is_number() || value.is_boolean()) {
+                out = value.template get<Number>();
+            } else if (!value.is_null()) {
+                NLOHMANN_YAML_THROW(std::runtime_error(std::string("Expected ") + expected + ", got '"
+                                                       + std::string(text) + "'"));
+            }
+        }
+
+        /// Rejects a value that defines an anchor: aliases to it could not be resolved, since values
+        /// are converted as they are read
+        void reject_anchor(const std::string_view value) const {
+            if (value.size() > 1 && value[0] == '&') {
+                fail("Anchors are not supported by generated parsers");
+            }
+        }
+
+        /// Skips empty lines and returns the indentation of the next line, or -1 at the end
+        int next_indent() {
+            while (parser.current_line < parser.lines.size() && parser.lines[parser.current_line].empty()) {
+                ++parser.current_line;
+            }
+            return parser.current_line < parser.lines.size() ? parser.indents[parser.current_line] : -1;
+        }
+
+        /// Folds a scalar continuing on the following lines; the current line is the one after it
+        std::string_view fold(const std::string_view value, const int min_indent) {
+            const bool quoted = !value.empty() && (value[0] == '"' || value[0] == '\'');
+            size_t next = parser.current_line;
+            while (next < parser.lines.size() && parser.lines[next].empty()) {
+                ++next;
+            }
+            if (!quoted && (next == parser.lines.size() || parser.indents[next] < min_indent)) {
+                return value;
+            }
+            folded = parser.fold_continuation(std::string(value), min_indent);
+            return folded;
+        }
+
+    public:
+        /**
+         * Indexes a document held in memory.
+         *
+         * @param text The YAML document.
+         */
+        explicit yaml_struct_reader(const std::string_view text) : parser(text) {}
+
+        /**
+         * Reads and indexes a document from a stream.
+         *
+         * @param input The stream containing the YAML document.
+         */
+        explicit yaml_struct_reader(std::istream& input) : parser(input) {}
+
+        /**
+         * Reads the next entry of the block mapping at `indent`.
+         *
+         * @param indent The indentation of the mapping's keys.
+         * @param key Receives the key, unquoted and with its escapes resolved; valid until the next call.
+         * @param value Receives the inline value (empty if the value is a nested block); valid until
+         *              the next call.
+         * @return False once the mapping ends.
+         * @throws std::runtime_error If a line of the mapping is not a key.
+         */
+        bool next_key(const int indent, std::string_view& key, std::string_view& value) {
+            size_t start = static_cast<size_t>(indent);
+            std::string_view text;
+            if (inline_column != std::string::npos) {
+                // First key of a mapping written on its sequence item's "- " line
+                start = inline_column;
+                text = std::string_view(parser.lines[parser.current_line]).substr(start);
+                inline_column = std::string::npos;
+            } else {
+                const int line_indent = next_indent();
+                if (line_indent < indent) {
+                    return false;
+                }
+                if (line_indent > indent) {
+                    fail("Unexpected indentation");
+                }
+                text = std::string_view(parser.lines[parser.current_line]).substr(start);
+                if (text[0] == '-' && (text.size() == 1 || text[1] == ' ')) {
+                    return false; // a sequence item ends the mapping
+                }
+            }
+
+            size_t colon = text.find(':');
+            if (!text.empty() && (text[0] == '"' || text[0] == '\'')) {
+                const size_t close = yaml_parser::find_closing_quote(parser.lines[parser.current_line], start);
+                colon = close == std::string::npos ? close : text.find(':', close - start);
+            }
+            while (colon != std::string_view::npos && colon + 1 < text.size() && text[colon + 1] != ' '
+                   && text[colon + 1] != '\t') {
+                colon = text.find(':', colon + 1);
+            }
+            if (colon == std::string_view::npos) {
+                fail("Expected a mapping key");
+            }
+            key_line = parser.current_line++;
+
+            key = trim(text.substr(0, colon));
+            if (!key.empty() && (key[0] == '"' || key[0] == '\'')) {
+                unquoted_key.assign(key);
+                yaml_parser::unquote_key(unquoted_key);
+                key = unquoted_key;
+            }
+            value = fold(trim(text.substr(colon + 1)), indent + 1);
+            reject_anchor(value);
+            return true;
+        }
+
+        /**
+         * Skips the nested lines of a value that the schema does not know, in O(1) for keys that start
+         * their line by jumping to the end of the key line's block.
+         *
+         * @param indent The indentation of the value's key.
+         */
+        void skip_value(const int indent) {
+            if (parser.indents[key_line] == indent) {
+                // The value is the block the key line opens
+                parser.current_line = std::max(parser.current_line, parser.block_end(key_line));
+                return;
+            }
+            // First key of a "- key:" item: that line opens the whole item, so jump over the
+            // value's top-level lines one block at a time
+            while (next_indent() > indent) {
+                parser.current_line = parser.block_end(parser.current_line);
+            }
+        }
+
+        /**
+         * Reads a nested mapping: `read_block(child_indent)` is called for a block below the key;
+         * an absent block, `{}` or null leaves the target untouched.
+         *
+         * @param indent The indentation of the key holding the mapping.
+         * @param value The inline value of that key.
+         * @param read_block Reads the mapping's entries at the given indentation.
+         * @throws std::runtime_error If the key holds a scalar.
+         */
+        template <typename BlockReader>
+        void read_mapping(const int indent, const std::string_view value, BlockReader&& read_block) {
+            if (!value.empty()) {
+                if (value != "{}" && !is_null(value)) {
+                    fail("Expected a nested mapping");
+                }
+                return;
+            }
+            if (const int child = next_indent(); child > indent) {
+                read_block(child);
+            }
+        }
+
+        /**
+         * Reads a nested mapping like `read_mapping(indent, value, read_block)`, and also converts an
+         * inline flow mapping (`{"host": "h"}`) into the target with its `from_json`.
+         *
+         * @param indent The indentation of the key holding the mapping.
+         * @param value The inline value of that key.
+         * @param target The member holding the mapping.
+         * @param read_block Reads the mapping's entries at the given indentation.
+         * @throws std::runtime_error If the key holds a scalar.
+         */
+        template <typename T, typename BlockReader>
+        void read_mapping(const int indent, const std::string_view value, T& target, BlockReader&& read_block) {
+            if (value.size() > 2 && value.front() == '{') {
+                if (const json mapping = typed(value); mapping.is_object()) {
+                    mapping.get_to(target);
+                    return;
+                }
+            }
+            read_mapping(indent, value, std::forward<BlockReader>(read_block));
+        }
+
+        /**
+         * Reads a sequence of scalars, either as "- item" lines below the key or as an inline flow
+         * sequence (`[a, b]`).
+         *
+         * @param indent The indentation of the key holding the sequence.
+         * @param value The inline value of that key; null reads no items.
+         * @param read_item Called with the text of every item.
+         * @throws std::runtime_error If the value is not a sequence.
+         */
+        template <typename ItemReader>
+        void read_sequence(const int indent, const std::string_view value, ItemReader&& read_item) {
+            if (is_null(value)) {
+                return;
+            }
+            if (!value.empty()) {
+                if (value.size() < 2 || value.front() != '[' || value.back() != ']') {
+                    fail("Expected a sequence");
+                }
+                const std::string_view items = value.substr(1, value.size() - 2);
+                char quote = '\0';
+                size_t start = 0;
+                for (size_t i = 0; i <= items.size(); ++i) {
+                    if (i < items.size() && quote != '\0') {
+                        if (items[i] == '\\' && quote == '"') {
+                            ++i;
+                        } else if (items[i] == quote) {
+                            quote = '\0';
+                        }
+                    } else if (i < items.size() && (items[i] == '"' || items[i] == '\'')) {
+                        quote = items[i];
+                    } else if (i == items.size() || items[i] == ',') {
+                        if (const std::string_view item = trim(items.substr(start, i - start)); !item.empty()) {
+                            read_item(item);
+                        }
+                        start = i + 1;
+                    }
+                }
+                return;
+            }
+
+            const int child = next_indent();
+            if (child <= indent) {
+                return;
+            }
+            while (next_indent() == child) {
+                const std::string_view text = std::string_view(parser.lines[parser.current_line]).substr(static_cast<size_t>(child));
+                if (text[0] != '-' || (text.size() > 1 && text[1] != ' ')) {
+                    fail("Expected a sequence item");
+                }
+                ++parser.current_line;
+                const std::string_view item = fold(trim(text.substr(1)), child + 1);
+                reject_anchor(item);
+                read_item(item);
+            }
+        }
+
+        /**
+         * Reads a sequence of mappings written as "- key: value" items below the key.
+         *
+         * @param indent The indentation of the key holding the sequence.
+         * @param value The inline value of that key (only `[]` and null are accepted).
+         * @param read_item Called with the indentation of every item's keys.
+         * @throws std::runtime_error If the value is not a block sequence.
+         */
+        template <typename ItemReader>
+        void read_mapping_sequence(const int indent, const std::string_view value, ItemReader&& read_item) {
+            if (!value.empty()) {
+                if (value != "[]" && !is_null(value)) {
+                    fail("Expected a sequence of mappings");
+                }
+                return;
+            }
+
+            const int child = next_indent();
+            if (child <= indent) {
+                return;
+            }
+            while (next_indent() == child) {
+                const std::string& line = parser.lines[parser.current_line];
+                if (line[static_cast<size_t>(child)] != '-') {
+                    fail("Expected a sequence item");
+                }
+                const size_t content = line.find_first_not_of(" \t", static_cast<size_t>(child) + 1);
+                if (content == std::string::npos) {
+                    // "-" alone: the mapping starts on the next line
+                    ++parser.current_line;
+                    if (const int item_indent = next_indent(); item_indent > child) {
+                        read_item(item_indent);
+                    } else {
+                        read_item(std::numeric_limits<int>::max()); // empty item
+                    }
+                } else {
+                    reject_anchor(std::string_view(line).substr(content));
+                    inline_column = content;
+                    read_item(static_cast<int>(content));
+                }
+            }
+        }
+
+        /**
+         * Reads a sequence of mappings like `read_mapping_sequence(indent, value, read_item)`, and
+         * also converts an inline flow sequence (`[{"host": "h"}]`) into the target with `from_json`.
+         *
+         * @param indent The indentation of the key holding the sequence.
+         * @param value The inline value of that key.
+         * @param target The member holding the sequence.
+         * @param read_item Called with the indentation of every item's keys.
+         * @throws std::runtime_error If the value is not a sequence.
+         */
+        template <typename T, typename ItemReader>
+        void read_mapping_sequence(const int indent, const std::string_view value, T& target, ItemReader&& read_item) {
+            if (value.size() > 2 && value.front() == '[') {
+                if (const json sequence = typed(value); sequence.is_array()) {
+                    sequence.get_to(target);
+                    return;
+                }
+            }
+            read_mapping_sequence(indent, value, std::forward<ItemReader>(read_item));
+        }
+
+        /**
+         * Converts a scalar to a string, removing quotes and resolving escapes; a null scalar leaves
+         * the target untouched.
+         */
+        static void read_scalar(const std::string_view text, std::string& out) {
+            if (text.size() >= 2 && text.front() == '\'' && text.back() == '\'') {
+                out.clear();
+                for (size_t i = 1; i + 1 < text.size(); ++i) {
+                    out += text[i];
+                    if (text[i] == '\'' && text[i + 1] == '\'') {
+                        ++i; // '' is an escaped single quote
+                    }
+                }
+            } else if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+                out.clear();
+                for (size_t i = 1; i + 1 < text.size(); ++i) {
+                    if (text[i] == '\\' && i + 2 < text.size()) {
+                        switch (text[++i]) {
+                            case 'n': out += '\n'; break;
+                            case 't': out += '\t'; break;
+                            case 'r': out += '\r'; break;
+                            default: out += text[i]; break;
+                        }
+                    } else {
+                        out += text[i];
+                    }
+                }
+            } else if (!is_null(text)) {
+                out.assign(text);
+            }
+        }
+
+        /**
+         * Converts a scalar to an integer. Decimal integers are read directly; other scalars are
+         * typed like `parse_yaml` types them (`0x10`, `1e3`, `true`) and converted like `get<T>()`
+         * converts them. A null scalar leaves the target untouched.
+         *
+         * @throws std::runtime_error If the scalar is not a number.
+         */
+        void read_scalar(std::string_view text, std::int64_t& out) {
+            std::string_view digits = text;
+            if (!digits.empty() && digits[0] == '+') {
+                digits.remove_prefix(1);
+            }
+            const auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), out);
+            if (error != std::errc() || end != digits.data() + digits.size()) {
+                read_typed_number(text, out, "an integer");
+            }
+        }
+
+        /**
+         * Converts a scalar to a floating point number, including `.inf` and `.nan`. Other notations
+         * (`0x10`) are typed like `parse_yaml` types them; a null scalar leaves the target untouched.
+         *
+         * @throws std::runtime_error If the scalar is not a number.
+         */
+        void read_scalar(const std::string_view text, double& out) {
+            if (text == ".inf" || text == ".Inf" || text == "+.inf") {
+                out = std::numeric_limits<double>::infinity();
+            } else if (text == "-.inf" || text == "-.Inf") {
+                out = -std::numeric_limits<double>::infinity();
+            } else if (text == ".nan" || text == ".NaN") {
+                out = std::numeric_limits<double>::quiet_NaN();
+            } else {
+                std::string_view digits = text;
+                if (!digits.empty() && digits[0] == '+') {
+                    digits.remove_prefix(1);
+                }
+                const auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), out);
+                if (error != std::errc() || end != digits.data() + digits.size()) {
+                    read_typed_number(text, out, "a number");
+                }
+            }
+        }
+
+        /**
+         * Converts a scalar to a boolean; a null scalar leaves the target untouched.
+         *
+         * @throws std::runtime_error If the scalar is not `true` or `false`.
+         */
+        static void read_scalar(const std::string_view text, bool& out) {
+            if (text == "true" || text == "True" || text == "TRUE") {
+                out = true;
+            } else if (text == "false" || text == "False" || text == "FALSE") {
+                out = false;
+            } else if (!is_null(text)) {
+                NLOHMANN_YAML_THROW(std::runtime_error("Expected a boolean, got '" + std::string(text) + "'"));
+            }
+        }
+    };
+
+    /**
+     * Block-style YAML writer driven by SAX events, usable directly with `json::sax_parse` or fed
+     * from a DOM by `to_yaml`. Only the chain of open containers is kept in memory; finished
+     * output is handed to the target stream whenever the internal buffer exceeds a threshold.
+     *
+     * Scalars are quoted whenever their plain form would be read back as a different value or
+     * type, so `parse_yaml` reproduces the original data. Keys that would not read back as plain
+     * text (containing ':' or '#', or starting with an indicator character) are double-quoted;
+     * `parse_yaml` removes the quotes again.
+     */
+    class yaml_emitter {
+        private:
+        friend class yaml_parallel_emitter;
+
+        /**
+         * An open mapping or sequence. Containers are written lazily: nothing is emitted until
+         * the first child arrives, so empty containers can still be written as `{}` / `[]`.
+         */
+        struct frame {
+            bool is_object = false;
+            int indent = 0;     // Column of this container's keys or dashes
+            size_t count = 0;   // Number of completed children
+            bool open = false;  // Whether the header of the container has been written
+            bool compact = false; // Mapping inside a sequence: first key goes on the dash line
+            std::string key;    // Pending key of a mapping
+            std::string anchor; // Anchor written in the container's header
+        };
+
+        std::vector<frame> stack;
+        std::string buffer;
+        std::string next_anchor;
+        std::ostream* out = nullptr;
+        size_t flush_threshold = 0;
+        std::string error_message;
+
+        void write_indent(const int indent) {
+            buffer.append(static_cast<size_t>(indent), ' ');
+        }
+
+        /**
+         * Writes a string as a double-quoted YAML scalar, escaping the characters `parse_yaml`
+         * treats specially.
+         *
+         * @param str The string to write.
+         */
+        void write_quoted(const std::string& str) {
+            buffer += '"';
+            for (const char c : str) {
+                switch (c) {
+                    case '"': buffer += "\\\""; break;
+                    case '\\': buffer += "\\\\"; break;
+                    case '\n': buffer += "\\n"; break;
+                    case '\t': buffer += "\\t"; break;
+                    case '\r': buffer += "\\r"; break;
+                    default: buffer += c; break;
+                }
+            }
+            buffer += '"';
+        }
 
-                    std::string val = value.substr(colon_pos + 1);
-                    val.erase(0, val.find_first_not_of(" \t"));
+        /**
+         * Determines whether a string can be written as a plain (unquoted) scalar and still be
+         * read back by `parse_yaml` as the same string. Strings that could be taken for numbers,
+         * booleans, nulls or special floats, or that contain indicator characters, are rejected.
+         *
+         * @param str The string to check.
+         * @return True if the string can be written without quotes, otherwise false.
+         */
+        static bool is_plain_safe(const std::string& str) {
+            if (str.empty()) {
+                return false;
+            }
 
-                    if (val.empty()) {
-                        int sub_indent = get_next_sub_indent(current_line, current_indent);
-                        if (sub_indent == -1) {
-                            throw std::runtime_error("Expected indented block for key '" + key
-                                + "' at line " + std::to_string(current_line - 1));
-                        }
-                        json sub = parse_value(sub_indent);
-                        if (sub.is_null()) {
-                            throw std::runtime_error("Failed to parse block for key '" + key
-                                + "' at line " + std::to_string(current_line - 1));
-                        }
-                        obj[key] = sub;
+            const char first = str.front();
+            const char last = str.back();
+            if (first == ' ' || first == '\t' || last == ' ' || last == '\t') {
+                return false;
+            }
+
+            // Indicators, and anything that may start a number or a special float
+            if (std::string_view("-?:,[]{}#&*!|>'\"%@`~+.0123456789").find(first) != std::string_view::npos) {
+                return false;
+            }
+
+            for (const char c : str) {
+                if (c == ':' || c == '#' || static_cast<unsigned char>(c) < 0x20 || c == 0x7f) {
+                    return false;
+                }
+            }
+
+            // Words resolved as booleans or nulls
+            static const char* const reserved[] = {
+                "null", "Null", "NULL", "true", "True", "TRUE", "false", "False", "FALSE"
+            };
+            for (const char* word : reserved) {
+                if (str == word) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Determines whether a mapping key is read back verbatim by `parse_yaml`.
+         *
+         * @param key The key to check.
+         * @return True if the key can be written without quotes, otherwise false.
+         */
+        static bool is_plain_key(const std::string& key) {
+            if (key.empty()) {
+                return false;
+            }
+
+            const char first = key.front();
+            const char last = key.back();
+            if (first == ' ' || first == '\t' || last == ' ' || last == '\t') {
+                return false;
+            }
+            if (std::string_view("-?:,[]{}#&*!|>'\"%@`").find(first) != std::string_view::npos) {
+                return false;
+            }
+
+            for (const char c : key) {
+                if (c == ':' || c == '#' || static_cast<unsigned char>(c) < 0x20 || c == 0x7f) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Writes the start of the next entry of a container: the indented key and colon of a
+         * mapping entry, or the indented dash of a sequence entry.
+         *
+         * @param f The container receiving the entry.
+         */
+        void write_entry_prefix(const frame& f) {
+            if (f.is_object) {
+                if (f.compact && f.count == 0) {
+                    write_indent(f.indent - 2);
+                    buffer += "- ";
+                } else {
+                    write_indent(f.indent);
+                }
+                if (is_plain_key(f.key)) {
+                    buffer += f.key;
+                } else {
+                    write_quoted(f.key);
+                }
+                buffer += ':';
+            } else {
+                write_indent(f.indent);
+                buffer += '-';
+            }
+        }
+
+        /**
+         * Writes the header of the innermost container once it is known to be non-empty.
+         */
+        void open_top() {
+            frame& f = stack.back();
+            if (f.open) {
+                return;
+            }
+            f.open = true;
+
+            // The root container has no header
+            if (stack.size() == 1) {
+                return;
+            }
+
+            if (const frame& parent = stack[stack.size() - 2]; f.is_object && !parent.is_object && f.anchor.empty()) {
+                // A mapping in a sequence starts on the dash line: "- key: value"
+                f.compact = true;
+            } else {
+                // An anchor stays on the dash line, where "- &a key: value" would anchor the key
+                write_entry_prefix(parent);
+                if (!f.anchor.empty()) {
+                    buffer += " &";
+                    buffer += f.anchor;
+                }
+                buffer += '\n';
+            }
+        }
+
+        /**
+         * Writes a scalar as the next entry of the innermost container, or as the document.
+         *
+         * @param text The scalar, already formatted as YAML.
+         */
+        bool write_scalar(const std::string_view text) {
+            if (stack.empty()) {
+                buffer += text;
+                buffer += '\n';
+            } else {
+                open_top();
+                frame& f = stack.back();
+                write_entry_prefix(f);
+                buffer += ' ';
+                buffer += text;
+                buffer += '\n';
+                ++f.count;
+            }
+            flush_if_needed();
+            return true;
+        }
+
+        bool start_container(const bool is_object) {
+            int indent = 0;
+            if (!stack.empty()) {
+                open_top();
+                indent = stack.back().indent + 2;
+            }
+            frame f;
+            f.is_object = is_object;
+            f.indent = indent;
+            f.anchor = std::move(next_anchor);
+            next_anchor.clear();
+            stack.push_back(std::move(f));
+            return true;
+        }
+
+        bool end_container() {
+            const frame f = std::move(stack.back());
+            stack.pop_back();
+
+            if (f.count == 0) {
+                // Nothing was written for an empty container; emit it in flow style
+                if (!stack.empty()) {
+                    write_entry_prefix(stack.back());
+                    buffer += ' ';
+                    if (!f.anchor.empty()) {
+                        buffer += '&';
+                        buffer += f.anchor;
+                        buffer += ' ';
+                    }
+                }
+                buffer += f.is_object ? "{}\n" : "[]\n";
+            }
+
+            if (!stack.empty()) {
+                ++stack.back().count;
+            }
+            flush_if_needed();
+            return true;
+        }
+
+        void flush_if_needed() {
+            if (out && buffer.size() >= flush_threshold) {
+                flush();
+            }
+        }
+
+        public:
+        /**
+         * Constructs an emitter that collects the whole output in memory (see `str()`).
+         */
+        yaml_emitter() = default;
+
+        /**
+         * Constructs an emitter writing to a stream, keeping at most about `flush_threshold`
+         * bytes of output buffered.
+         *
+         * @param os The output stream receiving the YAML text.
+         * @param flush_threshold The buffered output size that triggers a write to `os`.
+         */
+        explicit yaml_emitter(std::ostream& os, const size_t flush_threshold = 64 * 1024)
+            : out(&os), flush_threshold(flush_threshold) {
+        }
+
+        /**
+         * Writes the buffered output to the target stream, if there is one.
+         */
+        void flush() {
+            if (out && !buffer.empty()) {
+                out->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        }
+
+        /**
+         * Returns the output collected so far that has not been flushed to a stream.
+         */
+        [[nodiscard]] const std::string& str() const {
+            return buffer;
+        }
+
+        /**
+         * Returns the message of the last JSON parse error reported through `parse_error`.
+         */
+        [[nodiscard]] const std::string& error() const {
+            return error_message;
+        }
+
+        /**
+         * Attaches an anchor to the next container, written as `&name` in its header. The root
+         * container is never anchored, since nothing can refer back to it.
+         *
+         * @param name The anchor name.
+         */
+        void anchor(std::string name) {
+            next_anchor = std::move(name);
+        }
+
+        /**
+         * Writes an alias to an anchored container as the next entry.
+         *
+         * @param name The anchor name.
+         */
+        bool alias(const std::string& name) {
+            return write_scalar("*" + name);
+        }
+
+        // SAX interface, see nlohmann::json_sax
+
+        bool null() {
+            return write_scalar("null");
+        }
+
+        bool boolean(const bool val) {
+            return write_scalar(val ? "true" : "false");
+        }
+
+        bool number_integer(const json::number_integer_t val) {
+            return write_scalar(std::to_string(val));
+        }
+
+        bool number_unsigned(const json::number_unsigned_t val) {
+            return write_scalar(std::to_string(val));
+        }
+
+        bool number_float(const json::number_float_t val, const json::string_t& /*unused*/ = {}) {
+            if (std::isnan(val)) {
+                return write_scalar(".nan");
+            }
+            if (std::isinf(val)) {
+                return write_scalar(val > 0 ? ".inf" : "-.inf");
+            }
+            // Shortest round-trip representation, always with a '.' or exponent
+            return write_scalar(json(val).dump());
+        }
+
+        bool string(json::string_t& val) {
+            if (is_plain_safe(val)) {
+                return write_scalar(val);
+            }
+
+            if (!stack.empty()) {
+                open_top();
+                write_entry_prefix(stack.back());
+                buffer += ' ';
+                ++stack.back().count;
+            }
+            write_quoted(val);
+            buffer += '\n';
+            flush_if_needed();
+            return true;
+        }
+
+        bool binary(json::binary_t& val) {
+            if (val.has_subtype() && val.subtype() == static_cast<std::uint8_t>(yaml_binary_subtype::raw_json)) {
+                // Raw JSON is written back as a flow value; JSON whitespace never occurs inside
+                // its strings, so line breaks can be folded into spaces
+                std::string text(val.begin(), val.end());
+                std::replace_if(text.begin(), text.end(), [](const char c) {
+                    return c == '\n' || c == '\r' || c == '\t';
+                }, ' ');
+                return write_scalar(text);
+            }
+
+            const bool packed_double = val.has_subtype()
+                && val.subtype() == static_cast<std::uint8_t>(yaml_binary_subtype::packed_double);
+            if (packed_double || (val.has_subtype()
+                                  && val.subtype() == static_cast<std::uint8_t>(yaml_binary_subtype::packed_int64))) {
+                // Packed sequences are written back as the block sequence they were parsed from
+                start_array();
+                for (std::size_t i = 0; i + 8 <= val.size(); i += 8) {
+                    const std::uint64_t bits = yaml_load_le64(val.data() + i);
+                    if (packed_double) {
+                        double number;
+                        std::memcpy(&number, &bits, sizeof(number));
+                        number_float(number);
                     } else {
-                        obj[key] = parse_scalar(val);
+                        number_integer(static_cast<std::int64_t>(bits));
                     }
+                }
+                return end_array();
+            }
 
-                    // Now check for additional key-value pairs at a consistent higher indentation
-                    int key_indent = -1;
-                    while (current_line < lines.size()) {
-                        const std::string& next_line = lines[current_line];
-                        if (next_line.empty()) {
-                            current_line++;
-                            continue;
-                        }
+            // Written as the flow mapping nlohmann::json serializes binaries to
+            return write_scalar(json(val).dump());
+        }
 
-                        const int next_indent = get_indent(next_line);
+        bool start_object(std::size_t /*unused*/ = static_cast<std::size_t>(-1)) {
+            return start_container(true);
+        }
 
-                        // If indentation is less than or equal to sequence item level, we're done
-                        if (next_indent <= current_indent) {
-                            break;
-                        }
+        bool key(json::string_t& val) {
+            stack.back().key = val;
+            return true;
+        }
 
-                        // Must have a colon to be a mapping entry
-                        size_t next_colon_pos = next_line.find(':');
-                        if (next_colon_pos == std::string::npos) {
-                            break;
-                        }
+        bool end_object() {
+            return end_container();
+        }
 
-                        // Set or check consistent key indentation
-                        if (key_indent == -1) {
-                            key_indent = next_indent;
-                        } else if (next_indent != key_indent) {
-                            break;
-                        }
+        bool start_array(std::size_t /*unused*/ = static_cast<std::size_t>(-1)) {
+            return start_container(false);
+        }
 
-                        current_line++;
+        bool end_array() {
+            return end_container();
+        }
 
-                        std::string next_key = next_line.substr(next_indent, next_colon_pos - next_indent);
-                        next_key.erase(next_key.find_last_not_of(" \t") + 1);
+        bool parse_error(std::size_t /*position*/, const std::string& /*last_token*/,
+                         const detail::exception& ex) {
+            error_message = ex.what();
+            return false;
+        }
+    };
 
-                        std::string next_val = next_line.substr(next_colon_pos + 1);
-                        next_val.erase(0, next_val.find_first_not_of(" \t"));
+    /**
+     * Decides which containers of a document are written as `&anchor` / `*alias` pairs. A
+     * bottom-up pass hashes every container and groups equal subtrees of at least `min_nodes`
+     * nodes; a second pass in emission order keeps the groups that will actually be written
+     * more than once, since repeats nested inside an aliased subtree are never written. The
+     * plan only reads the document, which must outlive it and stay unmodified.
+     */
+    class yaml_anchor_plan {
+        struct group {
+            const json* first = nullptr; ///< Occurrence written with the anchor
+            size_t order = 0;            ///< Position of `first` in emission order
+            bool repeated = false;       ///< Whether a later occurrence is written as an alias
+            std::string name;
+        };
 
-                        if (next_val.empty()) {
-                            int next_sub_indent = get_next_sub_indent(current_line, key_indent);
-                            if (next_sub_indent == -1) {
-                                throw std::runtime_error("Expected indented block for key '" + next_key
-                                    + "' at line " + std::to_string(current_line - 1));
-                            }
-                            json next_sub = parse_value(next_sub_indent);
-                            if (next_sub.is_null()) {
-                                throw std::runtime_error("Failed to parse block for key '" + next_key
-                                    + "' at line " + std::to_string(current_line - 1));
-                            }
-                            obj[next_key] = next_sub;
-                        } else {
-                            obj[next_key] = parse_scalar(next_val);
-                        }
+        size_t min_nodes;
+        std::unordered_map<const json*, size_t> group_of; ///< Group of every large enough container
+        std::unordered_multimap<std::uint64_t, size_t> groups_by_hash;
+        std::vector<group> groups;
+        size_t visited = 0;
+
+        static std::uint64_t mix(std::uint64_t hash, const std::uint64_t value) {
+            hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+
+        /**
+         * Hashes a subtree and registers its large enough containers.
+         *
+         * @param value The subtree.
+         * @param hash Receives the structural hash of the subtree.
+         * @return The number of nodes in the subtree.
+         */
+        size_t index(const json& value, std::uint64_t& hash) {
+            size_t nodes = 1;
+            switch (value.type()) {
+                case json::value_t::object:
+                    hash = 6;
+                    for (auto it = value.cbegin(); it != value.cend(); ++it) {
+                        std::uint64_t child = 0;
+                        nodes += index(it.value(), child);
+                        hash = mix(mix(hash, yaml_hash64(it.key(), 0)), child);
+                    }
+                    break;
+                case json::value_t::array:
+                    hash = 7;
+                    for (const auto& element : value) {
+                        std::uint64_t child = 0;
+                        nodes += index(element, child);
+                        hash = mix(hash, child);
+                    }
+                    break;
+                case json::value_t::string:
+                    hash = mix(4, yaml_hash64(value.get_ref<const json::string_t&>(), 0));
+                    return nodes;
+                case json::value_t::boolean:
+                    hash = mix(1, value.get<bool>() ? 1 : 0);
+                    return nodes;
+                case json::value_t::number_integer:
+                case json::value_t::number_unsigned:
+                    // Both are written the same way, so they may share an anchor
+                    hash = mix(2, static_cast<std::uint64_t>(value.get<json::number_integer_t>()));
+                    return nodes;
+                case json::value_t::number_float: {
+                    const double number = value.get<double>();
+                    std::uint64_t bits;
+                    std::memcpy(&bits, &number, sizeof(bits));
+                    hash = mix(3, bits);
+                    return nodes;
+                }
+                case json::value_t::binary: {
+                    const auto& binary = value.get_binary();
+                    hash = mix(5, yaml_hash64(std::string_view(reinterpret_cast<const char*>(binary.data()),
+                                                               binary.size()), binary.subtype()));
+                    return nodes;
+                }
+                default:
+                    hash = 0;
+                    return nodes;
+            }
+
+            if (nodes >= min_nodes) {
+                size_t id = groups.size();
+                for (auto [it, end] = groups_by_hash.equal_range(hash); it != end; ++it) {
+                    if (*groups[it->second].first == value) {
+                        id = it->second;
+                        break;
                     }
+                }
+                if (id == groups.size()) {
+                    groups.emplace_back();
+                    groups.back().first = &value;
+                    groups_by_hash.emplace(hash, id);
+                }
+                group_of.emplace(&value, id);
+            }
+            return nodes;
+        }
+
+        /**
+         * Walks the document in emission order, skipping the subtrees that become aliases.
+         */
+        void visit(const json& value) {
+            if (!value.is_structured()) {
+                return;
+            }
+            if (const auto it = group_of.find(&value); it != group_of.end()) {
+                group& g = groups[it->second];
+                if (g.order != 0) {
+                    g.repeated = true;
+                    return;
+                }
+                g.first = &value;
+                g.order = ++visited;
+            }
+            for (const auto& element : value) {
+                visit(element);
+            }
+        }
+
+        public:
+        /**
+         * Plans the anchors of a document.
+         *
+         * @param root The document.
+         * @param min_nodes Smallest subtree, counted in nodes, that is worth an anchor.
+         */
+        yaml_anchor_plan(const json& root, const size_t min_nodes) : min_nodes(std::max<size_t>(2, min_nodes)) {
+            std::uint64_t hash = 0;
+            index(root, hash);
+            groups_by_hash.clear();
+            visit(root);
+
+            // Anchors are numbered in the order they appear in the output
+            std::vector<group*> anchored;
+            for (group& g : groups) {
+                if (g.repeated) {
+                    anchored.push_back(&g);
+                }
+            }
+            std::sort(anchored.begin(), anchored.end(), [](const group* a, const group* b) {
+                return a->order < b->order;
+            });
+            for (size_t i = 0; i < anchored.size(); ++i) {
+                anchored[i]->name = "a" + std::to_string(i + 1);
+            }
+        }
+
+        /**
+         * Looks up how a container is written.
+         *
+         * @param value A node of the planned document.
+         * @param is_alias Set to true when the node is written as an alias, false when it is
+         *        written in full with the returned anchor.
+         * @return The anchor name, or null when the node is written normally.
+         */
+        [[nodiscard]] const std::string* find(const json& value, bool& is_alias) const {
+            const auto it = group_of.find(&value);
+            if (it == group_of.end() || !groups[it->second].repeated) {
+                return nullptr;
+            }
+            const group& g = groups[it->second];
+            is_alias = g.first != &value;
+            return &g.name;
+        }
+
+        /**
+         * @return The number of anchors in the output.
+         */
+        [[nodiscard]] size_t anchor_count() const {
+            return static_cast<size_t>(std::count_if(groups.begin(), groups.end(), [](const group& g) {
+                return g.repeated;
+            }));
+        }
+    };
+
+    /**
+     * Replays a JSON value as SAX events into a YAML emitter.
+     *
+     * @param value The value to emit.
+     * @param emitter The emitter receiving the events.
+     * @param anchors When set, repeated subtrees are written as anchors and aliases.
+     */
+    inline void emit_yaml(const json& value, yaml_emitter& emitter, const yaml_anchor_plan* anchors = nullptr) {
+        if (anchors && value.is_structured()) {
+            bool is_alias = false;
+            if (const std::string* name = anchors->find(value, is_alias)) {
+                if (is_alias) {
+                    emitter.alias(*name);
+                    return;
+                }
+                emitter.anchor(*name);
+            }
+        }
+
+        switch (value.type()) {
+            case json::value_t::object:
+                emitter.start_object(value.size());
+                for (auto it = value.cbegin(); it != value.cend(); ++it) {
+                    json::string_t key = it.key();
+                    emitter.key(key);
+                    emit_yaml(it.value(), emitter, anchors);
+                }
+                emitter.end_object();
+                break;
+            case json::value_t::array:
+                emitter.start_array(value.size());
+                for (const auto& element : value) {
+                    emit_yaml(element, emitter, anchors);
+                }
+                emitter.end_array();
+                break;
+            case json::value_t::string: {
+                json::string_t str = value.get<json::string_t>();
+                emitter.string(str);
+                break;
+            }
+            case json::value_t::boolean:
+                emitter.boolean(value.get<bool>());
+                break;
+            case json::value_t::number_integer:
+                emitter.number_integer(value.get<json::number_integer_t>());
+                break;
+            case json::value_t::number_unsigned:
+                emitter.number_unsigned(value.get<json::number_unsigned_t>());
+                break;
+            case json::value_t::number_float:
+                emitter.number_float(value.get<json::number_float_t>());
+                break;
+            case json::value_t::binary: {
+                json::binary_t binary = value.get_binary();
+                emitter.binary(binary);
+                break;
+            }
+            default:
+                emitter.null();
+                break;
+        }
+    }
+
+    /**
+     * Serializes a JSON value as block-style YAML that `parse_yaml` reads back unchanged.
+     *
+     * @param value The value to serialize.
+     * @param os The output stream receiving the YAML text.
+     */
+    inline void to_yaml(const json& value, std::ostream& os) {
+        yaml_emitter emitter(os);
+        emit_yaml(value, emitter);
+        emitter.flush();
+    }
+
+    /**
+     * Serializes a JSON value as block-style YAML that `parse_yaml` reads back unchanged.
+     *
+     * @param value The value to serialize.
+     * @return The YAML text.
+     */
+    inline std::string to_yaml(const json& value) {
+        yaml_emitter emitter;
+        emit_yaml(value, emitter);
+        return emitter.str();
+    }
+
+    /**
+     * Options for YAML emission. The threading options only change how the work is divided; the
+     * output is byte-identical to the serial emitter.
+     */
+    struct yaml_emit_options {
+        size_t threads = 0;           ///< Worker threads; 0 uses the hardware concurrency, 1 emits serially.
+        size_t split_depth = 1;       ///< Deepest nesting level (root = 0) whose containers may be split.
+        size_t min_split_size = 1024; ///< Containers with fewer elements are not split.
+        size_t chunks_per_thread = 4; ///< Chunks created per worker thread, for load balancing.
+        yaml_tracer* tracer = nullptr; ///< Records emit, chunk and write spans when set.
+        /// Repeated containers of at least this many nodes are written once with an `&anchor` and
+        /// then as `*alias`; 0 writes every occurrence in full. `parse_yaml` and `yaml_mapping_stream`
+        /// read such output back; generated parsers reject anchors, and `yaml_partition` and
+        /// document streams resolve aliases only within a piece.
+        size_t anchor_min_nodes = 0;
+    };
 
-                    array.push_back(obj);
-                } else {
-                    // Simple scalar value (including JSON arrays and objects)
-                    array.push_back(parse_scalar(value));
-                }
-            }
+    /**
+     * Emits large documents by splitting big containers into chunks of consecutive elements,
+     * serializing the chunks on worker threads into separate buffers and keeping the buffers
+     * (segments) in document order, ready to be concatenated or written with one `writev`.
+     */
+    class yaml_parallel_emitter {
+        private:
+        yaml_emit_options options;
+        yaml_emitter emitter;
+        std::vector<std::string> segments;
+        std::optional<yaml_anchor_plan> anchors;
 
-            return array;
+        [[nodiscard]] const yaml_anchor_plan* plan() const {
+            return anchors ? &*anchors : nullptr;
         }
 
         /**
-         * Parses a YAML-style mapping structure from the current line and returns it
-         * as a JSON object. The method verifies indentation consistency, extracts keys
-         * and values, handles nested mappings, and processes scalar values.
+         * Emits a large container whose elements are serialized in parallel chunks.
          *
-         * @param current_indent The current indentation level to compare against the lines
-         *                       being parsed. Determines the scope of the mapping.
-         * @return A JSON object constructed from the parsed mapping structure.
-         *         Keys represent YAML mapping keys, and values represent their corresponding parsed values.
-         * @throws std::runtime_error If the expected structure (e.g., indented block for a key)
-         *                            is missing, or parsing fails for nested blocks.
+         * @param value The container to emit; it must not be empty.
          */
-        json parse_mapping(const int current_indent) {
-            json object = json::object();
+        void emit_split(const json& value) {
+            const bool is_object = value.is_object();
+            if (is_object) {
+                emitter.start_object(value.size());
+            } else {
+                emitter.start_array(value.size());
+            }
 
-            while (current_line < lines.size()) {
-                const std::string& line = lines[current_line];
+            // The container is not empty, so its header can be written right away
+            emitter.open_top();
+            segments.push_back(std::move(emitter.buffer));
+            emitter.buffer.clear();
 
-                // Skip empty lines
-                if (line.empty()) {
-                    current_line++;
-                    continue;
-                }
+            std::vector<json::const_iterator> elements;
+            elements.reserve(value.size());
+            for (auto it = value.cbegin(); it != value.cend(); ++it) {
+                elements.push_back(it);
+            }
 
-                const int line_indent = get_indent(line);
+            const size_t chunk_count = std::min(elements.size(), options.threads * options.chunks_per_thread);
+            const size_t chunk_size = (elements.size() + chunk_count - 1) / chunk_count;
+            std::vector<std::string> chunks((elements.size() + chunk_size - 1) / chunk_size);
 
-                // If indentation is less than the current level, we're done
-                if (line_indent < current_indent) {
-                    break;
-                }
+            yaml_run_tasks(options.threads, chunks.size(), [&](const size_t chunk) {
+                const size_t first = chunk * chunk_size;
+                const size_t last = std::min(first + chunk_size, elements.size());
+                yaml_trace_scope span(options.tracer, "emit chunk");
+                span.set_items(last - first);
 
-                // If indentation doesn't match the current level, break
-                if (line_indent != current_indent) {
-                    break;
-                }
+                // Each chunk continues the container exactly where the previous chunk stopped
+                yaml_emitter chunk_emitter;
+                chunk_emitter.stack.push_back(emitter.stack.back());
+                chunk_emitter.stack.back().count = first;
 
-                // Look for key-value separator
-                const size_t colon_pos = line.find(':');
-                if (colon_pos == std::string::npos) {
-                    break; // Not a mapping line
+                for (size_t i = first; i < last; ++i) {
+                    if (is_object) {
+                        json::string_t key = elements[i].key();
+                        chunk_emitter.key(key);
+                    }
+                    emit_yaml(elements[i].value(), chunk_emitter, plan());
                 }
+                chunks[chunk] = std::move(chunk_emitter.buffer);
+            });
 
-                current_line++;
+            for (auto& chunk : chunks) {
+                segments.push_back(std::move(chunk));
+            }
 
-                // Extract key and value
-                std::string key = line.substr(line_indent, colon_pos - line_indent);
-                key.erase(key.find_last_not_of(" \t") + 1);
+            emitter.stack.back().count = elements.size();
+            if (is_object) {
+                emitter.end_object();
+            } else {
+                emitter.end_array();
+            }
+        }
 
-                std::string value = line.substr(colon_pos + 1);
-                value.erase(0, value.find_first_not_of(" \t"));
+        /**
+         * Emits a value, splitting the first large containers found down to `split_depth`.
+         *
+         * @param value The value to emit.
+         * @param depth The nesting level of `value`, 0 for the document root.
+         */
+        void emit(const json& value, const size_t depth) {
+            bool is_alias = false;
+            if (!value.is_structured() || value.empty() || depth > options.split_depth
+                || (anchors && anchors->find(value, is_alias))) {
+                emit_yaml(value, emitter, plan());
+                return;
+            }
 
-                if (value.empty()) {
-                    // Complex value on next line(s)
-                    const int sub_indent = get_next_sub_indent(current_line, current_indent);
-                    if (sub_indent == -1) {
-                        throw std::runtime_error("Expected indented block for key '" + key
-                            + "' at line " + std::to_string(current_line - 1));
-                    }
-                    json sub = parse_value(sub_indent);
-                    if (sub.is_null()) {
-                        throw std::runtime_error("Failed to parse block for key '" + key
-                            + "' at line " + std::to_string(current_line - 1));
-                    }
-                    object[key] = sub;
-                } else {
-                    // Simple scalar value (including JSON arrays and objects)
-                    object[key] = parse_scalar(value);
-                }
+            if (value.size() >= options.min_split_size) {
+                emit_split(value);
+                return;
             }
 
-            return object;
+            if (value.is_object()) {
+                emitter.start_object(value.size());
+                for (auto it = value.cbegin(); it != value.cend(); ++it) {
+                    json::string_t key = it.key();
+                    emitter.key(key);
+                    emit(it.value(), depth + 1);
+                }
+                emitter.end_object();
+            } else {
+                emitter.start_array(value.size());
+                for (const auto& element : value) {
+                    emit(element, depth + 1);
+                }
+                emitter.end_array();
+            }
         }
 
+        public:
         /**
-         * Parses a single value from the current YAML lines using the provided indentation level.
-         * Determines the type of the value (scalar, sequence, mapping, or JSON block) based on
-         * the content and indentation rules.
+         * Serializes a JSON value into ordered output segments.
          *
-         * @param current_indent The expected indentation level for parsing the current value.
-         *                        Lines with greater indentation are ignored, and lines with
-         *                        lesser indentation indicate the end of the current structure.
-         * @return A JSON representation of the parsed value. Returns `nullptr` if no valid value
-         *         can be parsed or if the operation reaches the end of the input lines.
+         * @param value The value to serialize.
+         * @param emit_options Controls the number of threads and how containers are split.
          */
-        json parse_value(const int current_indent) {
-            while (current_line < lines.size()) {
-                const std::string& line = lines[current_line];
+        yaml_parallel_emitter(const json& value, const yaml_emit_options& emit_options)
+            : options(emit_options) {
+            if (options.threads == 0) {
+                options.threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+            options.chunks_per_thread = std::max<size_t>(1, options.chunks_per_thread);
 
-                // Skip empty lines
-                if (line.empty()) {
-                    current_line++;
-                    continue;
-                }
+            yaml_trace_scope span(options.tracer, "emit");
+            if (options.anchor_min_nodes != 0) {
+                yaml_trace_scope plan_span(options.tracer, "plan anchors");
+                anchors.emplace(value, options.anchor_min_nodes);
+                plan_span.set_items(anchors->anchor_count());
+            }
+            if (options.threads > 1) {
+                emit(value, 0);
+            } else {
+                emit_yaml(value, emitter, plan());
+            }
+            segments.push_back(std::move(emitter.buffer));
+            emitter.buffer.clear();
+        }
 
-                const int line_indent = get_indent(line);
+        /**
+         * Returns the output segments; their concatenation is the YAML document.
+         */
+        [[nodiscard]] const std::vector<std::string>& output() const {
+            return segments;
+        }
 
-                // If indentation is less than expected, return null
-                if (line_indent < current_indent) {
-                    return nullptr;
-                }
+        /**
+         * Writes the output segments to a stream, in order.
+         *
+         * @param os The output stream receiving the YAML text.
+         */
+        void write(std::ostream& os) const {
+            yaml_trace_scope span(options.tracer, "write");
+            for (const auto& segment : segments) {
+                os.write(segment.data(), static_cast<std::streamsize>(segment.size()));
+            }
+        }
 
-                // If indentation matches, determine the type
-                if (line_indent == current_indent) {
-                    const std::string at_level = line.substr(line_indent);
+#if !defined(_WIN32)
+        /**
+         * Writes the output segments to a file descriptor with `writev`, gathering all segments
+         * in one call (split only when there are more than IOV_MAX segments or the kernel
+         * accepts a partial write).
+         *
+         * @param fd The file descriptor receiving the YAML text.
+         * @throws std::runtime_error If writing fails.
+         */
+        void write(const int fd) const {
+            yaml_trace_scope span(options.tracer, "write");
+            std::vector<iovec> vectors;
+            vectors.reserve(segments.size());
+            for (const auto& segment : segments) {
+                if (!segment.empty()) {
+                    vectors.push_back(iovec{const_cast<char*>(segment.data()), segment.size()});
+                }
+            }
 
-                    // If this line starts with a JSON token, try to parse a (potentially multi-line) JSON block
-                    if (starts_with_json_token(at_level)) {
-                        const size_t saved = current_line;
-                        if (std::string json_text; try_collect_json_block(current_indent, json_text)) {
-                            try {
-                                return json::parse(json_text);
-                            } catch (...) {
-                                // If parsing fails, revert and fall through to other handlers
-                                current_line = saved;
-                            }
-                        }
+            size_t first = 0;
+            while (first < vectors.size()) {
+                const int count = static_cast<int>(std::min<size_t>(vectors.size() - first, IOV_MAX));
+                const ssize_t written = ::writev(fd, vectors.data() + first, count);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
                     }
+                    NLOHMANN_YAML_THROW(std::runtime_error(std::string("Failed to write YAML output: ") + std::strerror(errno)));
+                }
 
-                    if (line[line_indent] == '-') {
-                        return parse_sequence(current_indent);
-                    } else if (line.find(':') != std::string::npos) {
-                        return parse_mapping(current_indent);
-                    } else {
-                        current_line++;
-                        return parse_scalar(at_level);
-                    }
-                } else {
-                    // Skip lines with greater indentation until we find our level
-                    current_line++;
-                    continue;
+                // Skip fully written vectors and trim a partially written one
+                auto remaining = static_cast<size_t>(written);
+                while (first < vectors.size() && remaining >= vectors[first].iov_len) {
+                    remaining -= vectors[first].iov_len;
+                    ++first;
+                }
+                if (remaining > 0) {
+                    vectors[first].iov_base = static_cast<char*>(vectors[first].iov_base) + remaining;
+                    vectors[first].iov_len -= remaining;
                 }
             }
+        }
+#endif
+    };
 
-            return nullptr;
+    /**
+     * Serializes a JSON value as block-style YAML, splitting large containers across threads.
+     * Without `anchor_min_nodes` the output is byte-identical to `to_yaml(value)`.
+     *
+     * @param value The value to serialize.
+     * @param options Controls the number of threads and how containers are split.
+     * @return The YAML text.
+     */
+    inline std::string to_yaml(const json& value, const yaml_emit_options& options) {
+        const yaml_parallel_emitter parallel(value, options);
+
+        size_t size = 0;
+        for (const auto& segment : parallel.output()) {
+            size += segment.size();
         }
 
-    public:
+        std::string result;
+        result.reserve(size);
+        for (const auto& segment : parallel.output()) {
+            result += segment;
+        }
+        return result;
+    }
+
+    /**
+     * Serializes a JSON value as block-style YAML to a stream, splitting large containers
+     * across threads. Without `anchor_min_nodes` the output is byte-identical to `to_yaml(value, os)`.
+     *
+     * @param value The value to serialize.
+     * @param os The output stream receiving the YAML text.
+     * @param options Controls the number of threads and how containers are split.
+     */
+    inline void to_yaml(const json& value, std::ostream& os, const yaml_emit_options& options) {
+        yaml_parallel_emitter(value, options).write(os);
+    }
+
+#if !defined(_WIN32)
+    /**
+     * Serializes a JSON value as block-style YAML to a file descriptor, splitting large
+     * containers across threads and writing all chunk buffers in order with `writev`.
+     *
+     * @param value The value to serialize.
+     * @param fd The file descriptor receiving the YAML text.
+     * @param options Controls the number of threads and how containers are split.
+     * @throws std::runtime_error If writing fails.
+     */
+    inline void to_yaml(const json& value, const int fd, const yaml_emit_options& options = {}) {
+        yaml_parallel_emitter(value, options).write(fd);
+    }
+#endif
+
+    /**
+     * Converts JSON text to block-style YAML without building a DOM. The JSON is consumed with
+     * `json::sax_parse` and written incrementally, so memory stays bounded by the nesting depth
+     * and the output buffer.
+     *
+     * @param input The input stream containing JSON text.
+     * @param output The output stream receiving the YAML text.
+     * @throws std::runtime_error If the input is not valid JSON.
+     */
+    inline void json2yaml(std::istream& input, std::ostream& output) {
+        yaml_emitter emitter(output);
+        if (!json::sax_parse(input, &emitter)) {
+            emitter.flush();
+            NLOHMANN_YAML_THROW(std::runtime_error("Invalid JSON input: " + emitter.error()));
+        }
+        emitter.flush();
+    }
+
+#if defined(NLOHMANN_YAML_HAS_ZLIB) || defined(NLOHMANN_YAML_HAS_ZSTD)
+    /**
+     * Input stream buffer that decompresses a compressed source stream chunk by chunk. Only one
+     * compressed chunk and one decompressed chunk are held at a time, so the parser can consume
+     * compressed YAML without the whole decompressed text ever being materialized.
+     */
+    class yaml_decompress_streambuf : public std::streambuf {
+        protected:
+        std::istream& source;
+        std::vector<char> input;
+        std::vector<char> output;
+
         /**
-         * Constructs a YAML parser object initialized with an input stream. The input
-         * stream is preprocessed to prepare the parser for analyzing the YAML content.
+         * Reads the next chunk of compressed bytes from the source stream into the input buffer.
          *
-         * @param is An input stream containing the raw YAML data to be parsed.
+         * @return The number of bytes read; 0 once the source stream is exhausted.
          */
-        explicit yaml_parser(std::istream& is) {
-            preprocess_input(is);
+        size_t read_input() {
+            source.read(input.data(), static_cast<std::streamsize>(input.size()));
+            return static_cast<size_t>(source.gcount());
         }
 
         /**
-         * Parses a YAML-like document into a JSON object. It processes the input lines, identifying
-         * and handling mappings, sequences, and scalar values. This method expects a line-based
-         * representation of a YAML document and assumes correct formatting.
+         * Decompresses the next chunk of data into the given buffer.
          *
-         * @return A JSON object representing the parsed structure of the input document.
-         *         This includes mappings, sequences, scalar values, and nested structures.
-         *         Throws an exception if the input structure is invalid or unprocessable.
+         * @param out The buffer receiving decompressed bytes.
+         * @param capacity The size of the buffer.
+         * @return The number of bytes produced; 0 at the end of the compressed data.
+         * @throws std::runtime_error If the compressed data is corrupt or truncated.
          */
-        json parse() {
-            json root = json::object();
-            current_line = 0;
+        virtual size_t decompress(char* out, size_t capacity) = 0;
 
-            while (current_line < lines.size()) {
-                const std::string& line = lines[current_line];
+        int_type underflow() override {
+            if (gptr() < egptr()) {
+                return traits_type::to_int_type(*gptr());
+            }
 
-                // Skip empty lines
-                if (line.empty()) {
-                    current_line++;
-                    continue;
-                }
+            const size_t produced = decompress(output.data(), output.size());
+            if (produced == 0) {
+                return traits_type::eof();
+            }
 
-                const int line_indent = get_indent(line);
+            setg(output.data(), output.data(), output.data() + produced);
+            return traits_type::to_int_type(*gptr());
+        }
 
-                // Check if this is a sequence at the root level
-                if (line[0] == '-') {
-                    if (root.empty()) {
-                        return parse_sequence(0);
-                    } else {
-                        throw std::runtime_error("Cannot mix sequences and mappings at root level");
+        public:
+        yaml_decompress_streambuf(std::istream& compressed, const size_t input_size, const size_t output_size)
+            : source(compressed), input(input_size), output(output_size) {
+        }
+    };
+#endif
+
+#if defined(NLOHMANN_YAML_HAS_ZLIB)
+    /**
+     * Stream buffer decompressing gzip (or zlib) data, including concatenated gzip members.
+     */
+    class yaml_gzip_streambuf final : public yaml_decompress_streambuf {
+        z_stream stream{};
+        bool member_end = false;
+
+        size_t decompress(char* out, const size_t capacity) override {
+            const auto out_capacity = static_cast<uInt>(capacity);
+            stream.next_out = reinterpret_cast<Bytef*>(out);
+            stream.avail_out = out_capacity;
+
+            while (stream.avail_out == out_capacity) {
+                if (stream.avail_in == 0) {
+                    const size_t read = read_input();
+                    if (read == 0) {
+                        if (!member_end) {
+                            NLOHMANN_YAML_THROW(std::runtime_error("Truncated gzip input"));
+                        }
+                        break;
                     }
+                    stream.next_in = reinterpret_cast<Bytef*>(input.data());
+                    stream.avail_in = static_cast<uInt>(read);
                 }
 
-                // Look for mapping
-                const size_t colon_pos = line.find(':');
-                if (colon_pos == std::string::npos) {
-                    current_line++;
-                    continue; // Skip lines that aren't key-value pairs
+                if (member_end) {
+                    // Another gzip member follows the one that just ended
+                    inflateReset(&stream);
+                    member_end = false;
                 }
 
-                // Extract key and value
-                std::string key = line.substr(line_indent, colon_pos - line_indent);
-                key.erase(key.find_last_not_of(" \t") + 1);
+                if (const int rc = inflate(&stream, Z_NO_FLUSH); rc == Z_STREAM_END) {
+                    member_end = true;
+                } else if (rc != Z_OK) {
+                    NLOHMANN_YAML_THROW(std::runtime_error(std::string("Invalid gzip input: ")
+                        + (stream.msg ? stream.msg : "inflate failed")));
+                }
+            }
 
-                std::string value = line.substr(colon_pos + 1);
-                value.erase(0, value.find_first_not_of(" \t"));
+            return capacity - stream.avail_out;
+        }
 
-                current_line++;
+        public:
+        explicit yaml_gzip_streambuf(std::istream& compressed, const size_t chunk_size = 64 * 1024)
+            : yaml_decompress_streambuf(compressed, chunk_size, chunk_size) {
+            // 32 + MAX_WBITS accepts both gzip and zlib headers
+            if (inflateInit2(&stream, 32 + MAX_WBITS) != Z_OK) {
+                NLOHMANN_YAML_THROW(std::runtime_error("Failed to initialize gzip decompression"));
+            }
+        }
 
-                if (value.empty()) {
-                    // Complex value on next line(s)
-                    const int sub_indent = get_next_sub_indent(current_line, line_indent);
-                    if (sub_indent == -1) {
-                        throw std::runtime_error("Expected indented block for key '" + key
-                            + "' at line " + std::to_string(current_line - 1));
-                    }
+        ~yaml_gzip_streambuf() override {
+            inflateEnd(&stream);
+        }
 
-                    json sub = parse_value(sub_indent);
-                    if (sub.is_null()) {
-                        throw std::runtime_error("Failed to parse block for key '" + key
-                            + "' at line " + std::to_string(current_line - 1));
+        yaml_gzip_streambuf(const yaml_gzip_streambuf&) = delete;
+        yaml_gzip_streambuf& operator=(const yaml_gzip_streambuf&) = delete;
+    };
+#endif
+
+#if defined(NLOHMANN_YAML_HAS_ZSTD)
+    /**
+     * Stream buffer decompressing zstd data, including concatenated frames.
+     */
+    class yaml_zstd_streambuf final : public yaml_decompress_streambuf {
+        ZSTD_DStream* stream = nullptr;
+        ZSTD_inBuffer in_buffer{nullptr, 0, 0};
+        size_t frame_remaining = 0;
+
+        size_t decompress(char* out, const size_t capacity) override {
+            ZSTD_outBuffer out_buffer{out, capacity, 0};
+
+            while (out_buffer.pos == 0) {
+                if (in_buffer.pos == in_buffer.size) {
+                    const size_t read = read_input();
+                    if (read == 0) {
+                        if (frame_remaining != 0) {
+                            NLOHMANN_YAML_THROW(std::runtime_error("Truncated zstd input"));
+                        }
+                        break;
                     }
+                    in_buffer = ZSTD_inBuffer{input.data(), read, 0};
+                }
 
-                    root[key] = sub;
-                } else {
-                    // Simple scalar value (including JSON arrays and objects)
-                    root[key] = parse_scalar(value);
+                frame_remaining = ZSTD_decompressStream(stream, &out_buffer, &in_buffer);
+                if (ZSTD_isError(frame_remaining)) {
+                    NLOHMANN_YAML_THROW(std::runtime_error(std::string("Invalid zstd input: ")
+                        + ZSTD_getErrorName(frame_remaining)));
                 }
             }
 
-            return root;
+            return out_buffer.pos;
         }
+
+        public:
+        explicit yaml_zstd_streambuf(std::istream& compressed)
+            : yaml_decompress_streambuf(compressed, ZSTD_DStreamInSize(), ZSTD_DStreamOutSize()),
+              stream(ZSTD_createDStream()) {
+            if (!stream || ZSTD_isError(ZSTD_initDStream(stream))) {
+                ZSTD_freeDStream(stream);
+                NLOHMANN_YAML_THROW(std::runtime_error("Failed to initialize zstd decompression"));
+            }
+        }
+
+        ~yaml_zstd_streambuf() override {
+            ZSTD_freeDStream(stream);
+        }
+
+        yaml_zstd_streambuf(const yaml_zstd_streambuf&) = delete;
+        yaml_zstd_streambuf& operator=(const yaml_zstd_streambuf&) = delete;
     };
+#endif
 
     /**
-     * Parses a YAML input stream and converts it to a JSON object.
+     * Compression formats recognized for YAML input.
+     */
+    enum class yaml_compression {
+        none,
+        gzip,
+        zstd
+    };
+
+    /**
+     * Detects the compression format of YAML input from its leading magic bytes.
      *
-     * @param input The input stream containing YAML data to be parsed.
+     * @param header The first bytes of the input; at least 4 bytes are needed to detect zstd.
+     * @return The detected compression format, `yaml_compression::none` for plain text.
+     */
+    inline yaml_compression detect_yaml_compression(const std::string& header) {
+        if (header.size() >= 2 && static_cast<unsigned char>(header[0]) == 0x1f
+            && static_cast<unsigned char>(header[1]) == 0x8b) {
+            return yaml_compression::gzip;
+        }
+        if (header.size() >= 4 && header.compare(0, 4, "\x28\xb5\x2f\xfd") == 0) {
+            return yaml_compression::zstd;
+        }
+        return yaml_compression::none;
+    }
+
+    /**
+     * Parses a compressed YAML input stream, decompressing it chunk by chunk into the parser.
+     *
+     * @param input The input stream containing compressed YAML data, opened in binary mode.
+     * @param compression The compression format of the input stream.
      * @return A JSON object representing the parsed data from the YAML input.
+     * @throws std::runtime_error If the format is not supported by this build or the data is corrupt.
      */
-    inline json parse_yaml(std::istream& input) {
-        yaml_parser parser(input);
-        return parser.parse();
+    inline json parse_yaml(std::istream& input, const yaml_compression compression) {
+        switch (compression) {
+            case yaml_compression::none:
+                return parse_yaml(input);
+            case yaml_compression::gzip: {
+#if defined(NLOHMANN_YAML_HAS_ZLIB)
+                yaml_gzip_streambuf buffer(input);
+                std::istream decompressed(&buffer);
+                // Let decompression errors escape instead of silently ending the input
+                decompressed.exceptions(std::ios::badbit);
+                return parse_yaml(decompressed);
+#else
+                NLOHMANN_YAML_THROW(std::runtime_error("gzip input requires building with NLOHMANN_YAML_WITH_ZLIB"));
+#endif
+            }
+            case yaml_compression::zstd: {
+#if defined(NLOHMANN_YAML_HAS_ZSTD)
+                yaml_zstd_streambuf buffer(input);
+                std::istream decompressed(&buffer);
+                // Let decompression errors escape instead of silently ending the input
+                decompressed.exceptions(std::ios::badbit);
+                return parse_yaml(decompressed);
+#else
+                NLOHMANN_YAML_THROW(std::runtime_error("zstd input requires building with NLOHMANN_YAML_WITH_ZSTD"));
+#endif
+            }
+        }
+        NLOHMANN_YAML_THROW(std::runtime_error("Unknown YAML input compression"));
     }
 
     /**
-     * Parses a YAML string and converts it to a JSON object.
+     * Parses a YAML file, transparently decompressing `.yaml.gz` / `.yaml.zst` content
+     * detected from the file's magic bytes.
      *
-     * @param input The input string containing YAML data to be parsed.
-     * @return A JSON object representing the parsed data from the YAML string.
+     * @param path The path of the (possibly compressed) YAML file.
+     * @return A JSON object representing the parsed data from the YAML file.
+     * @throws std::runtime_error If the file cannot be opened or its compression is not supported.
      */
-    inline json parse_yaml(const std::string& input) {
-        std::istringstream iss(input);
-        return parse_yaml(iss);
+    inline json parse_yaml_file(const std::string& path) {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs.is_open()) {
+            NLOHMANN_YAML_THROW(std::runtime_error("Failed to open YAML file: " + path));
+        }
+
+        std::string header(4, '\0');
+        ifs.read(header.data(), static_cast<std::streamsize>(header.size()));
+        header.resize(static_cast<size_t>(ifs.gcount()));
+        ifs.clear();
+        ifs.seekg(0);
+
+        return parse_yaml(ifs, detect_yaml_compression(header));
     }
 
 } // namespace nlohmann
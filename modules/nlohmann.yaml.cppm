@@ -0,0 +1,141 @@
+/*
+    Copyright (C) 2025 Igal Alkon <igal@alkontek.com> and contributors
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+// C++20 module interface for nlohmann_yaml. The library itself stays header-only; this unit
+// compiles <nlohmann/yaml.hpp> once and exports its public API, so translation units that
+// `import nlohmann.yaml;` do not re-parse the YAML and nlohmann_json headers.
+module;
+
+#include <nlohmann/yaml.hpp>
+
+export module nlohmann.yaml;
+
+export namespace nlohmann {
+    // nlohmann_json types that appear in the YAML API
+    using nlohmann::basic_json;
+    using nlohmann::json;
+    using nlohmann::json_pointer;
+    using nlohmann::ordered_json;
+    using nlohmann::ordered_map;
+
+    // Parsing
+    using nlohmann::basic_yaml_parser;
+    using nlohmann::parse_yaml;
+    using nlohmann::parse_yaml_as;
+    using nlohmann::parse_yaml_documents;
+    using nlohmann::parse_yaml_file;
+    using nlohmann::parse_yaml_range;
+    using nlohmann::parse_yaml_stream;
+    using nlohmann::try_parse_yaml;
+    using nlohmann::yaml_parse_options;
+    using nlohmann::yaml_parser;
+
+    // Encodings and compression
+    using nlohmann::detect_yaml_compression;
+    using nlohmann::detect_yaml_encoding;
+    using nlohmann::transcode_to_utf8;
+    using nlohmann::try_transcode_to_utf8;
+    using nlohmann::yaml_compression;
+    using nlohmann::yaml_encoding;
+    using nlohmann::yaml_encoding_info;
+    using nlohmann::yaml_write_utf8;
+#if defined(NLOHMANN_YAML_HAS_ZLIB) || defined(NLOHMANN_YAML_HAS_ZSTD)
+    using nlohmann::yaml_decompress_streambuf;
+#endif
+#if defined(NLOHMANN_YAML_HAS_ZLIB)
+    using nlohmann::yaml_gzip_streambuf;
+#endif
+#if defined(NLOHMANN_YAML_HAS_ZSTD)
+    using nlohmann::yaml_zstd_streambuf;
+#endif
+
+    // Streaming and partitioning
+    using nlohmann::yaml_byte_range;
+    using nlohmann::yaml_document_reader;
+    using nlohmann::yaml_mapping_stream;
+    using nlohmann::yaml_next_item_boundary;
+    using nlohmann::yaml_partition;
+    using nlohmann::yaml_partition_range;
+    using nlohmann::yaml_pipeline_options;
+
+    // Scalar resolvers
+    using nlohmann::yaml_byte_size_resolver;
+    using nlohmann::yaml_duration_resolver;
+    using nlohmann::yaml_percentage_resolver;
+    using nlohmann::yaml_read_decimal;
+    using nlohmann::yaml_resolver_chain;
+
+    // Raw JSON and packed sequences
+    using nlohmann::is_packed_sequence;
+    using nlohmann::is_raw_json;
+    using nlohmann::make_raw_json;
+    using nlohmann::pack_numeric_sequence;
+    using nlohmann::packed_sequence_span;
+    using nlohmann::parse_raw_json;
+    using nlohmann::raw_json_view;
+    using nlohmann::unpack_sequence;
+    using nlohmann::yaml_binary_subtype;
+    using nlohmann::yaml_load_le64;
+    using nlohmann::yaml_packed_span;
+
+    // Object containers
+    using nlohmann::yaml_flat_json;
+    using nlohmann::yaml_flat_map;
+    using nlohmann::yaml_object_builder;
+    using nlohmann::yaml_ordered_hash_json;
+    using nlohmann::yaml_ordered_hash_map;
+    using nlohmann::yaml_unordered_json;
+    using nlohmann::yaml_unordered_map;
+
+    // Frozen maps and generated parsers
+    using nlohmann::build_frozen_map;
+    using nlohmann::yaml_frozen_map;
+    using nlohmann::yaml_hash64;
+    using nlohmann::yaml_key_hash;
+    using nlohmann::yaml_struct_reader;
+
+    // Documents and path handles
+    using nlohmann::basic_yaml_document;
+    using nlohmann::basic_yaml_path_handle;
+    using nlohmann::compile_path;
+    using nlohmann::yaml_document;
+    using nlohmann::yaml_path_handle;
+
+    // Emitting
+    using nlohmann::emit_yaml;
+    using nlohmann::json2yaml;
+    using nlohmann::to_yaml;
+    using nlohmann::yaml_anchor_plan;
+    using nlohmann::yaml_emit_options;
+    using nlohmann::yaml_emitter;
+    using nlohmann::yaml_parallel_emitter;
+
+    // Diagnostics
+    using nlohmann::memory_report;
+    using nlohmann::yaml_memory_report;
+    using nlohmann::yaml_memory_usage;
+    using nlohmann::yaml_metrics;
+    using nlohmann::yaml_parse_stats;
+    using nlohmann::yaml_trace_event;
+    using nlohmann::yaml_trace_scope;
+    using nlohmann::yaml_tracer;
+}
@@ -0,0 +1,66 @@
+/*
+    Copyright (C) 2025 Igal Alkon <igal@alkontek.com> and contributors
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+import nlohmann.yaml;
+
+int main() {
+    int tests_passed = 0;
+    int tests_failed = 0;
+
+    auto test_value = [&](const std::string& test_name, const bool condition) {
+        if (condition) {
+            std::cout << "[PASS] " << test_name << std::endl;
+            tests_passed++;
+        } else {
+            std::cout << "[FAIL] " << test_name << std::endl;
+            tests_failed++;
+        }
+    };
+
+    try {
+        std::cout << "\n=== Testing import nlohmann.yaml ===" << std::endl;
+        const nlohmann::json config = nlohmann::parse_yaml(std::string("name: demo\nports:\n  - 80\n  - 443\n"));
+        test_value("parse_yaml through the module", config["name"] == "demo" && config["ports"][1] == 443);
+
+        std::istringstream input("service:\n  replicas: 3\n");
+        nlohmann::yaml_parser parser(input);
+        test_value("yaml_parser through the module", parser.parse()["service"]["replicas"] == 3);
+
+        test_value("to_yaml through the module", nlohmann::parse_yaml(nlohmann::to_yaml(config)) == config);
+
+        nlohmann::yaml_metrics metrics;
+        nlohmann::yaml_parse_options options;
+        options.metrics = &metrics;
+        nlohmann::parse_yaml(std::string("a: 1\n"), options);
+        test_value("yaml_metrics through the module", metrics.snapshot().at(0).calls == 1);
+    } catch (const std::exception& e) {
+        std::cout << "[ERROR] " << e.what() << std::endl;
+        tests_failed++;
+    }
+
+    std::cout << "\nTests passed: " << tests_passed << "\nTests failed: " << tests_failed << std::endl;
+    return tests_failed > 0 ? 1 : 0;
+}
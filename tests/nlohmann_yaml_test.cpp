@@ -22,22 +22,26 @@
 */
 
 #include <nlohmann/yaml.hpp>
+#include <service_config.hpp>
+#include <service_defaults.hpp>
+#include <feature_flags.hpp>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <cstdio>
 
 nlohmann::json load_yaml(const std::string& path)
 {
     std::ifstream ifs(path);
     if (!ifs.is_open()) {
-        throw std::runtime_error("Failed to open config file: " + path);
+        NLOHMANN_YAML_THROW(std::runtime_error("Failed to open config file: " + path));
     }
 
     return nlohmann::parse_yaml(ifs);
 }
 
 int main(const int argc, char* argv[]) {
-    try {
+    NLOHMANN_YAML_TRY {
         int tests_passed = 0;
         int tests_failed = 0;
 
@@ -641,6 +645,1436 @@ config:
             test_value("yaml_edge_cases section exists", false);
         }
 
+        // Test memory accounting of parsed documents
+        std::cout << "\n=== Testing Memory Report ===" << std::endl;
+        {
+            const std::string memory_yaml =
+                "small: 1\n"
+                "# belongs to small\n"
+                "big:\n"
+                "  text: \"a string that is long enough to live on the heap\"\n"
+                "  list:\n"
+                "    - 1\n"
+                "    - 2\n";
+
+            nlohmann::yaml_memory_report report;
+            nlohmann::json memory_json = nlohmann::parse_yaml(memory_yaml, report);
+
+            test_value("memory report - root input bytes match the input size",
+                report.input_bytes == memory_yaml.size());
+            test_value("memory report - one child per root key", report.children.size() == 2);
+
+            if (report.children.size() == 2) {
+                // Children follow the object's (sorted) key order
+                const auto& big = report.children[0];
+                const auto& small = report.children[1];
+                test_value("memory report - child paths are JSON pointers",
+                    big.path == "/big" && small.path == "/small");
+                test_value("memory report - per-key input bytes add up to the input size",
+                    big.input_bytes + small.input_bytes == memory_yaml.size());
+                test_value("memory report - heap string counted under its subtree",
+                    big.usage.string_bytes > 0 && small.usage.string_bytes == 0);
+                test_value("memory report - children are part of the root total",
+                    big.usage.total() + small.usage.total() < report.usage.total());
+            }
+
+            const nlohmann::yaml_memory_report deep = nlohmann::memory_report(memory_json, 2);
+            test_value("memory_report - depth 2 reports grandchildren",
+                !deep.children.empty() && deep.children[0].children.size() == 2);
+            test_value("memory_report - matches the parse-time estimate",
+                deep.usage.total() == report.usage.total());
+            test_value("memory_report - map node overhead counted for objects",
+                deep.usage.map_node_bytes > 0);
+            test_value("memory_report - to_json carries the breakdown",
+                deep.to_json().contains("total_bytes") && deep.to_json()["children"].size() == 2);
+        }
+
+        // Test compressed input support
+        std::cout << "\n=== Testing Compressed Input ===" << std::endl;
+        {
+            const std::string plain_yaml = "service:\n  name: api\n  ports:\n    - 80\n    - 443\n";
+
+            test_value("compression - plain text detected as none",
+                nlohmann::detect_yaml_compression(plain_yaml) == nlohmann::yaml_compression::none);
+
+#if defined(NLOHMANN_YAML_HAS_ZLIB)
+            // Two concatenated gzip members, as produced by appending to a .gz file
+            std::string gzip_data;
+            for (const std::string& part : {plain_yaml.substr(0, 20), plain_yaml.substr(20)}) {
+                z_stream deflater{};
+                deflateInit2(&deflater, Z_BEST_SPEED, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+                std::string member(deflateBound(&deflater, static_cast<uLong>(part.size())), '\0');
+                deflater.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(part.data()));
+                deflater.avail_in = static_cast<uInt>(part.size());
+                deflater.next_out = reinterpret_cast<Bytef*>(member.data());
+                deflater.avail_out = static_cast<uInt>(member.size());
+                deflate(&deflater, Z_FINISH);
+                member.resize(deflater.total_out);
+                deflateEnd(&deflater);
+                gzip_data += member;
+            }
+
+            test_value("compression - gzip magic detected",
+                nlohmann::detect_yaml_compression(gzip_data) == nlohmann::yaml_compression::gzip);
+
+            std::istringstream gzip_stream(gzip_data);
+            nlohmann::json gzip_json = nlohmann::parse_yaml(gzip_stream, nlohmann::yaml_compression::gzip);
+            test_value("compression - gzip input matches plain input", gzip_json == nlohmann::parse_yaml(plain_yaml));
+
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            bool gzip_truncated_throws = false;
+            try {
+                std::istringstream truncated(gzip_data.substr(0, gzip_data.size() / 2));
+                nlohmann::parse_yaml(truncated, nlohmann::yaml_compression::gzip);
+            } catch (const std::exception&) {
+                gzip_truncated_throws = true;
+            }
+            test_value("compression - truncated gzip input throws", gzip_truncated_throws);
+#endif
+#endif
+
+#if defined(NLOHMANN_YAML_HAS_ZSTD)
+            std::string zstd_data(ZSTD_compressBound(plain_yaml.size()), '\0');
+            zstd_data.resize(ZSTD_compress(zstd_data.data(), zstd_data.size(), plain_yaml.data(), plain_yaml.size(), 1));
+
+            test_value("compression - zstd magic detected",
+                nlohmann::detect_yaml_compression(zstd_data) == nlohmann::yaml_compression::zstd);
+
+            std::istringstream zstd_stream(zstd_data);
+            nlohmann::json zstd_json = nlohmann::parse_yaml(zstd_stream, nlohmann::yaml_compression::zstd);
+            test_value("compression - zstd input matches plain input", zstd_json == nlohmann::parse_yaml(plain_yaml));
+
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            bool zstd_truncated_throws = false;
+            try {
+                std::istringstream truncated(zstd_data.substr(0, zstd_data.size() / 2));
+                nlohmann::parse_yaml(truncated, nlohmann::yaml_compression::zstd);
+            } catch (const std::exception&) {
+                zstd_truncated_throws = true;
+            }
+            test_value("compression - truncated zstd input throws", zstd_truncated_throws);
+#endif
+#endif
+        }
+
+        // Test YAML emission and JSON to YAML conversion
+        std::cout << "\n=== Testing YAML Emitter ===" << std::endl;
+        {
+            const nlohmann::json dataset = nlohmann::json::parse(R"({
+                "plain": "hello world",
+                "looks_typed": ["true", "null", "~", "123", "-5", "1.5", ".inf", "0x1F", "30s"],
+                "needs_quotes": ["a: b", "x # y", "#tag", "- item", "[1]", "{}", "", " padded ", "\"q\"", "it's"],
+                "escapes": "line1\nline2\ttab \\ backslash",
+                "unicode": "Hello 世界",
+                "numbers": {"int": 42, "negative": -17, "float": 3.25, "whole_float": 2.0, "tiny": 1.5e-300},
+                "flags": {"on": true, "off": false, "nothing": null},
+                "empty_object": {},
+                "empty_array": [],
+                "matrix": [[1, 2], [3, [4, 5]], []],
+                "users": [
+                    {"id": 1, "roles": ["admin", "user"], "meta": {"created": "2023-01-01", "tags": {}}},
+                    {"id": 2, "roles": [], "nested": [{"deep": {"deeper": "value"}}]}
+                ]
+            })");
+
+            const std::string yaml_text = nlohmann::to_yaml(dataset);
+            std::cout << "Emitted YAML:" << std::endl << yaml_text << std::endl;
+
+            test_value("to_yaml - output reads back unchanged", nlohmann::parse_yaml(yaml_text) == dataset);
+
+            std::istringstream json_input(dataset.dump());
+            std::ostringstream yaml_output;
+            nlohmann::json2yaml(json_input, yaml_output);
+            test_value("json2yaml - SAX output matches DOM output", yaml_output.str() == yaml_text);
+
+            // A tiny flush threshold forces many partial writes
+            std::ostringstream streamed;
+            nlohmann::yaml_emitter small_buffer_emitter(streamed, 16);
+            nlohmann::emit_yaml(dataset, small_buffer_emitter);
+            small_buffer_emitter.flush();
+            test_value("yaml_emitter - incremental flushing produces the same output", streamed.str() == yaml_text);
+
+            const nlohmann::json root_sequence = nlohmann::json::parse(R"([{"a": 1, "b": [true]}, "x", [null]])");
+            test_value("to_yaml - root sequence reads back unchanged",
+                nlohmann::parse_yaml(nlohmann::to_yaml(root_sequence)) == root_sequence);
+
+            // Keys that cannot be written plain are quoted and unquoted again
+            const nlohmann::json quoted_keys = {
+                {"a:b", 1}, {"a#b", "x"}, {"&a", {{"*b", 2}, {"c: d", {1, 2}}}}, {"*", "*"},
+                {"@", {{{"k:v", 1}, {"'q'", 2}}, {{"@x", nullptr}}}}, {"say \"hi\": now", true}};
+            test_value("to_yaml - quoted keys read back unchanged",
+                nlohmann::parse_yaml(nlohmann::to_yaml(quoted_keys)) == quoted_keys);
+            std::istringstream quoted_json(quoted_keys.dump());
+            std::ostringstream quoted_yaml;
+            nlohmann::json2yaml(quoted_json, quoted_yaml);
+            test_value("json2yaml - quoted keys read back unchanged", nlohmann::parse_yaml(quoted_yaml.str()) == quoted_keys);
+
+            // A root scalar or empty container is the whole document
+            bool root_scalars_round_trip = true;
+            bool root_scalars_convert = true;
+            for (const nlohmann::json& root_scalar : {nlohmann::json("top"), nlohmann::json(5), nlohmann::json(-2.5),
+                                                      nlohmann::json(nullptr), nlohmann::json("true"), nlohmann::json(""),
+                                                      nlohmann::json("key: value"), nlohmann::json("- item")}) {
+                const std::string root_yaml = nlohmann::to_yaml(root_scalar);
+                root_scalars_round_trip = root_scalars_round_trip && nlohmann::parse_yaml(root_yaml) == root_scalar;
+                std::istringstream root_json(root_scalar.dump());
+                std::ostringstream converted;
+                nlohmann::json2yaml(root_json, converted);
+                root_scalars_convert = root_scalars_convert && converted.str() == root_yaml;
+            }
+            test_value("to_yaml - root scalars read back unchanged", root_scalars_round_trip);
+            test_value("json2yaml - root scalars match to_yaml", root_scalars_convert);
+
+            for (const nlohmann::json& empty_root : {nlohmann::json::array(), nlohmann::json::object()}) {
+                std::istringstream empty_json(empty_root.dump());
+                std::ostringstream converted;
+                nlohmann::json2yaml(empty_json, converted);
+                test_value("to_yaml - empty root " + empty_root.dump() + " reads back unchanged",
+                    nlohmann::parse_yaml(nlohmann::to_yaml(empty_root)) == empty_root
+                    && nlohmann::parse_yaml(converted.str()) == empty_root);
+            }
+            test_value("parse_yaml - folded root scalar", nlohmann::parse_yaml("plain\n  folded\n") == "plain folded");
+            test_value("parse_yaml - words before a mapping are still skipped",
+                nlohmann::parse_yaml("junk\na: 1\n") == nlohmann::json{{"a", 1}});
+            test_value("parse_yaml - empty document is an empty mapping", nlohmann::parse_yaml("\n\n") == nlohmann::json::object());
+
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            bool invalid_json_throws = false;
+            try {
+                std::istringstream broken(R"({"a": [1, 2)");
+                std::ostringstream ignored;
+                nlohmann::json2yaml(broken, ignored);
+            } catch (const std::runtime_error&) {
+                invalid_json_throws = true;
+            }
+            test_value("json2yaml - invalid JSON throws", invalid_json_throws);
+#endif
+
+            nlohmann::json quoted_hash = nlohmann::parse_yaml("note: \"a # b\" # trailing comment\nword: don't # comment\n");
+            test_value("comments - '#' inside quotes is kept", quoted_hash["note"] == "a # b");
+            test_value("comments - apostrophe inside a word does not open a quote", quoted_hash["word"] == "don't");
+        }
+
+        // Test parallel YAML emission
+        std::cout << "\n=== Testing Parallel YAML Emitter ===" << std::endl;
+        {
+            nlohmann::json large = nlohmann::json::object();
+            for (int i = 0; i < 300; ++i) {
+                large["records"].push_back({{"id", i}, {"name", "record " + std::to_string(i)},
+                                            {"tags", {"a", std::to_string(i % 7)}}, {"empty", nlohmann::json::array()}});
+                large["index"]["key" + std::to_string(i)] = {{"offset", i * 10}, {"nested", {{"deep", i % 2 == 0}}}};
+            }
+            large["small"] = {1, 2, 3};
+
+            const std::string serial = nlohmann::to_yaml(large);
+
+            nlohmann::yaml_emit_options emit_options;
+            emit_options.threads = 4;
+            emit_options.min_split_size = 16;
+            test_value("parallel emitter - level 1 split is byte-identical",
+                nlohmann::to_yaml(large, emit_options) == serial);
+
+            emit_options.split_depth = 0;
+            emit_options.min_split_size = 2;
+            test_value("parallel emitter - root split is byte-identical",
+                nlohmann::to_yaml(large, emit_options) == serial);
+
+            emit_options.split_depth = 3;
+            std::ostringstream parallel_stream;
+            nlohmann::to_yaml(large, parallel_stream, emit_options);
+            test_value("parallel emitter - stream output is byte-identical", parallel_stream.str() == serial);
+
+            // Mappings inside a split sequence start on the dash line only in the first chunk
+            const nlohmann::json object_items = large["records"];
+            emit_options.split_depth = 0;
+            emit_options.chunks_per_thread = 16;
+            test_value("parallel emitter - chunked sequence of mappings is byte-identical",
+                nlohmann::to_yaml(object_items, emit_options) == nlohmann::to_yaml(object_items));
+
+#if !defined(_WIN32)
+            if (FILE* file = std::tmpfile()) {
+                emit_options.threads = 3;
+                nlohmann::to_yaml(large, fileno(file), emit_options);
+                std::rewind(file);
+                std::string written(serial.size() + 1, '\0');
+                written.resize(std::fread(written.data(), 1, written.size(), file));
+                std::fclose(file);
+                test_value("parallel emitter - writev output is byte-identical", written == serial);
+            }
+#endif
+
+            emit_options.threads = 1;
+            test_value("parallel emitter - single thread falls back to the serial emitter",
+                nlohmann::to_yaml(large, emit_options) == serial);
+        }
+
+        // Test scalar resolver policies
+        std::cout << "\n=== Testing Scalar Resolvers ===" << std::endl;
+        {
+            const std::string resolver_yaml =
+                "timeout: 30s\n"
+                "interval: 1h30m\n"
+                "poll: 250ms\n"
+                "memory: 512Mi\n"
+                "disk: 1.5G\n"
+                "buffer: 64KiB\n"
+                "ratio: 75%\n"
+                "quoted: \"30s\"\n"
+                "plain_number: 42\n"
+                "word: hello\n";
+
+            using config_resolvers = nlohmann::yaml_resolver_chain<nlohmann::yaml_duration_resolver,
+                                                                   nlohmann::yaml_byte_size_resolver,
+                                                                   nlohmann::yaml_percentage_resolver>;
+            nlohmann::json resolved = nlohmann::parse_yaml<config_resolvers>(resolver_yaml);
+
+            test_value("resolvers - duration in seconds", resolved["timeout"] == 30.0);
+            test_value("resolvers - compound duration", resolved["interval"] == 5400.0);
+            test_value("resolvers - millisecond duration", resolved["poll"] == 0.25);
+            test_value("resolvers - binary byte size", resolved["memory"] == 512ULL * 1024 * 1024);
+            test_value("resolvers - decimal byte size", resolved["disk"] == 1500000000ULL);
+            test_value("resolvers - byte size with B suffix", resolved["buffer"] == 65536ULL);
+            test_value("resolvers - percentage as fraction", resolved["ratio"] == 0.75);
+            test_value("resolvers - quoted scalars are not resolved", resolved["quoted"] == "30s");
+            test_value("resolvers - built-in typing still applies", resolved["plain_number"] == 42
+                && resolved["word"] == "hello");
+
+            nlohmann::json unresolved = nlohmann::parse_yaml(resolver_yaml);
+            test_value("resolvers - default parser keeps unit values as strings",
+                unresolved["timeout"] == "30s" && unresolved["memory"] == "512Mi" && unresolved["ratio"] == "75%");
+
+            nlohmann::json numbers = nlohmann::parse_yaml(
+                "partial: 123abc\nversion: 1.2.3\nbig: 18446744073709551615\nplus: +7\nhex: 0x7FFFFFFFFF\n");
+            test_value("numbers - partially numeric values stay strings",
+                numbers["partial"] == "123abc" && numbers["version"] == "1.2.3");
+            test_value("numbers - unsigned 64-bit values", numbers["big"] == 18446744073709551615ULL);
+            test_value("numbers - explicit plus sign", numbers["plus"] == 7);
+            test_value("numbers - hexadecimal beyond 32 bits", numbers["hex"] == 0x7FFFFFFFFFLL);
+
+            nlohmann::json signed_digits = nlohmann::parse_yaml("hex: 0x-5\noctal: 0o-7\nbinary: 0b-1\n");
+            test_value("numbers - sign after a base prefix stays a string", signed_digits["hex"] == "0x-5"
+                && signed_digits["octal"] == "0o-7" && signed_digits["binary"] == "0b-1");
+        }
+
+        std::cout << "\n=== Testing Raw JSON Passthrough ===" << std::endl;
+        {
+            const std::string raw_yaml =
+                "name: gateway\n"
+                "payload:\n"
+                "  {\n"
+                "    \"routes\": [1, 2, 3],\n"
+                "    \"target\": \"a/b # c\"\n"
+                "  }\n"
+                "small: [1, 2]\n"
+                "services:\n"
+                "  - id: 1\n"
+                "    body: {\"x\": true}\n"
+                "  - [4, 5]\n";
+
+            nlohmann::yaml_parse_options by_size;
+            by_size.raw_json_min_bytes = 16;
+            nlohmann::json sized = nlohmann::parse_yaml(raw_yaml, by_size);
+            test_value("raw json - large block kept raw", nlohmann::is_raw_json(sized["payload"]));
+            test_value("raw json - original bytes preserved", nlohmann::raw_json_view(sized["payload"])
+                == "{\n  \"routes\": [1, 2, 3],\n  \"target\": \"a/b # c\"\n}");
+            test_value("raw json - small values still parsed", sized["small"] == nlohmann::json({1, 2}));
+            test_value("raw json - parse_raw_json", nlohmann::parse_raw_json(sized["payload"])["routes"][2] == 3);
+
+            nlohmann::yaml_parse_options by_path;
+            by_path.raw_json_paths = {"/services/0/body", "/services/1"};
+            nlohmann::json pathed = nlohmann::parse_yaml(raw_yaml, by_path);
+            test_value("raw json - selected by path", nlohmann::is_raw_json(pathed["services"][0]["body"])
+                && nlohmann::raw_json_view(pathed["services"][0]["body"]) == "{\"x\": true}");
+            test_value("raw json - sequence item selected by path", nlohmann::is_raw_json(pathed["services"][1]));
+            test_value("raw json - other paths parsed", pathed["payload"]["routes"].size() == 3
+                && pathed["services"][0]["id"] == 1);
+
+            test_value("raw json - to_yaml writes the original JSON back",
+                nlohmann::parse_yaml(nlohmann::to_yaml(sized)) == nlohmann::parse_yaml(raw_yaml));
+
+            bool invalid_rejected = false;
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            try {
+                nlohmann::parse_yaml("bad: [1, 2,]\n", by_path);
+                nlohmann::yaml_parse_options all;
+                all.raw_json_min_bytes = 1;
+                nlohmann::parse_yaml("bad: [1, 2,]\n", all);
+            } catch (const std::runtime_error&) {
+                invalid_rejected = true;
+            }
+#else
+            nlohmann::yaml_parse_options all;
+            all.raw_json_min_bytes = 1;
+            invalid_rejected = nlohmann::parse_yaml("bad: [1, 2,]\n", by_path).is_discarded()
+                && nlohmann::parse_yaml("bad: [1, 2,]\n", all).is_discarded();
+#endif
+            test_value("raw json - invalid JSON still rejected", invalid_rejected);
+        }
+
+        std::cout << "\n=== Testing Parallel Indexing ===" << std::endl;
+        {
+            std::string index_yaml;
+            for (int i = 0; i < 200; ++i) {
+                index_yaml += "entry_" + std::to_string(i) + ":  # comment " + std::to_string(i) + "\r\n";
+                index_yaml += "  text: \"quoted # not a comment\"\r\n";
+                index_yaml += "  items:\n    - " + std::to_string(i) + "\n    - 'single # quoted'\n\n";
+            }
+            index_yaml += "last: value";
+
+            nlohmann::yaml_parse_options parallel;
+            parallel.index_threads = 4;
+            parallel.parallel_index_min_bytes = 1;
+            const nlohmann::json serial_result = nlohmann::parse_yaml(index_yaml);
+            const nlohmann::json parallel_result = nlohmann::parse_yaml(index_yaml, parallel);
+            test_value("parallel index - same document as serial", parallel_result == serial_result);
+            test_value("parallel index - comments and quotes per slice",
+                parallel_result["entry_150"]["text"] == "quoted # not a comment"
+                && parallel_result["entry_199"]["items"][1] == "single # quoted");
+            test_value("parallel index - unterminated last line", parallel_result["last"] == "value");
+
+            std::istringstream stream_input(index_yaml);
+            test_value("parallel index - stream input", nlohmann::parse_yaml(stream_input, parallel) == serial_result);
+
+            nlohmann::yaml_parse_options chunked;
+            chunked.stream_chunk_bytes = 7;
+            std::istringstream small_chunks(index_yaml);
+            test_value("parallel index - stream read in small chunks",
+                nlohmann::parse_yaml(small_chunks, chunked) == serial_result);
+            chunked.stream_chunk_bytes = 1000;
+            chunked.index_threads = 4;
+            chunked.parallel_index_min_bytes = 3000;
+            std::istringstream parallel_chunks(index_yaml);
+            test_value("parallel index - stream chunks indexed in parallel",
+                nlohmann::parse_yaml(parallel_chunks, chunked) == serial_result);
+
+            parallel.index_threads = 64;
+            test_value("parallel index - more threads than lines",
+                nlohmann::parse_yaml("a: 1\nb: 2\n", parallel) == nlohmann::json({{"a", 1}, {"b", 2}}));
+        }
+
+        std::cout << "\n=== Testing Object Container Presets ===" << std::endl;
+        {
+            const std::string preset_yaml =
+                "zeta: 1\n"
+                "alpha:\n"
+                "  inner: {\"k\": [1, 2]}\n"
+                "  name: test\n"
+                "zeta: 2\n"
+                "items:\n"
+                "  - id: 3\n"
+                "    tag: c\n"
+                "middle: true\n";
+            const nlohmann::json expected = nlohmann::parse_yaml(preset_yaml);
+
+            auto flat = nlohmann::parse_yaml_as<nlohmann::yaml_flat_json>(preset_yaml);
+            test_value("flat json - same document", nlohmann::json(flat) == expected);
+            test_value("flat json - repeated key keeps last value", flat["zeta"] == 2 && flat.size() == 4);
+            test_value("flat json - sorted iteration", flat.begin().key() == "alpha" && std::prev(flat.end()).key() == "zeta");
+            test_value("flat json - lookup", flat.contains("middle") && !flat.contains("missing")
+                && flat.at("alpha").at("inner")["k"][1] == 2);
+            flat["beta"] = 5;
+            flat.erase("middle");
+            test_value("flat json - insert and erase keep order", flat.size() == 4
+                && std::next(flat.begin()).key() == "beta" && !flat.contains("middle"));
+
+            auto ordered_hash = nlohmann::parse_yaml_as<nlohmann::yaml_ordered_hash_json>(preset_yaml);
+            test_value("ordered hash json - same document", nlohmann::json(ordered_hash) == expected);
+            test_value("ordered hash json - insertion order", ordered_hash.begin().key() == "zeta"
+                && std::prev(ordered_hash.end()).key() == "middle" && ordered_hash["zeta"] == 2);
+            ordered_hash.erase("alpha");
+            test_value("ordered hash json - lookup after erase", ordered_hash["items"][0]["tag"] == "c"
+                && ordered_hash.at("middle") == true && !ordered_hash.contains("alpha"));
+
+            auto unordered = nlohmann::parse_yaml_as<nlohmann::yaml_unordered_json>(preset_yaml);
+            test_value("unordered json - same document", nlohmann::json(unordered) == expected);
+
+            nlohmann::yaml_parse_options raw;
+            raw.raw_json_paths = {"/alpha/inner"};
+            auto flat_raw = nlohmann::parse_yaml_as<nlohmann::yaml_flat_json>(preset_yaml, raw);
+            test_value("flat json - raw JSON passthrough", nlohmann::is_raw_json(flat_raw["alpha"]["inner"])
+                && nlohmann::raw_json_view(flat_raw["alpha"]["inner"]) == "{\"k\": [1, 2]}");
+        }
+
+        std::cout << "\n=== Testing Chrome Trace Output ===" << std::endl;
+        {
+            nlohmann::yaml_tracer tracer;
+            nlohmann::yaml_parse_options traced;
+            traced.tracer = &tracer;
+            traced.index_threads = 2;
+            traced.parallel_index_min_bytes = 1;
+
+            std::istringstream trace_input("first:\n  a: 1\n  b: two\nsecond: [1, 2]\n");
+            const nlohmann::json traced_doc = nlohmann::parse_yaml(trace_input, traced);
+            test_value("trace - parse result unchanged", traced_doc == nlohmann::parse_yaml("first:\n  a: 1\n  b: two\nsecond: [1, 2]\n"));
+
+            const nlohmann::json trace = tracer.to_chrome_trace();
+            std::map<std::string, int> span_counts;
+            bool well_formed = trace["traceEvents"].is_array();
+            nlohmann::json first_subtree;
+            for (const auto& event : trace["traceEvents"]) {
+                if (event["ph"] == "X") {
+                    well_formed = well_formed && event.contains("ts") && event.contains("dur") && event.contains("tid");
+                    span_counts[event["name"].get<std::string>()]++;
+                    if (event["name"] == "parse subtree" && event["args"]["label"] == "first") {
+                        first_subtree = event;
+                    }
+                } else {
+                    well_formed = well_formed && event["ph"] == "M" && event["name"] == "thread_name";
+                }
+            }
+            test_value("trace - complete events and thread names", well_formed);
+            test_value("trace - read, index, merge and parse spans", span_counts["read"] == 1 && span_counts["index"] == 1
+                && span_counts["index slice"] == 2 && span_counts["merge"] == 1 && span_counts["parse"] == 1);
+            test_value("trace - one subtree and typing span per root key",
+                span_counts["parse subtree"] == 2 && span_counts["scalar typing"] == 2);
+            test_value("trace - subtree reports typed scalars", first_subtree["args"]["items"] == 2);
+
+            nlohmann::yaml_tracer emit_tracer;
+            nlohmann::yaml_emit_options emit_traced;
+            emit_traced.tracer = &emit_tracer;
+            emit_traced.threads = 2;
+            emit_traced.min_split_size = 2;
+            emit_traced.chunks_per_thread = 2;
+            std::ostringstream emitted;
+            nlohmann::to_yaml(nlohmann::json({1, 2, 3, 4, 5, 6, 7, 8}), emitted, emit_traced);
+            std::map<std::string, int> emit_counts;
+            const nlohmann::json emit_trace = emit_tracer.to_chrome_trace();
+            for (const auto& event : emit_trace["traceEvents"]) {
+                if (event["ph"] == "X") {
+                    emit_counts[event["name"].get<std::string>()]++;
+                }
+            }
+            test_value("trace - emitter chunk spans", emit_counts["emit"] == 1 && emit_counts["emit chunk"] == 4
+                && emit_counts["write"] == 1);
+
+            nlohmann::yaml_tracer small_ring(2);
+            for (int i = 0; i < 5; ++i) {
+                small_ring.record("span", "test", 0, 1);
+            }
+            test_value("trace - full ring keeps the newest spans", small_ring.dropped() == 3
+                && small_ring.to_chrome_trace()["traceEvents"].size() == 3);
+
+            // More tracers than cache slots, used in turn by one thread: one ring per tracer each
+            std::vector<std::unique_ptr<nlohmann::yaml_tracer>> alternating;
+            for (int i = 0; i < 9; ++i) {
+                alternating.push_back(std::make_unique<nlohmann::yaml_tracer>(16));
+            }
+            for (int round = 0; round < 3; ++round) {
+                for (const auto& each : alternating) {
+                    nlohmann::yaml_trace_scope scope(each.get(), "span");
+                }
+            }
+            bool one_ring_each = true;
+            for (const auto& each : alternating) {
+                const nlohmann::json events = each->to_chrome_trace()["traceEvents"];
+                one_ring_each = one_ring_each && events.size() == 4 && events[0]["ph"] == "M" && events[3]["tid"] == 1
+                    && !events[3].contains("args") && each->dropped() == 0;
+            }
+            test_value("trace - alternating tracers reuse the thread's ring", one_ring_each);
+        }
+
+        std::cout << "\n=== Testing Multi-line Scalars ===" << std::endl;
+        {
+            const nlohmann::json folded = nlohmann::parse_yaml(
+                "description: A long description\n"
+                "  that is wrapped over\n"
+                "  several lines\n"
+                "paragraphs: first\n"
+                "\n"
+                "  second\n"
+                "quoted: \"keeps # inside\n"
+                "  and \\\"escapes\\\"\"\n"
+                "joined: \"no\\\n"
+                "  space\"\n"
+                "single: 'it''s\n"
+                "  wrapped'\n"
+                "items:\n"
+                "  - one item\n"
+                "    continued\n"
+                "  - name: entry\n"
+                "      wrapped\n"
+                "    size: 3\n"
+                "block:\n"
+                "  on the next line\n"
+                "  and the one after\n"
+                "numbers: [1, 2,\n"
+                "  3]\n"
+                "last: value\n");
+            test_value("multi-line - plain scalar folded with spaces",
+                folded["description"] == "A long description that is wrapped over several lines");
+            test_value("multi-line - empty line becomes a newline", folded["paragraphs"] == "first\nsecond");
+            test_value("multi-line - comment marker inside a quoted continuation",
+                folded["quoted"] == "keeps # inside and \"escapes\"");
+            test_value("multi-line - escaped line break joins directly", folded["joined"] == "nospace");
+            test_value("multi-line - single-quoted scalar", folded["single"] == "it's wrapped");
+            test_value("multi-line - sequence item", folded["items"][0] == "one item continued");
+            test_value("multi-line - inline mapping in a sequence",
+                folded["items"][1]["name"] == "entry wrapped" && folded["items"][1]["size"] == 3);
+            test_value("multi-line - scalar block on the next line", folded["block"] == "on the next line and the one after");
+            test_value("multi-line - wrapped flow sequence", folded["numbers"] == nlohmann::json({1, 2, 3}));
+            test_value("multi-line - following key unaffected", folded["last"] == "value");
+
+            // A quoted scalar crossing a slice boundary of the parallel index
+            std::string wrapped = "head: 1\nquote: \"";
+            for (int i = 0; i < 200; ++i) {
+                wrapped += "  word # not a comment\n";
+            }
+            wrapped += "  end\"\ntail: 2\n";
+            nlohmann::yaml_parse_options sliced;
+            sliced.index_threads = 4;
+            sliced.parallel_index_min_bytes = 1;
+            const nlohmann::json serial_doc = nlohmann::parse_yaml(wrapped);
+            test_value("multi-line - parallel index matches serial", nlohmann::parse_yaml(wrapped, sliced) == serial_doc);
+            sliced.stream_chunk_bytes = 100;
+            std::istringstream wrapped_stream(wrapped);
+            test_value("multi-line - quoted scalar across stream chunks",
+                nlohmann::parse_yaml(wrapped_stream, sliced) == serial_doc);
+            test_value("multi-line - quoted scalar keeps its comment markers",
+                serial_doc["quote"].get<std::string>().find("word # not a comment word") != std::string::npos
+                && serial_doc["tail"] == 2);
+        }
+
+        std::cout << "\n=== Testing Input Encodings ===" << std::endl;
+        {
+            // "name: Zoë 😀\nprice: 5€\nlist:\n  - ok\n" as code points
+            const std::u32string code_points = U"name: Zoë \U0001F600\nprice: 5€\nlist:\n  - ok\n";
+            const std::string utf8 = "name: Zo\xc3\xab \xf0\x9f\x98\x80\nprice: 5\xe2\x82\xac\nlist:\n  - ok\n";
+            const auto encode = [&](const nlohmann::yaml_encoding encoding, const bool bom) {
+                const bool wide = encoding == nlohmann::yaml_encoding::utf32le || encoding == nlohmann::yaml_encoding::utf32be;
+                const bool big_endian = encoding == nlohmann::yaml_encoding::utf16be || encoding == nlohmann::yaml_encoding::utf32be;
+                std::string bytes;
+                const auto put = [&](const std::uint32_t unit) {
+                    const int width = wide ? 4 : 2;
+                    for (int b = 0; b < width; ++b) {
+                        const int shift = 8 * (big_endian ? width - 1 - b : b);
+                        bytes += static_cast<char>((unit >> shift) & 0xff);
+                    }
+                };
+                if (bom) {
+                    put(0xfeff);
+                }
+                for (const char32_t c : code_points) {
+                    if (!wide && c >= 0x10000) {
+                        put(0xd800 + ((c - 0x10000) >> 10));
+                        put(0xdc00 + ((c - 0x10000) & 0x3ff));
+                    } else {
+                        put(c);
+                    }
+                }
+                return bytes;
+            };
+
+            const nlohmann::json expected = nlohmann::parse_yaml(utf8);
+            test_value("encoding - UTF-8 reference", expected["name"] == "Zo\xc3\xab \xf0\x9f\x98\x80" && expected["list"][0] == "ok");
+            test_value("encoding - UTF-8 byte order mark skipped", nlohmann::parse_yaml("\xef\xbb\xbf" + utf8) == expected);
+
+            const std::pair<nlohmann::yaml_encoding, const char*> encodings[] = {
+                {nlohmann::yaml_encoding::utf16le, "UTF-16LE"}, {nlohmann::yaml_encoding::utf16be, "UTF-16BE"},
+                {nlohmann::yaml_encoding::utf32le, "UTF-32LE"}, {nlohmann::yaml_encoding::utf32be, "UTF-32BE"}};
+            // Chunks of 5 bytes cut code units and surrogate pairs
+            nlohmann::yaml_parse_options chunked;
+            chunked.stream_chunk_bytes = 5;
+            for (const auto& [encoding, name] : encodings) {
+                for (const bool bom : {true, false}) {
+                    const std::string encoded = encode(encoding, bom);
+                    const nlohmann::yaml_encoding_info detected = nlohmann::detect_yaml_encoding(encoded);
+                    std::string transcoded;
+                    nlohmann::transcode_to_utf8(std::string_view(encoded).substr(detected.bom_size), detected.encoding, transcoded);
+                    std::istringstream stream(encoded);
+                    std::istringstream chunked_stream(encoded);
+                    test_value(std::string("encoding - ") + name + (bom ? " with BOM" : " without BOM"),
+                        detected.encoding == encoding && transcoded == utf8 && nlohmann::parse_yaml(stream) == expected
+                        && nlohmann::parse_yaml(chunked_stream, chunked) == expected);
+                }
+            }
+
+            // Long ASCII runs take the vectorized path, with non-ASCII characters at block edges
+            std::u32string long_text;
+            std::string long_utf8;
+            for (int i = 0; i < 100; ++i) {
+                long_text += U"key_" + std::u32string(1, U'a' + i % 26) + U": valueé\n";
+                long_utf8 += "key_" + std::string(1, static_cast<char>('a' + i % 26)) + ": value\xc3\xa9\n";
+            }
+            std::string long_utf16;
+            for (const char32_t c : long_text) {
+                long_utf16 += static_cast<char>(c & 0xff);
+                long_utf16 += static_cast<char>(c >> 8);
+            }
+            std::string long_transcoded;
+            nlohmann::transcode_to_utf8(long_utf16, nlohmann::yaml_encoding::utf16le, long_transcoded);
+            test_value("encoding - long UTF-16 input", long_transcoded == long_utf8);
+
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            bool unpaired_throws = false;
+            try {
+                std::string ignored;
+                nlohmann::transcode_to_utf8(std::string("a\0\x00\xd8 \0", 6), nlohmann::yaml_encoding::utf16le, ignored);
+            } catch (const std::runtime_error&) {
+                unpaired_throws = true;
+            }
+            test_value("encoding - unpaired surrogate throws", unpaired_throws);
+#endif
+        }
+
+        std::cout << "\n=== Testing Input Partitioning ===" << std::endl;
+        {
+            std::string records = "# export header\n\n";
+            for (int i = 0; i < 40; ++i) {
+                records += "- id: " + std::to_string(i) + "\n"
+                    "  note: \"wrapped\n"
+                    "    - not an item\"\n"
+                    "  tags:\n"
+                    "    - a\n"
+                    "    - b\n";
+                if (i % 7 == 0) {
+                    records += "- plain item\n";
+                }
+            }
+            const nlohmann::json whole = nlohmann::parse_yaml(records);
+
+            bool all_match = true;
+            bool aligned = true;
+            for (const size_t count : {1, 2, 3, 7, 64, 1000}) {
+                const std::vector<nlohmann::yaml_byte_range> ranges = nlohmann::yaml_partition(records, count);
+                nlohmann::json joined = nlohmann::json::array();
+                size_t expected_begin = 0;
+                for (size_t i = 0; i < ranges.size(); ++i) {
+                    const nlohmann::yaml_byte_range& range = ranges[i];
+                    aligned = aligned && range.begin == expected_begin && range.end >= range.begin
+                        && (i == 0 || range.begin == range.end || records.compare(range.begin, 2, "- ") == 0)
+                        && range.begin == nlohmann::yaml_partition_range(records, count, i).begin;
+                    expected_begin = range.end;
+                    for (auto& item : nlohmann::parse_yaml_range(records, range)) {
+                        joined.push_back(std::move(item));
+                    }
+                }
+                aligned = aligned && ranges.size() == count && expected_begin == records.size();
+                all_match = all_match && joined == whole;
+            }
+            test_value("partition - ranges are contiguous and item-aligned", aligned);
+            test_value("partition - joined range results equal the whole parse", all_match);
+            test_value("partition - quoted '- ' continuation is not a boundary",
+                nlohmann::yaml_next_item_boundary(records, records.find("    - not")) == records.find("- plain item"));
+
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            bool bad_range_throws = false;
+            try {
+                nlohmann::parse_yaml_range(records, {0, records.size() + 1});
+            } catch (const std::runtime_error&) {
+                bad_range_throws = true;
+            }
+            test_value("partition - range outside the buffer throws", bad_range_throws);
+#endif
+        }
+
+        std::cout << "\n=== Testing Document Pipeline ===" << std::endl;
+        {
+            std::string stream_text = "%YAML 1.2\n# stream header\n";
+            std::vector<nlohmann::json> expected_documents;
+            for (int i = 0; i < 300; ++i) {
+                const std::string body = "id: " + std::to_string(i) + "\nitems:\n  - " + std::to_string(i * 2) + "\n  - x\n";
+                stream_text += "---\n" + body;
+                expected_documents.push_back(nlohmann::parse_yaml(body));
+            }
+            stream_text += "--- - inline\n...\n---\n";
+            expected_documents.push_back(nlohmann::json::array({"inline"}));
+            expected_documents.emplace_back(nullptr);
+
+            bool ordered = true;
+            for (const auto& [threads, window] : {std::pair<size_t, size_t>{1, 1}, {4, 2}, {3, 0}}) {
+                nlohmann::yaml_pipeline_options pipeline;
+                pipeline.threads = threads;
+                pipeline.max_in_flight = window;
+                std::istringstream documents_input(stream_text);
+                ordered = ordered && nlohmann::parse_yaml_documents(documents_input, pipeline) == expected_documents;
+            }
+            test_value("pipeline - documents delivered in input order", ordered);
+
+            std::istringstream single("a: 1\n");
+            const std::vector<nlohmann::json> implicit = nlohmann::parse_yaml_documents(single);
+            test_value("pipeline - document without markers", implicit.size() == 1 && implicit[0]["a"] == 1);
+
+            std::istringstream broken_stream("a: 1\n---\nb: 2\n---\nc: 3\n- mixed\n---\nd: 4\n");
+            std::vector<nlohmann::json> before_error;
+            bool error_propagated = false;
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            try {
+                nlohmann::yaml_pipeline_options pipeline;
+                pipeline.threads = 2;
+                nlohmann::parse_yaml_stream(broken_stream, [&](nlohmann::json&& document) {
+                    before_error.push_back(std::move(document));
+                }, pipeline);
+            } catch (const std::runtime_error&) {
+                error_propagated = true;
+            }
+#else
+            // The failed document is delivered as a discarded value; keep the ones before it
+            nlohmann::yaml_pipeline_options pipeline;
+            pipeline.threads = 2;
+            nlohmann::parse_yaml_stream(broken_stream, [&](nlohmann::json&& document) {
+                if (document.is_discarded()) {
+                    error_propagated = true;
+                } else if (!error_propagated) {
+                    before_error.push_back(std::move(document));
+                }
+            }, pipeline);
+#endif
+            test_value("pipeline - parse error propagated after earlier documents",
+                error_propagated && before_error.size() == 2 && before_error[1]["b"] == 2);
+        }
+
+        std::cout << "\n=== Testing Mapping Stream ===" << std::endl;
+        {
+            const std::string catalog =
+                "# translations\n"
+                "greeting: Hello\n"
+                "farewell:\n"
+                "  short: Bye\n"
+                "  long: Goodbye and\n"
+                "    see you soon\n"
+                "\n"
+                "  # comment inside an entry\n"
+                "plural: [1, 2]\n"
+                "count: 3\n";
+            std::istringstream catalog_input(catalog);
+            std::vector<std::string> keys;
+            nlohmann::json rebuilt = nlohmann::json::object();
+            for (auto&& [key, value] : nlohmann::yaml_mapping_stream(catalog_input)) {
+                keys.push_back(key);
+                rebuilt[key] = std::move(value);
+            }
+            test_value("mapping stream - entries in input order",
+                keys == std::vector<std::string>{"greeting", "farewell", "plural", "count"});
+            test_value("mapping stream - entries match the full parse", rebuilt == nlohmann::parse_yaml(catalog));
+
+            // The indented line is read as a root key of the same entry, as in parse_yaml
+            const std::string split = "config: {\n  \"a\": 1\n  \"config\": 2\n}\nnext: 3\n";
+            std::istringstream split_input(split);
+            std::vector<std::string> split_keys;
+            nlohmann::json split_rebuilt = nlohmann::json::object();
+            for (auto&& [key, value] : nlohmann::yaml_mapping_stream(split_input)) {
+                split_keys.push_back(key);
+                split_rebuilt[key] = std::move(value);
+            }
+            test_value("mapping stream - every key of a multi-key entry",
+                split_keys == std::vector<std::string>{"config", "a", "next"}
+                && split_rebuilt == nlohmann::parse_yaml(split));
+
+            std::istringstream empty_input("# nothing here\n");
+            nlohmann::yaml_mapping_stream empty_stream(empty_input);
+            test_value("mapping stream - empty document", empty_stream.begin() == empty_stream.end());
+
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            bool sequence_throws = false;
+            try {
+                std::istringstream sequence_input("- a\n- b\n");
+                for (auto&& entry : nlohmann::yaml_mapping_stream(sequence_input)) {
+                    (void)entry;
+                }
+            } catch (const std::runtime_error&) {
+                sequence_throws = true;
+            }
+            test_value("mapping stream - root sequence throws", sequence_throws);
+#endif
+        }
+
+        std::cout << "\n=== Testing Frozen Map ===" << std::endl;
+        {
+            const nlohmann::yaml_frozen_map flags = nlohmann::build_frozen_map(
+                "# feature flags\n"
+                "checkout.enabled: true\n"
+                "checkout.limit: 25\n"
+                "greeting: Hello, world\n"
+                "quoted: \"42\"\n"
+                "ratio: 0.5\n"
+                "retired: null\n"
+                "greeting: Hi\n");
+            test_value("frozen map - size counts repeated keys once", flags.size() == 6);
+            test_value("frozen map - string value text", flags.find("greeting") == std::optional<std::string_view>("Hi"));
+            test_value("frozen map - typed values", flags.value("checkout.enabled") == true
+                && flags.value("checkout.limit") == 25 && flags.value("quoted") == "42"
+                && flags.value("ratio") == 0.5 && flags.value("retired").is_null());
+            test_value("frozen map - missing key", !flags.contains("checkout") && !flags.find("missing"));
+
+            // A larger table, written out and used again in place
+            std::string catalog;
+            for (int i = 0; i < 20000; ++i) {
+                catalog += "msg_" + std::to_string(i) + ": text " + std::to_string(i * 7) + "\n";
+            }
+            const nlohmann::yaml_frozen_map large = nlohmann::build_frozen_map(catalog);
+            const std::string image(large.bytes());
+            const nlohmann::yaml_frozen_map mapped = nlohmann::yaml_frozen_map::from_bytes(image);
+            bool all_found = large.size() == 20000 && mapped.size() == 20000;
+            for (int i = 0; i < 20000 && all_found; ++i) {
+                const std::string expected_text = "text " + std::to_string(i * 7);
+                all_found = large.find("msg_" + std::to_string(i)) == std::optional<std::string_view>(expected_text)
+                    && mapped.find("msg_" + std::to_string(i)) == std::optional<std::string_view>(expected_text);
+            }
+            test_value("frozen map - every key found, also from the serialized image", all_found);
+            test_value("frozen map - image views its bytes", mapped.bytes().data() == image.data());
+
+            std::string corrupted = image;
+            corrupted.resize(corrupted.size() - 1);
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            bool corrupted_throws = false;
+            try {
+                (void)nlohmann::yaml_frozen_map::from_bytes(corrupted);
+            } catch (const std::runtime_error&) {
+                corrupted_throws = true;
+            }
+            test_value("frozen map - truncated image throws", corrupted_throws);
+
+            bool nested_throws = false;
+            try {
+                (void)nlohmann::build_frozen_map("a: 1\nb:\n  c: 2\n");
+            } catch (const std::runtime_error&) {
+                nested_throws = true;
+            }
+            test_value("frozen map - nested value throws", nested_throws);
+#endif
+            test_value("frozen map - empty mapping", nlohmann::build_frozen_map("# none\n").empty());
+        }
+
+        std::cout << "\n=== Testing Generated Schema Parser ===" << std::endl;
+        {
+            // generated::service_config comes from tests/service_config.yaml through yaml2cpp
+            const std::string text =
+                "name: \"edge gateway\"\n"
+                "unknown:\n"
+                "  nested:\n"
+                "    - 1\n"
+                "    - 2\n"
+                "port: 9090\n"
+                "ratio: 1.5\n"
+                "enabled: True\n"
+                "ports: [1, 2, 3]\n"
+                "database:\n"
+                "  pool: 4\n"
+                "  extra: x # not in the sample\n"
+                "  host: primary\n"
+                "    .example\n"
+                "servers:\n"
+                "  - host: s1\n"
+                "    weight: 3\n"
+                "  - weight: 0.5\n"
+                "    skipped: [1, 2]\n"
+                "    host: 's''2'\n"
+                "    backup: true\n"
+                "tags:\n"
+                "  - a\n"
+                "  - b\n";
+            const generated::service_config direct = generated::parse_service_config(text);
+            const auto via_dom = nlohmann::parse_yaml(text).get<generated::service_config>();
+            test_value("generated parser - scalars", direct.name == "edge gateway" && direct.port == 9090
+                && direct.ratio == 1.5 && direct.enabled);
+            test_value("generated parser - nested struct skips unknown keys",
+                direct.database.host == "primary .example" && direct.database.pool == 4);
+            test_value("generated parser - scalar sequences", direct.ports == std::vector<std::int64_t>{1, 2, 3}
+                && direct.tags == std::vector<std::string>{"a", "b"});
+            test_value("generated parser - mapping sequence", direct.servers.size() == 2
+                && direct.servers[0].host == "s1" && direct.servers[0].weight == 3.0 && !direct.servers[0].backup
+                && direct.servers[1].host == "s'2" && direct.servers[1].weight == 0.5 && direct.servers[1].backup);
+            test_value("generated parser - matches parse_yaml and get<T>()", direct.name == via_dom.name
+                && direct.port == via_dom.port && direct.ports == via_dom.ports && direct.tags == via_dom.tags
+                && direct.database.host == via_dom.database.host && direct.servers.size() == via_dom.servers.size()
+                && direct.servers[1].host == via_dom.servers[1].host);
+
+            const std::string dom_forms =
+                "name: ~\n"
+                "port: 0x10\n"
+                "ratio: null\n"
+                "enabled: ~\n"
+                "ports:\n"
+                "  - 0x10\n"
+                "  - +2\n"
+                "  - 3e1\n"
+                "database: {\"host\": \"h\", \"pool\": 2}\n"
+                "servers: [{\"host\": \"s1\", \"weight\": 2}, {\"host\": \"s2\", \"backup\": true}]\n"
+                "tags: ~\n";
+            const generated::service_config forms = generated::parse_service_config(dom_forms);
+            const auto forms_via_dom = nlohmann::parse_yaml(dom_forms).get<generated::service_config>();
+            test_value("generated parser - null leaves defaults", forms.name.empty() && forms.ratio == 0.0
+                && !forms.enabled && forms.tags.empty());
+            test_value("generated parser - integers typed like parse_yaml", forms.port == 16
+                && forms.ports == std::vector<std::int64_t>{16, 2, 30});
+            test_value("generated parser - inline JSON mapping", forms.database.host == "h" && forms.database.pool == 2);
+            test_value("generated parser - inline JSON sequence of mappings", forms.servers.size() == 2
+                && forms.servers[0].host == "s1" && forms.servers[0].weight == 2.0 && forms.servers[1].backup);
+            test_value("generated parser - inline forms match parse_yaml and get<T>()", forms.port == forms_via_dom.port
+                && forms.ports == forms_via_dom.ports && forms.database.host == forms_via_dom.database.host
+                && forms.database.pool == forms_via_dom.database.pool && forms.servers.size() == forms_via_dom.servers.size()
+                && forms.servers[1].backup == forms_via_dom.servers[1].backup && forms.name == forms_via_dom.name);
+
+            // Quoted keys end at their unescaped closing quote and are matched unescaped
+            const std::string escaped_keys =
+                "\"na\\\"me\": \"wrong: \\\"x\\\"\"\n"
+                "'it''s': skipped\n"
+                "\"p\\ort\": 7\n"
+                "servers:\n"
+                "  - \"ho\\st\": s3\n"
+                "    \"\\\"weight\\\"\": 9\n";
+            const generated::service_config escaped = generated::parse_service_config(escaped_keys);
+            const auto escaped_via_dom = nlohmann::parse_yaml(escaped_keys).get<generated::service_config>();
+            test_value("generated parser - escaped quoted keys", escaped.name.empty() && escaped.port == 7
+                && escaped.servers.size() == 1 && escaped.servers[0].host == "s3" && escaped.servers[0].weight == 0.0);
+            test_value("generated parser - escaped quoted keys match parse_yaml and get<T>()",
+                escaped.port == escaped_via_dom.port && escaped.name == escaped_via_dom.name
+                && escaped_via_dom.servers.size() == 1 && escaped_via_dom.servers[0].host == "s3");
+
+            std::istringstream stream("port: 1\nmissing: here\n");
+            const generated::service_config partial = generated::parse_service_config(stream);
+            test_value("generated parser - absent members keep defaults", partial.port == 1
+                && partial.name.empty() && partial.servers.empty() && !partial.enabled);
+
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            bool bad_type_throws = false;
+            try {
+                (void)generated::parse_service_config("port: eighty\n");
+            } catch (const std::runtime_error&) {
+                bad_type_throws = true;
+            }
+            test_value("generated parser - mistyped scalar throws", bad_type_throws);
+
+            bool anchor_throws = false;
+            try {
+                (void)generated::parse_service_config("database: &db\n  pool: 2\n");
+            } catch (const std::runtime_error& e) {
+                anchor_throws = std::string(e.what()).find("Anchors are not supported") != std::string::npos;
+            }
+            test_value("generated parser - anchors rejected", anchor_throws);
+#endif
+            test_value("generated parser - alias without anchor is a string",
+                generated::parse_service_config("name: *.example\n").name == "*.example");
+        }
+
+        std::cout << "\n=== Testing Packed Sequences ===" << std::endl;
+        {
+            const std::string text =
+                "values:\n"
+                "  - 1\n"
+                "  - 2\n"
+                "  - -3\n"
+                "  - 9007199254740993\n"
+                "floats: [0.5, 1.5, -2.5, 1e300]\n"
+                "small: [1, -2]\n"
+                "negative: [-1, -2, -3, -4]\n"
+                "mixed:\n"
+                "  - 1\n"
+                "  - 2.5\n"
+                "  - 3\n"
+                "  - 4\n"
+                "nested:\n"
+                "  series:\n"
+                "    - 0.25\n"
+                "    - 0.5\n"
+                "    - 0.75\n"
+                "    - 1.0\n";
+            nlohmann::yaml_parse_options options;
+            options.packed_sequence_min_items = 4;
+            const nlohmann::json packed = nlohmann::parse_yaml(text, options);
+            const nlohmann::json plain = nlohmann::parse_yaml(text);
+
+            const auto values = nlohmann::packed_sequence_span<std::int64_t>(packed["values"]);
+            test_value("packed sequences - block integers", nlohmann::is_packed_sequence(packed["values"])
+                && std::vector<std::int64_t>(values.begin(), values.end())
+                       == std::vector<std::int64_t>{1, 2, -3, 9007199254740993LL});
+            const auto negative = nlohmann::packed_sequence_span<std::int64_t>(packed["negative"]);
+            test_value("packed sequences - flow negative integers", negative.size() == 4 && negative[3] == -4);
+            const auto floats = nlohmann::packed_sequence_span<double>(packed["floats"]);
+            test_value("packed sequences - flow doubles", floats.size() == 4 && floats[1] == 1.5 && floats[3] == 1e300);
+            test_value("packed sequences - 8 bytes per item", packed["nested"]["series"].get_binary().size() == 32);
+            test_value("packed sequences - short and mixed sequences stay arrays",
+                packed["small"].is_array() && packed["mixed"].is_array());
+            test_value("packed sequences - unpack restores the array",
+                nlohmann::unpack_sequence(packed["values"]) == plain["values"]
+                && nlohmann::unpack_sequence(packed["nested"]["series"]) == plain["nested"]["series"]);
+
+            std::ostringstream yaml;
+            nlohmann::to_yaml(packed, yaml);
+            test_value("packed sequences - written back as sequences", nlohmann::parse_yaml(yaml.str()) == plain);
+
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            bool wrong_type_throws = false;
+            try {
+                (void)nlohmann::packed_sequence_span<double>(packed["values"]);
+            } catch (const std::runtime_error&) {
+                wrong_type_throws = true;
+            }
+            test_value("packed sequences - span of the wrong type throws", wrong_type_throws);
+#endif
+
+            nlohmann::json unsigned_values = {1u, 2u, 18446744073709551615ULL};
+            test_value("packed sequences - values beyond int64 are not packed",
+                !nlohmann::pack_numeric_sequence(unsigned_values) && unsigned_values.is_array());
+        }
+
+        std::cout << "\n=== Testing Path Handles ===" << std::endl;
+        {
+            nlohmann::yaml_document document;
+            document.reload(std::string("limits:\n  rps: 100\n  burst: 20\nservers:\n  - host: a\n"));
+            const nlohmann::yaml_path_handle rps = nlohmann::compile_path(document, "/limits/rps");
+            const nlohmann::yaml_path_handle host = nlohmann::compile_path(document, "/servers/0/host");
+            const nlohmann::yaml_path_handle timeout = nlohmann::compile_path(document, "/limits/timeout");
+
+            test_value("path handles - resolve nested keys", rps.get<int>() == 100 && *host == "a");
+            test_value("path handles - cached node is the document node",
+                rps.find() == &document.root()["limits"]["rps"] && rps.find() == rps.find());
+            test_value("path handles - missing path", !timeout.exists() && timeout.find() == nullptr);
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            bool missing_throws = false;
+            try {
+                (void)*timeout;
+            } catch (const std::runtime_error&) {
+                missing_throws = true;
+            }
+            test_value("path handles - dereferencing a missing path throws", missing_throws);
+#endif
+
+            const std::uint64_t before = document.generation();
+            document.reload(std::string("limits:\n  rps: 250\n  timeout: 5\nservers: []\n"));
+            test_value("path handles - reload bumps the generation", document.generation() == before + 1);
+            test_value("path handles - re-resolved after reload", rps.get<int>() == 250
+                && timeout.get<int>() == 5 && !host.exists());
+
+            document.modify([](nlohmann::json& root) { root["limits"]["rps"] = 500; });
+            test_value("path handles - re-resolved after modify", *rps == 500);
+
+            // Several threads find the change at once through the same handle
+            document.modify([](nlohmann::json& root) { root["limits"]["rps"] = 750; });
+            std::atomic<int> agreeing{0};
+            std::vector<std::thread> readers;
+            for (int t = 0; t < 4; ++t) {
+                readers.emplace_back([&] {
+                    if (rps.find() == &document.root()["limits"]["rps"] && rps.get<int>() == 750) {
+                        ++agreeing;
+                    }
+                });
+            }
+            for (auto& reader : readers) {
+                reader.join();
+            }
+            const nlohmann::yaml_path_handle rps_copy = rps;
+            test_value("path handles - shared by reading threads", agreeing == 4 && rps_copy.find() == rps.find());
+
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            bool invalid_throws = false;
+            try {
+                (void)nlohmann::compile_path(document, "limits/rps");
+            } catch (const std::runtime_error&) {
+                invalid_throws = true;
+            }
+            test_value("path handles - invalid pointer throws", invalid_throws);
+#endif
+        }
+
+        std::cout << "\n=== Testing Block Extents ===" << std::endl;
+        {
+            nlohmann::yaml_parser extents(std::string_view(
+                "a:\n"         // 0
+                "  b:\n"       // 1
+                "    c: 1\n"   // 2
+                "\n"           // 3
+                "    d: 2\n"   // 4
+                "  e: 3\n"     // 5
+                "# comment\n"  // 6
+                "f:\n"         // 7
+                "  - 1\n"      // 8
+                "  - 2"));     // 9, the last line
+            const std::vector<size_t> expected_ends = {7, 5, 4, 4, 5, 7, 7, 10, 9, 10};
+            bool ends_match = true;
+            for (size_t line = 0; line < expected_ends.size(); ++line) {
+                ends_match = ends_match && extents.block_end(line) == expected_ends[line];
+            }
+            test_value("block extents - end of every line's block", ends_match);
+
+            nlohmann::yaml_struct_reader reader(
+                "first: 1\n"
+                "skipped:\n"
+                "  deep:\n"
+                "\n"
+                "    - a\n"
+                "    - b: c\n"
+                "  # comment\n"
+                "  more: x\n"
+                "\n"
+                "last: 2\n"
+                "items:\n"
+                "  - unknown:\n"
+                "      x: 1\n"
+                "    other:\n"
+                "      y: 2\n"
+                "    kept: 3\n"
+                "tail:\n"
+                "  z: 1\n");
+            std::string keys;
+            std::string last;
+            std::int64_t kept = 0;
+            std::string_view key;
+            std::string_view value;
+            while (reader.next_key(0, key, value)) {
+                keys += std::string(key) + ",";
+                if (key == "last") {
+                    last = std::string(value);
+                } else if (key == "items") {
+                    reader.read_mapping_sequence(0, value, [&](const int item_indent) {
+                        std::string_view item_key;
+                        std::string_view item_value;
+                        while (reader.next_key(item_indent, item_key, item_value)) {
+                            if (item_key == "kept") {
+                                reader.read_scalar(item_value, kept);
+                            } else {
+                                reader.skip_value(item_indent);
+                            }
+                        }
+                    });
+                } else {
+                    reader.skip_value(0);
+                }
+            }
+            test_value("block extents - skipped blocks end at the next key", keys == "first,skipped,last,items,tail,");
+            test_value("block extents - values after skipped blocks", last == "2" && kept == 3);
+        }
+
+        std::cout << "\n=== Testing Parse Metrics ===" << std::endl;
+        {
+            nlohmann::yaml_metrics metrics;
+            nlohmann::yaml_parse_options options;
+            options.metrics = &metrics;
+            options.metrics_label = "config";
+            const std::string document = "limits:\n  rps: 100\n";
+            for (int i = 0; i < 3; ++i) {
+                (void)nlohmann::parse_yaml(document, options);
+            }
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            try {
+                (void)nlohmann::parse_yaml(std::string("a: [one, two]\n"), options);
+            } catch (const std::runtime_error&) {
+            }
+#else
+            (void)nlohmann::parse_yaml(std::string("a: [one, two]\n"), options);
+#endif
+            options.metrics_label = "quote\"d";
+            std::istringstream stream(document);
+            (void)nlohmann::parse_yaml(stream, options);
+
+            options.metrics_label = "threads";
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; ++t) {
+                threads.emplace_back([&] {
+                    for (int i = 0; i < 50; ++i) {
+                        (void)nlohmann::parse_yaml(document, options);
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            // More labels than the per-thread cache holds, used in turn
+            nlohmann::yaml_metrics rotating;
+            nlohmann::yaml_parse_options rotating_options;
+            rotating_options.metrics = &rotating;
+            const std::string labels[] = {"l0", "l1", "l2", "l3", "l4", "l5", "l6", "l7", "l8", "l9"};
+            for (int round = 0; round < 3; ++round) {
+                for (const std::string& label : labels) {
+                    rotating_options.metrics_label = label;
+                    (void)nlohmann::parse_yaml(document, rotating_options);
+                }
+            }
+            const auto rotated = rotating.snapshot();
+            test_value("parse metrics - labels evicted from the thread cache keep their counters", rotated.size() == 10
+                && std::all_of(rotated.begin(), rotated.end(), [](const auto& entry) { return entry.calls == 3; }));
+
+            const std::vector<nlohmann::yaml_parse_stats> stats = metrics.snapshot();
+            test_value("parse metrics - one entry per label", stats.size() == 3 && stats[0].label == "config"
+                && stats[1].label == "quote\"d" && stats[2].label == "threads");
+            test_value("parse metrics - calls, bytes and errors", stats[0].calls == 4
+                && stats[0].bytes == 3 * document.size() + 14 && stats[0].errors.size() == 1
+                && stats[0].errors.at("parse") == 1 && stats[1].bytes == document.size());
+            test_value("parse metrics - per-thread counters add up", stats[2].calls == 200 && stats[2].errors.empty());
+            std::uint64_t bucketed = 0;
+            for (const std::uint64_t count : stats[2].buckets) {
+                bucketed += count;
+            }
+            test_value("parse metrics - every call in the histogram", bucketed == 200
+                && stats[2].latency_quantile(0.5) > 0.0
+                && stats[2].latency_quantile(0.5) <= stats[2].latency_quantile(0.99));
+
+            nlohmann::yaml_parse_stats synthetic;
+            synthetic.calls = 100;
+            synthetic.buckets[nlohmann::yaml_parse_stats::bucket_of(1500)] = 100;
+            const double p50 = synthetic.latency_quantile(0.5);
+            test_value("parse metrics - quantile interpolates inside its bucket", p50 > 1.70e-6 && p50 < 1.71e-6);
+
+            const std::string text = metrics.to_prometheus();
+            test_value("parse metrics - prometheus counters",
+                text.find("# TYPE nlohmann_yaml_parse_calls_total counter\n") != std::string::npos
+                && text.find("nlohmann_yaml_parse_calls_total{label=\"config\"} 4\n") != std::string::npos
+                && text.find("nlohmann_yaml_parse_errors_total{label=\"config\",type=\"parse\"} 1\n") != std::string::npos);
+            test_value("parse metrics - prometheus histogram",
+                text.find("nlohmann_yaml_parse_duration_seconds_bucket{label=\"threads\",le=\"+Inf\"} 200\n") != std::string::npos
+                && text.find("nlohmann_yaml_parse_duration_seconds_count{label=\"threads\"} 200\n") != std::string::npos);
+            test_value("parse metrics - label values are escaped",
+                text.find("{label=\"quote\\\"d\"}") != std::string::npos);
+        }
+
+        std::cout << "\n=== Testing Embedded Documents ===" << std::endl;
+        {
+            // embedded::service_defaults and embedded::feature_flags are built by yaml_embed
+            const nlohmann::json defaults = embedded::load_service_defaults();
+            test_value("embedded documents - msgpack decodes to the parsed document",
+                defaults["name"] == "gateway" && defaults["port"] == 8080 && defaults["ratio"] == 0.75
+                && defaults["ports"] == nlohmann::json({80, 443}) && defaults["servers"][1]["backup"] == false
+                && defaults["database"]["pool"] == 16 && defaults["tags"][0] == "edge");
+            test_value("embedded documents - blob is MessagePack",
+                nlohmann::json::from_msgpack(embedded::service_defaults_data,
+                                             embedded::service_defaults_data + embedded::service_defaults_size) == defaults);
+
+            const nlohmann::yaml_frozen_map& flags = embedded::feature_flags_map();
+            test_value("embedded documents - frozen map viewed in place", flags.size() == 4
+                && flags.bytes().data() == reinterpret_cast<const char*>(embedded::feature_flags_data)
+                && flags.find("greeting") == std::optional<std::string_view>("Hello, world")
+                && flags.value("checkout.limit") == 25 && flags.value("checkout.enabled") == true);
+        }
+
+        std::cout << "\n=== Testing Anchors and Aliases ===" << std::endl;
+        {
+            const nlohmann::json service = {
+                {"image", "nginx"}, {"ports", {80, 443}}, {"env", {{"LEVEL", "1"}, {"RATIO", 2.5}}}
+            };
+            const nlohmann::json doc = {
+                {"api", service},
+                {"web", service},
+                {"jobs", {service, {{"image", "cron"}}, service}},
+                {"tiny", {1, 2}},
+                {"tiny_copy", {1, 2}},
+                {"nested", {{"inner", service}}}
+            };
+
+            nlohmann::yaml_emit_options options;
+            options.threads = 1;
+            options.anchor_min_nodes = 4;
+            const std::string anchored = nlohmann::to_yaml(doc, options);
+            test_value("anchors - first occurrence anchored", anchored.find("api: &a1\n") != std::string::npos);
+            test_value("anchors - repeats written as aliases",
+                       anchored.find("web: *a1\n") != std::string::npos
+                       && anchored.find("  - *a1\n") != std::string::npos
+                       && anchored.find("inner: *a1\n") != std::string::npos);
+            test_value("anchors - small subtrees written in full", anchored.find("tiny_copy:\n  - 1\n") != std::string::npos);
+            test_value("anchors - output is smaller", anchored.size() < nlohmann::to_yaml(doc).size());
+            test_value("anchors - reads back the same document", nlohmann::parse_yaml(anchored) == doc);
+
+            options.threads = 4;
+            options.split_depth = 2;
+            options.min_split_size = 1;
+            test_value("anchors - parallel output identical", nlohmann::to_yaml(doc, options) == anchored);
+
+            // A repeat nested in an aliased subtree is never written, so it gets no anchor
+            const nlohmann::json pair = {{"left", service}, {"right", service}};
+            const nlohmann::json pairs = {{"p", pair}, {"q", pair}};
+            options.threads = 1;
+            const std::string nested = nlohmann::to_yaml(pairs, options);
+            test_value("anchors - nested repeats", nested.find("p: &a1\n  left: &a2\n") != std::string::npos
+                       && nested.find("right: *a2\n") != std::string::npos && nested.find("q: *a1\n") != std::string::npos
+                       && nlohmann::parse_yaml(nested) == pairs);
+
+            const nlohmann::json parsed = nlohmann::parse_yaml(std::string(
+                "base: &b\n"
+                "  retries: 3\n"
+                "copy: *b\n"
+                "port: &p 8080\n"
+                "ports:\n"
+                "  - *p\n"
+                "  - &list\n"
+                "    - x\n"
+                "  - *list\n"));
+            test_value("anchors - parse mapping alias", parsed["copy"] == parsed["base"] && parsed["copy"]["retries"] == 3);
+            test_value("anchors - parse scalar alias", parsed["ports"][0] == 8080 && parsed["port"] == 8080);
+            test_value("anchors - parse sequence alias", parsed["ports"][2] == nlohmann::json::array({"x"}));
+
+            const nlohmann::json globs = nlohmann::parse_yaml(std::string(
+                "files: *.log\n"
+                "patterns:\n"
+                "  - *.txt\n"
+                "  - *\n"
+                "any: &all *\n"
+                "copy: *all\n"));
+            test_value("anchors - alias without anchor stays a string", globs["files"] == "*.log"
+                       && globs["patterns"] == nlohmann::json::array({"*.txt", "*"}) && globs["copy"] == "*");
+
+            std::istringstream anchored_stream(anchored);
+            nlohmann::json streamed = nlohmann::json::object();
+            for (auto&& [key, value] : nlohmann::yaml_mapping_stream(anchored_stream)) {
+                streamed[key] = std::move(value);
+            }
+            test_value("anchors - mapping stream resolves aliases of earlier entries", streamed == doc);
+
+            // Every level doubles the previous one: 2^22 copies from under 600 bytes
+            std::string laughs = "l0: &l0 [1, 2]\n";
+            for (int level = 1; level <= 22; ++level) {
+                const std::string previous = "*l" + std::to_string(level - 1);
+                laughs += "l" + std::to_string(level) + ": &l" + std::to_string(level) + "\n  - " + previous + "\n  - "
+                    + previous + "\n";
+            }
+            nlohmann::json laughs_result;
+            std::string laughs_error;
+            test_value("anchors - nested alias expansion rejected",
+                !nlohmann::try_parse_yaml(laughs, laughs_result, laughs_error)
+                && laughs_error.find("Aliases expand to more than 1000000 nodes") == 0);
+
+            nlohmann::yaml_parse_options alias_budget;
+            alias_budget.max_alias_nodes = 100;
+            test_value("anchors - alias budget option",
+                !nlohmann::try_parse_yaml(laughs.substr(0, laughs.find("l5:")), laughs_result, laughs_error, alias_budget)
+                && nlohmann::try_parse_yaml(laughs.substr(0, laughs.find("l4:")), laughs_result, laughs_error, alias_budget));
+
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+            bool stream_laughs_throw = false;
+            try {
+                std::istringstream laughs_stream(laughs);
+                for (auto&& entry : nlohmann::yaml_mapping_stream(laughs_stream)) {
+                    (void)entry;
+                }
+            } catch (const std::runtime_error& e) {
+                stream_laughs_throw = std::string(e.what()).find("Aliases expand") == 0;
+            }
+            test_value("anchors - mapping stream shares the alias budget across entries", stream_laughs_throw);
+#endif
+        }
+
+        std::cout << "\n=== Testing Error Status ===" << std::endl;
+        {
+            nlohmann::json status_result = "untouched";
+            std::string status_error;
+            test_value("error status - valid input", nlohmann::try_parse_yaml("a: 1\nb: [1, 2]\n", status_result, status_error)
+                && status_result == nlohmann::json({{"a", 1}, {"b", {1, 2}}}) && status_error.empty());
+
+            status_result = "untouched";
+            test_value("error status - invalid JSON array",
+                !nlohmann::try_parse_yaml("a: [one, two]\n", status_result, status_error)
+                && status_error == "Invalid JSON array syntax: [one, two]" && status_result == "untouched");
+            test_value("error status - missing indented block",
+                !nlohmann::try_parse_yaml("a:\nb: 1\n", status_result, status_error)
+                && status_error == "Expected indented block for key 'a' at line 0");
+            test_value("error status - malformed UTF-16",
+                !nlohmann::try_parse_yaml(std::string_view("a\0\x00\xd8 \0", 6), status_result, status_error)
+                && status_error == "Invalid UTF-16 input: unpaired surrogate at byte 2");
+
+            nlohmann::yaml_metrics status_metrics;
+            nlohmann::yaml_parse_options status_options;
+            status_options.metrics = &status_metrics;
+            (void)nlohmann::try_parse_yaml("a: [one, two]\n", status_result, status_error, status_options);
+            const auto status_stats = status_metrics.snapshot();
+            test_value("error status - failure counted as a parse error", status_stats.size() == 1
+                && status_stats[0].calls == 1 && status_stats[0].errors.count("parse") == 1);
+
+#if defined(NLOHMANN_YAML_NOEXCEPTION)
+            nlohmann::yaml_parser failing_parser(std::string_view("a: 1\n- b\n"));
+            test_value("error status - parser returns a discarded value",
+                failing_parser.parse().is_discarded() && failing_parser.failed() && !failing_parser.error().empty());
+#endif
+        }
+
         // Summary
         std::cout << "\n=== TEST SUMMARY ===" << std::endl;
         std::cout << "Tests passed: " << tests_passed << std::endl;
@@ -655,8 +2089,11 @@ config:
 
         return tests_failed > 0 ? 1 : 0;
 
-    } catch (const std::exception& ex) {
+    }
+#if !defined(NLOHMANN_YAML_NOEXCEPTION)
+    catch (const std::exception& ex) {
         std::cerr << "ERROR: " << ex.what() << std::endl;
         return 1;
     }
+#endif
 }
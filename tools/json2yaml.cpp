@@ -0,0 +1,70 @@
+/*
+    Copyright (C) 2025 Igal Alkon <igal@alkontek.com> and contributors
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <nlohmann/yaml.hpp>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+/**
+ * Converts a JSON document to block-style YAML with bounded memory.
+ *
+ * Usage: json2yaml [input.json|-] [output.yaml|-]
+ * Standard input and output are used when a path is omitted or given as "-".
+ */
+int main(const int argc, char* argv[]) {
+    if (argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " [input.json|-] [output.yaml|-]" << std::endl;
+        return 2;
+    }
+
+    try {
+        std::ifstream input_file;
+        std::istream* input = &std::cin;
+        if (argc > 1 && std::string(argv[1]) != "-") {
+            input_file.open(argv[1], std::ios::binary);
+            if (!input_file.is_open()) {
+                throw std::runtime_error(std::string("Failed to open input file: ") + argv[1]);
+            }
+            input = &input_file;
+        }
+
+        std::ofstream output_file;
+        std::ostream* output = &std::cout;
+        if (argc > 2 && std::string(argv[2]) != "-") {
+            output_file.open(argv[2], std::ios::binary);
+            if (!output_file.is_open()) {
+                throw std::runtime_error(std::string("Failed to open output file: ") + argv[2]);
+            }
+            output = &output_file;
+        }
+
+        std::ios::sync_with_stdio(false);
+        nlohmann::json2yaml(*input, *output);
+        output->flush();
+
+        return output->good() ? 0 : 1;
+    } catch (const std::exception& ex) {
+        std::cerr << "ERROR: " << ex.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,378 @@
+/*
+    Copyright (C) 2025 Igal Alkon <igal@alkontek.com> and contributors
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <nlohmann/yaml.hpp>
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    /**
+     * C++ type of a schema field.
+     */
+    enum class field_kind {
+        string,
+        integer,
+        number,
+        boolean,
+        mapping,          ///< Nested struct
+        scalar_sequence,  ///< std::vector of a scalar type
+        mapping_sequence  ///< std::vector of a struct
+    };
+
+    struct field {
+        std::string key;           ///< YAML key
+        std::string member;        ///< C++ member name
+        field_kind kind = field_kind::string;
+        field_kind element = field_kind::string; ///< Scalar type of a scalar sequence
+        size_t struct_index = 0;   ///< Struct of a mapping or mapping sequence
+    };
+
+    struct schema_struct {
+        std::string name;
+        std::vector<field> fields;
+    };
+
+    /**
+     * Turns a YAML key into a C++ identifier.
+     */
+    std::string identifier(const std::string& key) {
+        static const char* const keywords[] = {
+            "alignas", "alignof", "and", "asm", "auto", "bool", "break", "case", "catch", "char", "class",
+            "const", "constexpr", "continue", "default", "delete", "do", "double", "else", "enum", "explicit",
+            "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int", "long",
+            "mutable", "namespace", "new", "noexcept", "not", "nullptr", "operator", "or", "private",
+            "protected", "public", "register", "return", "short", "signed", "sizeof", "static", "struct",
+            "switch", "template", "this", "throw", "true", "try", "typedef", "typename", "union", "unsigned",
+            "using", "virtual", "void", "volatile", "while", "xor"};
+
+        std::string name;
+        for (const char c : key) {
+            name += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+        }
+        if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+            name.insert(0, "_");
+        }
+        if (std::find(std::begin(keywords), std::end(keywords), name) != std::end(keywords)) {
+            name += '_';
+        }
+        return name;
+    }
+
+    /**
+     * Infers the schema of a sample document: mappings become structs, sequences become vectors
+     * and scalars get the type of their sample value.
+     */
+    class schema_builder {
+    public:
+        std::vector<schema_struct> structs;
+
+        size_t add_struct(const std::string& name, const nlohmann::ordered_json& sample) {
+            const size_t index = structs.size();
+            structs.push_back({name, {}});
+            merge_into(index, sample);
+            return index;
+        }
+
+    private:
+        static field_kind scalar_kind(const nlohmann::ordered_json& value) {
+            if (value.is_boolean()) {
+                return field_kind::boolean;
+            }
+            if (value.is_number_float()) {
+                return field_kind::number;
+            }
+            if (value.is_number()) {
+                return field_kind::integer;
+            }
+            return field_kind::string; // strings, and nulls whose type is unknown
+        }
+
+        /// Widens a scalar type so that both samples fit
+        static field_kind widen(const field_kind a, const field_kind b) {
+            if (a == b) {
+                return a;
+            }
+            if ((a == field_kind::integer && b == field_kind::number) || (a == field_kind::number && b == field_kind::integer)) {
+                return field_kind::number;
+            }
+            return field_kind::string;
+        }
+
+        /// Adds the fields of a sample mapping to a struct, widening the types of existing ones
+        void merge_into(const size_t index, const nlohmann::ordered_json& sample) {
+            for (auto it = sample.begin(); it != sample.end(); ++it) {
+                const nlohmann::ordered_json& value = it.value();
+                auto existing = std::find_if(structs[index].fields.begin(), structs[index].fields.end(),
+                                             [&](const field& f) { return f.key == it.key(); });
+                if (existing != structs[index].fields.end()) {
+                    merge_field(static_cast<size_t>(existing - structs[index].fields.begin()), index, value);
+                    continue;
+                }
+
+                field entry;
+                entry.key = it.key();
+                entry.member = identifier(it.key());
+                const std::string nested_name = structs[index].name + "_" + entry.member;
+                if (value.is_object()) {
+                    entry.kind = field_kind::mapping;
+                    entry.struct_index = add_struct(nested_name, value);
+                } else if (value.is_array()) {
+                    const auto first_object = std::find_if(value.begin(), value.end(),
+                                                           [](const nlohmann::ordered_json& item) { return item.is_object(); });
+                    if (first_object != value.end()) {
+                        entry.kind = field_kind::mapping_sequence;
+                        entry.struct_index = add_struct(nested_name + "_item", nlohmann::ordered_json::object());
+                        for (const auto& item : value) {
+                            if (!item.is_object()) {
+                                throw std::runtime_error("Sequence '" + it.key() + "' mixes mappings and other values");
+                            }
+                            merge_into(entry.struct_index, item);
+                        }
+                    } else {
+                        entry.kind = field_kind::scalar_sequence;
+                        for (size_t i = 0; i < value.size(); ++i) {
+                            if (value[i].is_array()) {
+                                throw std::runtime_error("Nested sequences are not supported (key '" + it.key() + "')");
+                            }
+                            entry.element = i == 0 ? scalar_kind(value[i]) : widen(entry.element, scalar_kind(value[i]));
+                        }
+                    }
+                } else {
+                    entry.kind = scalar_kind(value);
+                }
+                structs[index].fields.push_back(entry);
+            }
+        }
+
+        /// Merges another sample of an existing field (from another sequence item)
+        void merge_field(const size_t field_index, const size_t index, const nlohmann::ordered_json& value) {
+            field& existing = structs[index].fields[field_index];
+            if (existing.kind == field_kind::mapping && value.is_object()) {
+                const size_t nested = existing.struct_index;
+                merge_into(nested, value);
+            } else if (existing.kind == field_kind::mapping_sequence && value.is_array()) {
+                const size_t nested = existing.struct_index;
+                for (const auto& item : value) {
+                    merge_into(nested, item);
+                }
+            } else if (existing.kind == field_kind::scalar_sequence && value.is_array()) {
+                for (const auto& item : value) {
+                    structs[index].fields[field_index].element = widen(structs[index].fields[field_index].element, scalar_kind(item));
+                }
+            } else if (!value.is_structured() && existing.kind != field_kind::mapping
+                       && existing.kind != field_kind::mapping_sequence && existing.kind != field_kind::scalar_sequence) {
+                existing.kind = widen(existing.kind, scalar_kind(value));
+            } else {
+                throw std::runtime_error("Key '" + existing.key + "' has different structures in the sample");
+            }
+        }
+    };
+
+    const char* cpp_type(const field_kind kind) {
+        switch (kind) {
+            case field_kind::integer: return "std::int64_t";
+            case field_kind::number: return "double";
+            case field_kind::boolean: return "bool";
+            default: return "std::string";
+        }
+    }
+
+    const char* default_value(const field_kind kind) {
+        switch (kind) {
+            case field_kind::integer: return " = 0";
+            case field_kind::number: return " = 0.0";
+            case field_kind::boolean: return " = false";
+            default: return "";
+        }
+    }
+
+    /**
+     * Writes the struct definition, its specialized reader and its `from_json` conversion.
+     */
+    void emit_struct(std::ostream& out, const std::vector<schema_struct>& structs, const schema_struct& type) {
+        out << "    struct " << type.name << " {\n";
+        for (const field& f : type.fields) {
+            out << "        ";
+            switch (f.kind) {
+                case field_kind::mapping: out << structs[f.struct_index].name; break;
+                case field_kind::scalar_sequence: out << "std::vector<" << cpp_type(f.element) << ">"; break;
+                case field_kind::mapping_sequence: out << "std::vector<" << structs[f.struct_index].name << ">"; break;
+                default: out << cpp_type(f.kind); break;
+            }
+            out << " " << f.member << default_value(f.kind) << ";\n";
+        }
+        out << "    };\n\n";
+
+        // Keys are grouped by hash, so a (practically impossible) collision still dispatches correctly
+        std::map<std::uint64_t, std::vector<const field*>> by_hash;
+        for (const field& f : type.fields) {
+            by_hash[nlohmann::yaml_key_hash(f.key)].push_back(&f);
+        }
+
+        out << "    inline void read_yaml(nlohmann::yaml_struct_reader& reader, const int indent, " << type.name << "& out) {\n"
+            << "        std::string_view key;\n"
+            << "        std::string_view value;\n"
+            << "        while (reader.next_key(indent, key, value)) {\n"
+            << "            switch (nlohmann::yaml_key_hash(key)) {\n";
+        for (const auto& [hash, fields] : by_hash) {
+            out << "                case 0x" << std::hex << hash << std::dec << "ULL:\n";
+            for (const field* f : fields) {
+                out << "                    if (key == " << nlohmann::json(f->key).dump() << ") {\n";
+                switch (f->kind) {
+                    case field_kind::mapping:
+                        out << "                        reader.read_mapping(indent, value, out." << f->member
+                            << ", [&](const int child) { read_yaml(reader, child, out." << f->member << "); });\n";
+                        break;
+                    case field_kind::scalar_sequence:
+                        out << "                        reader.read_sequence(indent, value, [&](const std::string_view item) {\n"
+                            << "                            reader.read_scalar(item, out." << f->member << ".emplace_back());\n"
+                            << "                        });\n";
+                        break;
+                    case field_kind::mapping_sequence:
+                        out << "                        reader.read_mapping_sequence(indent, value, out." << f->member
+                            << ", [&](const int item_indent) {\n"
+                            << "                            read_yaml(reader, item_indent, out." << f->member << ".emplace_back());\n"
+                            << "                        });\n";
+                        break;
+                    default:
+                        out << "                        reader.read_scalar(value, out." << f->member << ");\n";
+                        break;
+                }
+                out << "                        continue;\n"
+                    << "                    }\n";
+            }
+            out << "                    break;\n";
+        }
+        out << "                default:\n"
+            << "                    break;\n"
+            << "            }\n"
+            << "            reader.skip_value(indent); // keys outside the schema\n"
+            << "        }\n"
+            << "    }\n\n";
+
+        out << "    inline void from_json(const nlohmann::json& j, " << type.name << "& out) {\n";
+        for (const field& f : type.fields) {
+            out << "        if (const auto it = j.find(" << nlohmann::json(f.key).dump() << "); it != j.end() && !it->is_null()) {\n"
+                << "            it->get_to(out." << f.member << ");\n"
+                << "        }\n";
+        }
+        out << "    }\n\n";
+    }
+
+    /**
+     * Generates the header for a sample document.
+     */
+    void generate(const nlohmann::ordered_json& sample, const std::string& source, const std::string& name,
+                  const std::string& ns, std::ostream& out) {
+        if (!sample.is_object()) {
+            throw std::runtime_error("The sample document must be a mapping");
+        }
+        schema_builder schema;
+        schema.add_struct(identifier(name), sample);
+
+        std::string guard = ns.empty() ? name : ns + "_" + name;
+        for (char& c : guard) {
+            c = std::isalnum(static_cast<unsigned char>(c)) ? static_cast<char>(std::toupper(static_cast<unsigned char>(c))) : '_';
+        }
+        guard += "_YAML_HPP";
+
+        out << "// Generated by yaml2cpp from " << std::filesystem::path(source).filename().string() << ". Do not edit.\n\n"
+            << "#ifndef " << guard << "\n"
+            << "#define " << guard << "\n\n"
+            << "#include <nlohmann/yaml.hpp>\n"
+            << "#include <cstdint>\n"
+            << "#include <istream>\n"
+            << "#include <string>\n"
+            << "#include <string_view>\n"
+            << "#include <vector>\n\n";
+        if (!ns.empty()) {
+            out << "namespace " << ns << " {\n";
+        }
+
+        // Nested structs are created after their parents, so emitting in reverse defines them first
+        for (auto it = schema.structs.rbegin(); it != schema.structs.rend(); ++it) {
+            emit_struct(out, schema.structs, *it);
+        }
+
+        const std::string& root = schema.structs.front().name;
+        out << "    /**\n"
+            << "     * Parses a document into a `" << root << "` without building a DOM.\n"
+            << "     */\n"
+            << "    inline " << root << " parse_" << root << "(const std::string_view text) {\n"
+            << "        nlohmann::yaml_struct_reader reader(text);\n"
+            << "        " << root << " result;\n"
+            << "        read_yaml(reader, 0, result);\n"
+            << "        return result;\n"
+            << "    }\n\n"
+            << "    inline " << root << " parse_" << root << "(std::istream& input) {\n"
+            << "        nlohmann::yaml_struct_reader reader(input);\n"
+            << "        " << root << " result;\n"
+            << "        read_yaml(reader, 0, result);\n"
+            << "        return result;\n"
+            << "    }\n";
+        if (!ns.empty()) {
+            out << "} // namespace " << ns << "\n";
+        }
+        out << "\n#endif // " << guard << "\n";
+    }
+}
+
+/**
+ * Generates C++ structs and a specialized parser from a sample YAML document.
+ *
+ * Usage: yaml2cpp <sample.yaml> <output.hpp> <struct_name> [namespace]
+ */
+int main(const int argc, char* argv[]) {
+    if (argc < 4 || argc > 5) {
+        std::cerr << "Usage: " << argv[0] << " <sample.yaml> <output.hpp> <struct_name> [namespace]" << std::endl;
+        return 2;
+    }
+
+    try {
+        std::ifstream input(argv[1], std::ios::binary);
+        if (!input.is_open()) {
+            throw std::runtime_error(std::string("Failed to open sample file: ") + argv[1]);
+        }
+        const auto sample = nlohmann::parse_yaml_as<nlohmann::ordered_json>(input);
+
+        std::ostringstream header;
+        generate(sample, argv[1], argv[3], argc > 4 ? argv[4] : "", header);
+
+        std::ofstream output(argv[2], std::ios::binary);
+        if (!output.is_open()) {
+            throw std::runtime_error(std::string("Failed to open output file: ") + argv[2]);
+        }
+        output << header.str();
+        return output.good() ? 0 : 1;
+    } catch (const std::exception& ex) {
+        std::cerr << "ERROR: " << ex.what() << std::endl;
+        return 1;
+    }
+}
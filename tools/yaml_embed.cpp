@@ -0,0 +1,198 @@
+/*
+    Copyright (C) 2025 Igal Alkon <igal@alkontek.com> and contributors
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <nlohmann/yaml.hpp>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    /**
+     * Encodings of the embedded document.
+     */
+    enum class embed_format {
+        msgpack,   ///< MessagePack of the whole document, decoded with json::from_msgpack
+        frozen_map ///< yaml_frozen_map image of a flat mapping, used in place
+    };
+
+    /**
+     * Writes the bytes as the initializer of an unsigned char array, 16 per line.
+     */
+    void write_bytes(const std::vector<std::uint8_t>& bytes, std::ostream& out) {
+        out << std::hex << std::setfill('0');
+        for (std::size_t i = 0; i < bytes.size(); ++i) {
+            out << (i % 16 == 0 ? "\n        " : " ") << "0x" << std::setw(2) << static_cast<unsigned>(bytes[i]) << ',';
+        }
+        out << std::dec << '\n';
+    }
+
+    /**
+     * Writes the header declaring the embedded data and its accessor.
+     */
+    void write_header(const embed_format format, const std::string& source, const std::string& name,
+                      const std::string& ns, std::ostream& out) {
+        std::string guard = (ns.empty() ? "" : ns + "_") + name + "_EMBEDDED_HPP";
+        std::transform(guard.begin(), guard.end(), guard.begin(), [](const unsigned char c) {
+            return std::isalnum(c) ? static_cast<char>(std::toupper(c)) : '_';
+        });
+
+        out << "// Generated by yaml_embed from " << source << ". Do not edit.\n\n"
+            << "#ifndef " << guard << "\n"
+            << "#define " << guard << "\n\n"
+            << "#include <nlohmann/yaml.hpp>\n"
+            << "#include <cstddef>\n\n";
+        if (!ns.empty()) {
+            out << "namespace " << ns << " {\n";
+        }
+        if (format == embed_format::msgpack) {
+            out << "    /// MessagePack encoding of " << source << "\n"
+                << "    extern const unsigned char " << name << "_data[];\n"
+                << "    extern const std::size_t " << name << "_size;\n\n"
+                << "    /**\n"
+                << "     * Decodes the document embedded from " << source << ".\n"
+                << "     */\n"
+                << "    nlohmann::json load_" << name << "();\n";
+        } else {
+            out << "    /// yaml_frozen_map image of " << source << "\n"
+                << "    extern const unsigned char " << name << "_data[];\n"
+                << "    extern const std::size_t " << name << "_size;\n\n"
+                << "    /**\n"
+                << "     * The mapping embedded from " << source << ", viewing the image in place.\n"
+                << "     */\n"
+                << "    const nlohmann::yaml_frozen_map& " << name << "_map();\n";
+        }
+        if (!ns.empty()) {
+            out << "} // namespace " << ns << "\n";
+        }
+        out << "\n#endif // " << guard << "\n";
+    }
+
+    /**
+     * Writes the source file defining the embedded data and its accessor.
+     */
+    void write_source(const embed_format format, const std::vector<std::uint8_t>& bytes, const std::string& source,
+                      const std::string& header, const std::string& name, const std::string& ns, std::ostream& out) {
+        out << "// Generated by yaml_embed from " << source << ". Do not edit.\n\n"
+            << "#include \"" << header << "\"\n\n";
+        if (!ns.empty()) {
+            out << "namespace " << ns << " {\n";
+        }
+        out << "    alignas(16) const unsigned char " << name << "_data[] = {";
+        write_bytes(bytes, out);
+        out << "    };\n"
+            << "    const std::size_t " << name << "_size = " << bytes.size() << ";\n\n";
+        if (format == embed_format::msgpack) {
+            out << "    nlohmann::json load_" << name << "() {\n"
+                << "        return nlohmann::json::from_msgpack(" << name << "_data, " << name << "_data + "
+                << name << "_size);\n"
+                << "    }\n";
+        } else {
+            out << "    const nlohmann::yaml_frozen_map& " << name << "_map() {\n"
+                << "        static const nlohmann::yaml_frozen_map map = nlohmann::yaml_frozen_map::from_bytes(\n"
+                << "            std::string_view(reinterpret_cast<const char*>(" << name << "_data), " << name
+                << "_size));\n"
+                << "        return map;\n"
+                << "    }\n";
+        }
+        if (!ns.empty()) {
+            out << "} // namespace " << ns << "\n";
+        }
+    }
+
+    /**
+     * Writes a generated file.
+     */
+    void write_file(const std::string& path, const std::string& content) {
+        std::ofstream output(path, std::ios::binary);
+        if (!output.is_open()) {
+            throw std::runtime_error("Failed to open output file: " + path);
+        }
+        output << content;
+        if (!output.good()) {
+            throw std::runtime_error("Failed to write output file: " + path);
+        }
+    }
+}
+
+/**
+ * Parses a YAML file at build time and embeds the result in a generated source file, so that
+ * programs load it without parsing YAML. Malformed input makes the tool (and the build) fail.
+ *
+ * Usage: yaml_embed [--format msgpack|frozen_map] <input.yaml> <output.hpp> <output.cpp> <name> [namespace]
+ */
+int main(const int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    embed_format format = embed_format::msgpack;
+    if (args.size() >= 2 && args[0] == "--format") {
+        if (args[1] == "frozen_map") {
+            format = embed_format::frozen_map;
+        } else if (args[1] != "msgpack") {
+            std::cerr << "ERROR: Unknown format: " << args[1] << std::endl;
+            return 2;
+        }
+        args.erase(args.begin(), args.begin() + 2);
+    }
+    if (args.size() < 4 || args.size() > 5) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--format msgpack|frozen_map] <input.yaml> <output.hpp> <output.cpp> <name> [namespace]"
+                  << std::endl;
+        return 2;
+    }
+
+    try {
+        std::ifstream input(args[0], std::ios::binary);
+        if (!input.is_open()) {
+            throw std::runtime_error("Failed to open input file: " + args[0]);
+        }
+
+        std::vector<std::uint8_t> bytes;
+        if (format == embed_format::msgpack) {
+            bytes = nlohmann::json::to_msgpack(nlohmann::parse_yaml(input));
+        } else {
+            const nlohmann::yaml_frozen_map map = nlohmann::build_frozen_map(input);
+            bytes.assign(map.bytes().begin(), map.bytes().end());
+        }
+
+        const std::string source = std::filesystem::path(args[0]).filename().string();
+        const std::string& name = args[3];
+        const std::string ns = args.size() > 4 ? args[4] : "";
+
+        std::ostringstream header;
+        write_header(format, source, name, ns, header);
+        std::ostringstream definitions;
+        write_source(format, bytes, source, std::filesystem::path(args[1]).filename().string(), name, ns, definitions);
+
+        write_file(args[1], header.str());
+        write_file(args[2], definitions.str());
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "ERROR: " << args[0] << ": " << ex.what() << std::endl;
+        return 1;
+    }
+}